@@ -18,11 +18,6 @@ layout (set = 0, binding = 0) uniform GlobalUbo {
     int ActiveLightsCount;
 } ubo;
 
-layout (push_constant) uniform PushConstants { // 128 bytes, limit for supporting all GPUs
-    mat4 ModelMatrix;
-    mat4 NormalMatrix; // we use a mat4 for aligment rules, it will be truncated when used.
-} push;
-
 layout (location = 0) out vec4 o_PixelColor;
 
 void main() {
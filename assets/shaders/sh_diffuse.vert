@@ -23,19 +23,30 @@ layout (set = 0, binding = 0) uniform GlobalUbo {
     int ActiveLightsCount;
 } ubo;
 
-layout (push_constant) uniform PushConstants { // 128 bytes, limit for supporting all GPUs
+struct Object {
     mat4 ModelMatrix;
     mat4 NormalMatrix; // we use a mat4 for aligment rules, it will be truncated when used.
+};
+
+// Written by the ObjectBuffer only when a transform changes.
+layout (std430, set = 0, binding = 1) readonly buffer Objects {
+    Object objects[];
+};
+
+layout (push_constant) uniform PushConstants {
+    mat4 DequantizationMatrix; // identity for this vertex format
+    uint ObjectIndex;
 } push;
 
 void main() {
 
     // Vertex is in model space, light is in world space
-    vec4 vertexPositionWorld = push.ModelMatrix * vec4(a_Position, 1.0);
+    Object object = objects[push.ObjectIndex];
+    vec4 vertexPositionWorld = object.ModelMatrix * vec4(a_Position, 1.0);
 
     gl_Position = ubo.ProjectionMatrix * (ubo.ViewMatrix * vertexPositionWorld);
 
-    o_FragNormalWorld = normalize(mat3(push.NormalMatrix) * a_Normal);
+    o_FragNormalWorld = normalize(mat3(object.NormalMatrix) * a_Normal);
     o_FragPositionWorld = vertexPositionWorld.xyz;
     o_FragColor = a_Color;
 }
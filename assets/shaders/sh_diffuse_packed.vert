@@ -0,0 +1,62 @@
+#version 450
+
+// Model::PackedVertex variant of sh_diffuse.vert, the outputs are the same so it pairs with sh_diffuse.frag.
+layout (location = 0) in vec4 a_Position; // UNORM16, [0, 1] inside the mesh bounds
+layout (location = 1) in vec4 a_Color;    // UNORM8
+layout (location = 2) in vec2 a_Normal;   // SNORM16, octahedral
+layout (location = 3) in vec2 a_UV;       // half float
+
+layout (location = 0) out vec3 o_FragColor;
+layout (location = 1) out vec3 o_FragPositionWorld;
+layout (location = 2) out vec3 o_FragNormalWorld;
+
+struct PointLight {
+    vec4 Position; // ignore w
+    vec4 Color;    // w is intensity
+};
+
+layout (set = 0, binding = 0) uniform GlobalUbo {
+    mat4 ProjectionMatrix;
+    mat4 ViewMatrix;
+    mat4 InverseViewMatrix;
+    vec4 AmbientLightColor; // w is intensity
+    PointLight PointLights[10]; // Study and use <<Specialization Constants>> instead of hardcoding.
+    int ActiveLightsCount;
+} ubo;
+
+struct Object {
+    mat4 ModelMatrix;
+    mat4 NormalMatrix; // we use a mat4 for aligment rules, it will be truncated when used.
+};
+
+layout (std430, set = 0, binding = 1) readonly buffer Objects {
+    Object objects[];
+};
+
+layout (push_constant) uniform PushConstants {
+    mat4 DequantizationMatrix; // of the model, positions are relative to its bounds
+    uint ObjectIndex;
+} push;
+
+vec3 DecodeOctahedral(vec2 encoded) {
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-normal.z, 0.0);
+
+    normal.x += normal.x >= 0.0 ? -fold : fold;
+    normal.y += normal.y >= 0.0 ? -fold : fold;
+
+    return normalize(normal);
+}
+
+void main() {
+
+    // Vertex is in model space, light is in world space
+    Object object = objects[push.ObjectIndex];
+    vec4 vertexPositionWorld = object.ModelMatrix * (push.DequantizationMatrix * vec4(a_Position.xyz, 1.0));
+
+    gl_Position = ubo.ProjectionMatrix * (ubo.ViewMatrix * vertexPositionWorld);
+
+    o_FragNormalWorld = normalize(mat3(object.NormalMatrix) * DecodeOctahedral(a_Normal));
+    o_FragPositionWorld = vertexPositionWorld.xyz;
+    o_FragColor = a_Color.rgb;
+}
@@ -38,7 +38,38 @@ LIB_DIR     = 'deps/libs'
 
 libraries = ['glfw3dll', 'gdi32', 'vulkan-1']
 
-def compile_file(file_path: str, debug = False) -> int:
+# tools, separate executables so each gets its own object directory
+PACKER_NAME    = 'asset_packer'
+PACKER_OBJ_DIR = 'obj_tools'
+PACKER_SOURCES = ['tools/asset_packer.cpp', 'src/engine/asset_archive.cpp', 'src/engine/lz4.cpp', 'src/engine/mapped_file.cpp']
+
+BENCHMARK_NAME    = 'transform_benchmark'
+BENCHMARK_OBJ_DIR = 'obj_benchmark'
+BENCHMARK_SOURCES = ['tools/transform_benchmark.cpp', 'src/engine/transform_batch.cpp', 'src/engine/components.cpp']
+
+JOBS_BENCHMARK_NAME    = 'job_benchmark'
+JOBS_BENCHMARK_OBJ_DIR = 'obj_job_benchmark'
+JOBS_BENCHMARK_SOURCES = ['tools/job_benchmark.cpp', 'src/engine/job_system.cpp', 'src/engine/transform_batch.cpp']
+
+OBJ_BENCHMARK_NAME    = 'obj_benchmark'
+OBJ_BENCHMARK_OBJ_DIR = 'obj_obj_benchmark'
+OBJ_BENCHMARK_SOURCES = ['tools/obj_benchmark.cpp', 'src/engine/obj_loader.cpp', 'src/engine/asset_file.cpp', 'src/engine/asset_archive.cpp', 'src/engine/lz4.cpp',
+                         'src/engine/mapped_file.cpp']
+
+WELD_BENCHMARK_NAME    = 'weld_benchmark'
+WELD_BENCHMARK_OBJ_DIR = 'obj_weld_benchmark'
+WELD_BENCHMARK_SOURCES = ['tools/weld_benchmark.cpp', 'src/engine/vertex_welder.cpp']
+
+CULL_CHECK_NAME    = 'meshlet_cull_check'
+CULL_CHECK_OBJ_DIR = 'obj_cull_check'
+CULL_CHECK_SOURCES = ['tools/meshlet_cull_check.cpp', 'src/engine/meshlet.cpp', 'src/engine/frustum.cpp', 'src/engine/camera.cpp']
+
+ENTITY_CHECK_NAME    = 'entity_commands_check'
+ENTITY_CHECK_OBJ_DIR = 'obj_entity_check'
+ENTITY_CHECK_SOURCES = ['tools/entity_commands_check.cpp', 'src/engine/entity_command_buffer.cpp', 'src/engine/scene.cpp', 'src/engine/scene_bvh.cpp', 'src/engine/frustum.cpp',
+                        'src/engine/entity.cpp', 'src/engine/transform_store.cpp', 'src/engine/transform_batch.cpp', 'src/engine/job_system.cpp', 'src/engine/components.cpp']
+
+def compile_file(file_path: str, debug = False, obj_dir = OBJ_DIR) -> int:
     build_mode = '-g' if debug else '-O2'
     file_name_no_dir       = file_path.split(os.path.sep)[-1]
     file_name_dot_index    = file_name_no_dir.find('.')
@@ -58,7 +89,7 @@ def compile_file(file_path: str, debug = False) -> int:
         '-I',
         get_dir(f'{INC_DIR}/vulkan-sdk/Include'),
         '-o',
-        get_dir(f'{OBJ_DIR}/{file_name_no_extension}.o'),
+        get_dir(f'{obj_dir}/{file_name_no_extension}.o'),
     ]
     
     log_info(f'Compiling {file_path}...')
@@ -73,18 +104,18 @@ def compile_file(file_path: str, debug = False) -> int:
     
     return True
 
-def link_file(obj_file_path) -> bool:
-    obj_files = glob.glob(f'{OBJ_DIR}/**/*.o', recursive=True)
+def link_file(obj_file_path, obj_dir = OBJ_DIR, app_name = APP_NAME, libs = libraries) -> bool:
+    obj_files = glob.glob(f'{obj_dir}/**/*.o', recursive=True)
 
     link_command = [
         TARGET,
         *obj_files,
         '-o',
-        APP_NAME,
+        app_name,
         f'-L{get_dir(LIB_DIR)}',
     ]
 
-    for lib in libraries:
+    for lib in libs:
         link_command.append(f'-l{lib}')
 
     log_info(f'Linking {obj_file_path}/**/*.o...')
@@ -99,6 +130,17 @@ def link_file(obj_file_path) -> bool:
     
     return True
 
+def build_tool(name: str, obj_dir: str, sources: list, debug = False):
+    if not os.path.exists(obj_dir):
+        os.mkdir(obj_dir)
+
+    for src_file in sources:
+        if not compile_file(src_file, debug, obj_dir):
+            return
+
+    if link_file(get_dir(obj_dir), obj_dir, name, []):
+        log_info(f'{name} built.', c_green)
+
 def main():
     if not os.path.exists(OBJ_DIR):
         os.mkdir(OBJ_DIR)
@@ -107,8 +149,43 @@ def main():
     parser.add_argument('--debug', action='store_true', help='Compiles program with debug symbols')
     parser.add_argument('--clean', action='store_true', help='Deletes all object files')
     parser.add_argument('--clean-all', action='store_true', help='Deletes executable and all object files')
+    parser.add_argument('--packer', action='store_true', help='Builds the asset packer, run it from here to write assets.pak')
+    parser.add_argument('--benchmark', action='store_true', help='Builds the transform benchmark, checks the batch transform paths and times them')
+    parser.add_argument('--jobs-benchmark', action='store_true', help='Builds the job system benchmark, times its workloads from 1 thread up to every core')
+    parser.add_argument('--obj-benchmark', action='store_true', help='Builds the OBJ benchmark, parses the same files with ObjLoader and tinyobj and compares MB/s')
+    parser.add_argument('--weld-benchmark', action='store_true', help='Builds the weld benchmark, checks VertexWelder against the unordered_map weld and times both')
+    parser.add_argument('--cull-check', action='store_true', help='Builds the meshlet cull check, compares Meshlet::Cull with brute force sphere and cone tests')
+    parser.add_argument('--entity-check', action='store_true', help='Builds the entity command buffer check, records from job threads and verifies the scene after playback')
     args = parser.parse_args()
 
+    if args.packer:
+        build_tool(PACKER_NAME, PACKER_OBJ_DIR, PACKER_SOURCES, args.debug)
+        return
+
+    if args.benchmark:
+        build_tool(BENCHMARK_NAME, BENCHMARK_OBJ_DIR, BENCHMARK_SOURCES, args.debug)
+        return
+
+    if args.jobs_benchmark:
+        build_tool(JOBS_BENCHMARK_NAME, JOBS_BENCHMARK_OBJ_DIR, JOBS_BENCHMARK_SOURCES, args.debug)
+        return
+
+    if args.obj_benchmark:
+        build_tool(OBJ_BENCHMARK_NAME, OBJ_BENCHMARK_OBJ_DIR, OBJ_BENCHMARK_SOURCES, args.debug)
+        return
+
+    if args.weld_benchmark:
+        build_tool(WELD_BENCHMARK_NAME, WELD_BENCHMARK_OBJ_DIR, WELD_BENCHMARK_SOURCES, args.debug)
+        return
+
+    if args.cull_check:
+        build_tool(CULL_CHECK_NAME, CULL_CHECK_OBJ_DIR, CULL_CHECK_SOURCES, args.debug)
+        return
+
+    if args.entity_check:
+        build_tool(ENTITY_CHECK_NAME, ENTITY_CHECK_OBJ_DIR, ENTITY_CHECK_SOURCES, args.debug)
+        return
+
     if args.clean or args.clean_all:
         obj_files = glob.glob(f'{OBJ_DIR}/**/*.o', recursive=True)
         
@@ -1,5 +1,6 @@
 deps/include/vulkan-sdk/Bin/glslc.exe assets/shaders/sh_diffuse.vert -o assets/shaders/sh_diffuse.vert.spv
 deps/include/vulkan-sdk/Bin/glslc.exe assets/shaders/sh_diffuse.frag -o assets/shaders/sh_diffuse.frag.spv
+deps/include/vulkan-sdk/Bin/glslc.exe assets/shaders/sh_diffuse_packed.vert -o assets/shaders/sh_diffuse_packed.vert.spv
 
 deps/include/vulkan-sdk/Bin/glslc.exe assets/shaders/sh_point_light.vert -o assets/shaders/sh_point_light.vert.spv
 deps/include/vulkan-sdk/Bin/glslc.exe assets/shaders/sh_point_light.frag -o assets/shaders/sh_point_light.frag.spv
\ No newline at end of file
@@ -1,9 +1,16 @@
 #include "app.hpp"
 
+#include "asset_file.hpp"
 #include "keyboard_movement.hpp"
+#include "systems/bounds_system.hpp"
 #include "systems/render_system.hpp"
 #include "systems/point_light_system.hpp"
 #include "camera.hpp"
+#include "fixed_timestep.hpp"
+#include "model_streamer.hpp"
+#include "object_buffer.hpp"
+#include "scene_snapshot.hpp"
+#include "task_graph.hpp"
 #include "vulkan_buffer.hpp"
 
 // libs
@@ -11,28 +18,57 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 
 // std
 #include <stdexcept>
 #include <chrono>
+#include <cstring>
 #include <array>
 #include <iostream>
+#include <optional>
 
 namespace Engine {
 
     constexpr float MAX_DELTA_TIME = 0.3F;
+    constexpr float SIMULATION_STEP = 1.0f / 60.0f; // seconds, movement runs at this rate whatever the frame rate is
+    constexpr uint32_t MAX_SIMULATION_STEPS = 4;    // per frame, past that the simulation slows down
+    constexpr float LIGHT_ORBIT_SPEED = 1.0f;       // radians per second, point lights circle the vertical axis
+    constexpr VkDeviceSize MODEL_MEMORY_BUDGET = 256 * 1024 * 1024;
+    constexpr const char* ASSET_ARCHIVE = "assets.pak"; // built by the asset packer, loose files under assets/ are used without it
+    constexpr const char* SCENE_SNAPSHOT = "scene.snap"; // saved with F5, the built in scene is used without it
 
     App::App() {
+        AssetFile::Mount(ASSET_ARCHIVE);
+
         _globalPool = LveDescriptorPool::Builder(_device)
                 .setMaxSets(SwapChain::MAX_FRAMES_IN_FLIGHT)
                 .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, SwapChain::MAX_FRAMES_IN_FLIGHT)
+                .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, SwapChain::MAX_FRAMES_IN_FLIGHT)
                 .build();
 
-        LoadGameObjects();
+        SceneSnapshot::Stats snapshotStats {};
+        bool isSnapshotLoaded = false;
+
+        // A damaged snapshot is reported and the built in scene loads instead, Load throws before it adds anything.
+        try {
+            isSnapshotLoaded = SceneSnapshot::Load(SCENE_SNAPSHOT, _scene, _modelRegistry, snapshotStats);
+        }
+        catch (const std::exception& exception) {
+            std::cerr << "Ignored " << SCENE_SNAPSHOT << ": " << exception.what() << '\n';
+        }
+
+        if (isSnapshotLoaded) {
+            std::cout << "Loaded " << SCENE_SNAPSHOT << ": " << snapshotStats.EntityCount << " entities, " << snapshotStats.ModelCount
+                      << " models in " << snapshotStats.Seconds * 1000.0 << " ms\n";
+        }
+        else {
+            LoadGameObjects();
+        }
     }
 
-    App::~App() 
-    {
+    App::~App() {
+        AssetFile::Unmount();
     }
 
     void App::Run() {
@@ -51,99 +87,228 @@ namespace Engine {
             uboBuffers[i]->map();
         }
 
+        ObjectBuffer objectBuffer { _device, SwapChain::MAX_FRAMES_IN_FLIGHT };
+
         auto globalSetLayout = LveDescriptorSetLayout::Builder(_device)
                                 .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS) // UBO available in all shader stages
+                                .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)   // object matrices
                                 .build();
 
         std::vector<VkDescriptorSet> globalDescriptorSets(SwapChain::MAX_FRAMES_IN_FLIGHT);
 
         for (int i = 0; i < globalDescriptorSets.size(); i++) {
             auto bufferInfo = uboBuffers[i]->descriptorInfo();
+            auto objectBufferInfo = objectBuffer.GetDescriptorInfo(i);
 
             LveDescriptorWriter(*globalSetLayout, *_globalPool)
                 .writeBuffer(0, &bufferInfo)
+                .writeBuffer(1, &objectBufferInfo)
                 .build(globalDescriptorSets[i]);
         }
 
             
-        RenderSystem renderSystem { _device, _renderer.GetSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout() };
+        RenderSystem renderSystem { _device, _modelRegistry, _renderer.GetSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout() };
+        BoundsSystem boundsSystem { _modelRegistry };
         PointLightSystem pointLightSystem { _device, _renderer.GetSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout() };
+        ModelStreamer modelStreamer { _geometryPool, _modelRegistry, MODEL_MEMORY_BUDGET, _modelRegistry.Load("assets/models/cube.obj") };
 
 
         Camera camera {};
         //camera.SetViewDirection(glm::vec3(0.0f), glm::vec3(0.5f, 0.0f, 1.0f));
         camera.SetViewTarget(glm::vec3 { 0.0f }, glm::vec3 { 0.0f, 0.0f, 1.0f });
 
-        auto viewerObject = GameObject::CreateGameObject(); // Gameobject that serves as camera
+        TransformComponent viewerTransform {}; // moved by the keyboard, the camera follows it
+        TransformComponent previousViewerTransform {};
         KeyboardMovement cameraController {};
 
-        auto currentTime = std::chrono::high_resolution_clock::now();
+        FixedTimestep simulationTimestep { SIMULATION_STEP, MAX_SIMULATION_STEPS };
 
-        // Game Loop
-        while (!_window.ShouldClose()) {
-            glfwPollEvents(); // check key strokes or window buttons (minimize, maximize, close)
+        // One frame as tasks, in the order a single thread would run them. The graph works out what can overlap:
+        // transforms update while the main thread waits for the next swap chain image, lights are gathered
+        // while the draw list is built.
+        TaskGraph frameGraph { _jobSystem };
 
-            auto newTime = std::chrono::high_resolution_clock::now();
-            float deltaTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
-            deltaTime = std::min(deltaTime, MAX_DELTA_TIME);
+        float deltaTime = 0.0f;
+        std::optional<FrameInfo> frameInfo {}; // empty when the swap chain was recreated and there is nothing to draw into
+        GlobalUBO ubo {};
+        std::vector<std::optional<GlobalUBO>> writtenUbos(SwapChain::MAX_FRAMES_IN_FLIGHT); // what each frame's buffer holds
 
-            currentTime = newTime;
+        // Movement in fixed steps, everything drawn is interpolated between the last two. On the main thread because
+        // it reads input, nothing in a step touches the renderer.
+        frameGraph.AddTask("simulation", [&] {
+            const uint32_t stepCount = simulationTimestep.Advance(deltaTime);
 
-            cameraController.MoveInPlaneXZ(_window.GetWindow(), deltaTime, viewerObject);
-            camera.SetViewYXZ(viewerObject.Transform.Position, viewerObject.Transform.Rotation);
+            for (uint32_t step = 0; step < stepCount; step++) {
+                _scene.Transforms.BeginStep();
+                previousViewerTransform = viewerTransform;
+
+                cameraController.MoveInPlaneXZ(_window.GetWindow(), simulationTimestep.GetStep(), viewerTransform);
+
+                // Moved through Set like any simulated transform, frames between steps draw them interpolated.
+                const glm::mat4 orbit = glm::rotate(glm::mat4 { 1.0f }, LIGHT_ORBIT_SPEED * simulationTimestep.GetStep(), { 0.0f, -1.0f, 0.0f });
+
+                for (uint32_t i = 0; i < _scene.PointLights.GetSize(); i++) {
+                    const uint32_t index = _scene.Transforms.IndexOf(_scene.PointLights.GetEntities()[i]);
+
+                    TransformComponent transform = _scene.Transforms.Get(index);
+                    transform.Position = glm::vec3 { orbit * glm::vec4 { transform.Position, 1.0f } };
+                    _scene.Transforms.Set(index, transform);
+                }
+            }
+
+            _scene.Transforms.SetInterpolation(simulationTimestep.GetAlpha());
+        }, {}, { "simulation", "transforms" }, TaskGraph::Affinity::MainThread);
+
+        frameGraph.AddTask("camera", [&] {
+            const TransformComponent viewer = TransformComponent::Interpolate(previousViewerTransform, viewerTransform, simulationTimestep.GetAlpha());
+            camera.SetViewYXZ(viewer.Position, viewer.Rotation);
 
             float aspectRatio = _renderer.GetAspectRatio();
             camera.SetPerspectiveProjection(glm::radians(50.0f), aspectRatio, 0.01f, 10.0f);
+        }, { "swap_chain", "simulation" }, { "camera" }, TaskGraph::Affinity::MainThread);
+
+        frameGraph.AddTask("begin_frame", [&] {
+            frameInfo.reset();
 
             if (auto commandBuffer = _renderer.BeginFrame()) {
                 int frameIndex = _renderer.GetFrameIndex();
-                FrameInfo frameInfo { frameIndex, deltaTime, commandBuffer, camera, globalDescriptorSets[frameIndex], _gameObjectByID };
+                frameInfo.emplace(FrameInfo { frameIndex, deltaTime, commandBuffer, camera, globalDescriptorSets[frameIndex], _scene });
+            }
+        }, {}, { "frame", "swap_chain" }, TaskGraph::Affinity::MainThread);
+
+        frameGraph.AddTask("transforms", [&] {
+            _scene.Update(&_jobSystem); // world matrices of whatever moved since last frame
+        }, {}, { "transforms" });
+
+        frameGraph.AddTask("model_streamer", [&] {
+            if (frameInfo) {
+                modelStreamer.Update(*frameInfo);
+                _modelRegistry.Update();
+                _geometryPool.Update();
+                _uploadManager.Flush(); // geometry uploaded this frame is submitted ahead of the frame that draws it
+            }
+        }, { "frame", "camera", "transforms", "streamed_models" }, { "renderables", "models", "uploads" }, TaskGraph::Affinity::MainThread);
 
-                // Update
-                GlobalUBO ubo {};
+        frameGraph.AddTask("bounds", [&] {
+            boundsSystem.Update(_scene);
+        }, { "transforms", "renderables", "point_lights", "models" }, { "bounds" });
+
+        frameGraph.AddTask("lights", [&] {
+            if (frameInfo) {
+                ubo = GlobalUBO {};
                 ubo.ProjectionMatrix = camera.GetProjectionMatrix();
                 ubo.ViewMatrix = camera.GetViewMatrix();
                 ubo.InverseViewMatrix = camera.GetInverseViewMatrix();
 
-                pointLightSystem.Update(frameInfo, ubo);
+                pointLightSystem.Update(*frameInfo, ubo);
+            }
+        }, { "frame", "camera", "bounds", "point_lights", "transforms" }, { "ubo" });
+
+        frameGraph.AddTask("ubo_upload", [&] {
+            if (frameInfo) {
+                std::optional<GlobalUBO>& writtenUbo = writtenUbos[frameInfo->FrameIndex];
+
+                if (!writtenUbo || std::memcmp(&*writtenUbo, &ubo, sizeof(GlobalUBO)) != 0) {
+                    uboBuffers[frameInfo->FrameIndex]->writeToBuffer(&ubo);
+                    uboBuffers[frameInfo->FrameIndex]->flush();
+                    writtenUbo = ubo;
+                }
+            }
+        }, { "frame", "ubo" }, { "ubo_buffers" });
+
+        frameGraph.AddTask("object_upload", [&] {
+            objectBuffer.TrackChanges(_scene.Transforms);
+
+            if (frameInfo && objectBuffer.Upload(_scene.Transforms, frameInfo->FrameIndex)) {
+                auto objectBufferInfo = objectBuffer.GetDescriptorInfo(frameInfo->FrameIndex);
+
+                LveDescriptorWriter(*globalSetLayout, *_globalPool)
+                    .writeBuffer(1, &objectBufferInfo)
+                    .overwrite(globalDescriptorSets[frameInfo->FrameIndex]);
+            }
+        }, { "frame", "transforms" }, { "object_buffers" });
 
-                uboBuffers[frameIndex]->writeToBuffer(&ubo);
-                uboBuffers[frameIndex]->flush();
+        frameGraph.AddTask("draw_list", [&] {
+            if (frameInfo) {
+                renderSystem.BuildDrawList(*frameInfo); // also moves LODs, which live in the renderables
+            }
+        }, { "frame", "camera", "bounds", "transforms", "models" }, { "draw_list", "renderables" });
 
-                // Render
-                _renderer.BeginSwapChainRenderPass(commandBuffer);
+        frameGraph.AddTask("record", [&] {
+            if (frameInfo) {
+                _renderer.BeginSwapChainRenderPass(frameInfo->CommandBuffer);
 
-                renderSystem.RenderGameObjects(frameInfo);
-                pointLightSystem.Render(frameInfo);
+                renderSystem.RenderGameObjects(*frameInfo);
+                pointLightSystem.Render(*frameInfo);
 
-                _renderer.EndSwapChainRenderPass(commandBuffer);
+                _renderer.EndSwapChainRenderPass(frameInfo->CommandBuffer);
                 _renderer.EndFrame();
             }
+
+            _scene.ClearChanges(); // every system has seen this frame's changes
+        }, { "draw_list", "ubo_buffers", "object_buffers", "uploads", "bounds", "transforms", "camera" }, { "frame", "renderables", "point_lights", "streamed_models" },
+           TaskGraph::Affinity::MainThread);
+
+        auto currentTime = std::chrono::high_resolution_clock::now();
+        bool wasSaveDown = false;
+        bool wasReportDown = false;
+
+        // Game Loop
+        while (!_window.ShouldClose()) {
+            glfwPollEvents(); // check key strokes or window buttons (minimize, maximize, close)
+
+            auto newTime = std::chrono::high_resolution_clock::now();
+            deltaTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
+            deltaTime = std::min(deltaTime, MAX_DELTA_TIME);
+
+            currentTime = newTime;
+
+            const bool isSaveDown = glfwGetKey(_window.GetWindow(), GLFW_KEY_F5) == GLFW_PRESS;
+
+            if (isSaveDown && !wasSaveDown) {
+                const SceneSnapshot::Stats stats = SceneSnapshot::Save(SCENE_SNAPSHOT, _scene, _modelRegistry);
+                std::cout << "Saved " << SCENE_SNAPSHOT << ": " << stats.EntityCount << " entities, " << stats.Bytes << " bytes in "
+                          << stats.Seconds * 1000.0 << " ms\n";
+            }
+
+            wasSaveDown = isSaveDown;
+
+            // Nothing runs between frames, entities spawned or destroyed during the last one become real here.
+            const EntityCommandBuffer::Stats commandStats = _entityCommands.Playback();
+
+            frameGraph.Run();
+
+            // F6 prints where the last frame's time went.
+            const bool isReportDown = glfwGetKey(_window.GetWindow(), GLFW_KEY_F6) == GLFW_PRESS;
+
+            if (isReportDown && !wasReportDown) {
+                frameGraph.LogReport();
+
+                const ObjectBuffer::Stats& objectStats = objectBuffer.GetStats();
+                std::cout << "Objects: " << objectStats.ChangedCount << " of " << objectStats.ObjectCount << " changed, " << objectStats.WrittenCount
+                          << " written in " << objectStats.RangeCount << " ranges (" << objectStats.WrittenBytes << " bytes)" << std::endl;
+                std::cout << "Entity commands: " << commandStats.CreatedCount << " created, " << commandStats.DestroyedCount << " destroyed, "
+                          << commandStats.AddedCount << " components added, " << commandStats.RemovedCount << " removed" << std::endl;
+            }
+
+            wasReportDown = isReportDown;
         }
 
         vkDeviceWaitIdle(_device.device());
+        _modelRegistry.LogStats();
     }
 
+    // Recorded like anything else that spawns, the first frame's playback makes it real.
     void App::LoadGameObjects() {
-        std::shared_ptr<Model> monkeyModel = Model::CreateModelFromFile(_device, "assets/models/monkey.obj");
-
-        auto monkey = GameObject::CreateGameObject();
-        monkey.Model = monkeyModel;
-        monkey.Transform.Position = { 0.0f, 0.0f, 1.0f };
-        monkey.Transform.Scale = { 2.0f, 2.0f, 2.0f };
-
-        std::shared_ptr<Model> quadModel = Model::CreateModelFromFile(_device, "assets/models/quad.obj");
-        auto floor = GameObject::CreateGameObject();
-        floor.Model = quadModel;
-        floor.Transform.Position = { 0.0f, 0.2f, 0.0f };
-        floor.Transform.Scale = { 3.0f, -1.0f, 3.0f };
+        const Entity monkey = _entityCommands.CreateEntity({ { 0.0f, 0.0f, 1.0f }, { 2.0f, 2.0f, 2.0f } });
+        _entityCommands.AddStreamedModel(monkey, { "assets/models/monkey.obj" }); // draws the placeholder until it is loaded
 
-        auto pointLight = GameObject::CreatePointLight(1.2f);
+        const Entity floor = _entityCommands.CreateEntity({ { 0.0f, 0.2f, 0.0f }, { 3.0f, -1.0f, 3.0f } });
+        _entityCommands.AddRenderable(floor, { _modelRegistry.Load("assets/models/quad.obj") }); // the scene keeps this reference for its lifetime
 
-        // After moved, all local gameobject variables are invalid.
-        _gameObjectByID.emplace(monkey.GetID(), std::move(monkey));
-        _gameObjectByID.emplace(floor.GetID(), std::move(floor));
-        _gameObjectByID.emplace(pointLight.GetID(), std::move(pointLight));
+        PointLightComponent light {};
+        light.LightIntensity = 1.2f;
+        _entityCommands.AddPointLight(_entityCommands.CreateEntity({ { 1.0f, -1.0f, 1.0f } }), light); // off the axis it orbits
     }
 
 } // namespace Engine
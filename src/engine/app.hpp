@@ -3,9 +3,14 @@
 // libs
 #include "descriptor.hpp"
 #include "device.hpp"
-#include "game_object.hpp"
+#include "entity_command_buffer.hpp"
+#include "geometry_pool.hpp"
+#include "job_system.hpp"
+#include "model_registry.hpp"
 #include "window.hpp"
 #include "renderer.hpp"
+#include "scene.hpp"
+#include "upload_manager.hpp"
 
 // std
 #include <memory>
@@ -35,9 +40,14 @@ namespace Engine {
         Window _window { WINDOW_WIDTH, WINDOW_HEIGHT, "Vuwulkan Engine" };
         Device _device { _window };
         Renderer _renderer { _window, _device };
+        UploadManager _uploadManager { _device };
+        GeometryPool _geometryPool { _device, _uploadManager }; // declared before the registry, its models free into it
+        ModelRegistry _modelRegistry { _geometryPool };
 
         std::unique_ptr<LveDescriptorPool> _globalPool {};
-        GameObject::Map _gameObjectByID;
+        Scene _scene {};
+        JobSystem _jobSystem {}; // every thread but this one, frame tasks and the parallel loops inside them share it
+        EntityCommandBuffer _entityCommands { _scene, _jobSystem }; // played back between frames
     };
 
 } // namespace Engine
@@ -0,0 +1,218 @@
+#include "asset_archive.hpp"
+
+#include "lz4.hpp"
+#include "utils.hpp"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace Engine {
+
+    static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    static uint64_t HashName(const std::string& name) {
+        return hashBytes(name.data(), name.size());
+    }
+
+    AssetArchive::AssetArchive(const std::string& filepath)
+        : _file(filepath)
+    {
+        if (!_file.IsOpen()) {
+            throw std::runtime_error("Failed to open asset archive " + filepath);
+        }
+
+        Header header {};
+
+        if (_file.GetSize() >= sizeof(Header)) {
+            std::memcpy(&header, _file.GetData(), sizeof(Header));
+        }
+
+        if (header.Magic != MAGIC || header.Version != VERSION) {
+            throw std::runtime_error(filepath + " is not an asset archive of version " + std::to_string(VERSION));
+        }
+
+        const uint64_t entryBytes = static_cast<uint64_t>(header.EntryCount) * sizeof(TocEntry);
+
+        if (header.TocOffset > _file.GetSize() || header.TocStoredSize > _file.GetSize() - header.TocOffset || header.TocSize < entryBytes) {
+            throw std::runtime_error("Asset archive " + filepath + " has a damaged table of contents");
+        }
+
+        std::vector<uint8_t> toc(header.TocSize);
+
+        if (!Lz4::Decompress(_file.GetData() + header.TocOffset, header.TocStoredSize, toc.data(), toc.size())) {
+            throw std::runtime_error("Asset archive " + filepath + " has a damaged table of contents");
+        }
+
+        _entries.resize(header.EntryCount);
+        std::memcpy(_entries.data(), toc.data(), entryBytes);
+        _names.assign(reinterpret_cast<const char*>(toc.data() + entryBytes), toc.size() - entryBytes);
+
+        for (const auto& entry : _entries) {
+            if (entry.Offset > header.TocOffset || entry.StoredSize > header.TocOffset - entry.Offset
+                || static_cast<uint64_t>(entry.NameOffset) + entry.NameLength > _names.size()) {
+                throw std::runtime_error("Asset archive " + filepath + " has an entry outside of the file");
+            }
+        }
+    }
+
+    const AssetArchive::TocEntry* AssetArchive::Find(const std::string& name) const {
+        const std::string normalized = NormalizeName(name);
+        const uint64_t hash = HashName(normalized);
+
+        auto it = std::lower_bound(_entries.begin(), _entries.end(), hash, [](const TocEntry& entry, uint64_t value) { return entry.PathHash < value; });
+
+        for (; it != _entries.end() && it->PathHash == hash; it++) {
+            if (_names.compare(it->NameOffset, it->NameLength, normalized) == 0) {
+                return &*it;
+            }
+        }
+
+        return nullptr;
+    }
+
+    const uint8_t* AssetArchive::Read(const TocEntry& entry, std::vector<uint8_t>& storage) const {
+        const uint8_t* data = _file.GetData() + entry.Offset;
+
+        if (entry.EntryCompression == Compression::None) {
+            return entry.StoredSize == entry.Size ? data : nullptr;
+        }
+
+        storage.resize(entry.Size);
+
+        if (entry.EntryCompression != Compression::Lz4 || !Lz4::Decompress(data, entry.StoredSize, storage.data(), storage.size())) {
+            return nullptr;
+        }
+
+        return storage.data();
+    }
+
+    AssetArchive::WriteStats AssetArchive::Write(const std::string& filepath, const std::vector<Source>& sources) {
+        const auto startTime = std::chrono::high_resolution_clock::now();
+
+        const std::string tempPath = filepath + ".tmp";
+        std::ofstream file { tempPath, std::ios::binary | std::ios::trunc };
+
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to write asset archive " + filepath);
+        }
+
+        WriteStats stats {};
+        std::vector<TocEntry> entries {};
+        std::string names {};
+
+        const char zeros[DATA_ALIGNMENT] {};
+        uint64_t offset = sizeof(Header);
+
+        file.write(zeros, sizeof(Header)); // written last, once the TOC location is known
+
+        std::vector<uint8_t> compressed {};
+
+        for (const auto& source : sources) {
+            MappedFile sourceFile { source.Filepath };
+
+            if (!sourceFile.IsOpen()) {
+                throw std::runtime_error("Failed to open " + source.Filepath);
+            }
+
+            TocEntry entry {};
+            const std::string name = NormalizeName(source.Name);
+
+            entry.PathHash = HashName(name);
+            entry.Size = sourceFile.GetSize();
+            entry.NameOffset = static_cast<uint32_t>(names.size());
+            entry.NameLength = static_cast<uint32_t>(name.size());
+            names += name;
+
+            compressed.clear();
+            Lz4::Compress(sourceFile.GetData(), sourceFile.GetSize(), compressed);
+
+            const bool keepCompressed = compressed.size() <= entry.Size - static_cast<uint64_t>(entry.Size * MIN_COMPRESSION_GAIN);
+            const uint8_t* data = keepCompressed ? compressed.data() : sourceFile.GetData();
+
+            entry.EntryCompression = keepCompressed ? Compression::Lz4 : Compression::None;
+            entry.StoredSize = keepCompressed ? compressed.size() : entry.Size;
+
+            const uint64_t alignedOffset = AlignUp(offset, DATA_ALIGNMENT);
+            file.write(zeros, alignedOffset - offset);
+            file.write(reinterpret_cast<const char*>(data), entry.StoredSize);
+
+            entry.Offset = alignedOffset;
+            offset = alignedOffset + entry.StoredSize;
+
+            entries.push_back(entry);
+
+            stats.EntryCount++;
+            stats.CompressedCount += keepCompressed ? 1 : 0;
+            stats.Bytes += entry.Size;
+            stats.StoredBytes += entry.StoredSize;
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const TocEntry& a, const TocEntry& b) { return a.PathHash < b.PathHash; });
+
+        for (size_t i = 1; i < entries.size(); i++) {
+            if (entries[i].PathHash == entries[i - 1].PathHash
+                && names.compare(entries[i].NameOffset, entries[i].NameLength, names, entries[i - 1].NameOffset, entries[i - 1].NameLength) == 0) {
+                file.close();
+                std::remove(tempPath.c_str());
+                throw std::runtime_error("Asset archive " + filepath + " would contain " + names.substr(entries[i].NameOffset, entries[i].NameLength) + " twice");
+            }
+        }
+
+        std::vector<uint8_t> toc(entries.size() * sizeof(TocEntry) + names.size());
+        std::memcpy(toc.data(), entries.data(), entries.size() * sizeof(TocEntry));
+        std::memcpy(toc.data() + entries.size() * sizeof(TocEntry), names.data(), names.size());
+
+        compressed.clear();
+        Lz4::Compress(toc.data(), toc.size(), compressed);
+
+        Header header {};
+        header.Magic = MAGIC;
+        header.Version = VERSION;
+        header.EntryCount = static_cast<uint32_t>(entries.size());
+        header.TocOffset = AlignUp(offset, DATA_ALIGNMENT);
+        header.TocStoredSize = compressed.size();
+        header.TocSize = toc.size();
+
+        file.write(zeros, header.TocOffset - offset);
+        file.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.close();
+
+        if (!file) {
+            std::remove(tempPath.c_str());
+            throw std::runtime_error("Failed to write asset archive " + filepath);
+        }
+
+        // Write then rename, same as the mesh cache, a failed pack never leaves a truncated archive behind.
+        std::remove(filepath.c_str());
+
+        if (std::rename(tempPath.c_str(), filepath.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+            throw std::runtime_error("Failed to write asset archive " + filepath);
+        }
+
+        stats.Seconds = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        return stats;
+    }
+
+    std::string AssetArchive::NormalizeName(const std::string& name) {
+        std::string normalized = name;
+        std::replace(normalized.begin(), normalized.end(), '\\', '/');
+
+        while (normalized.compare(0, 2, "./") == 0) {
+            normalized.erase(0, 2);
+        }
+
+        return normalized;
+    }
+
+} // namespace Engine
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "mapped_file.hpp"
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+    // Packed asset file ("*.pak"). Entry data starts on DATA_ALIGNMENT boundaries, so uncompressed entries can be
+    // used straight from the mapping. The table of contents sits at the end, LZ4 compressed and sorted by path hash.
+    //
+    // Header | entry data... | compressed TOC (TocEntry[EntryCount] followed by the names)
+    class AssetArchive {
+
+    public:
+        static constexpr uint32_t MAGIC = 0x4b415056; // "VPAK"
+        static constexpr uint32_t VERSION = 1;
+        static constexpr uint64_t DATA_ALIGNMENT = 64;
+        static constexpr float MIN_COMPRESSION_GAIN = 0.125f; // entries that shrink less than this are stored as they are
+
+        enum class Compression : uint32_t {
+            None,
+            Lz4,
+        };
+
+        struct Header {
+            uint32_t Magic;
+            uint32_t Version;
+            uint32_t EntryCount;
+            uint32_t Padding;
+            uint64_t TocOffset;
+            uint64_t TocStoredSize;
+            uint64_t TocSize;
+            uint64_t Reserved[3];
+        };
+
+        static_assert(sizeof(Header) == 64, "AssetArchive::Header layout must not change without bumping VERSION");
+
+        struct TocEntry {
+            uint64_t PathHash;
+            uint64_t Offset;
+            uint64_t StoredSize;
+            uint64_t Size;
+            Compression EntryCompression;
+            uint32_t NameOffset; // into the names after the entries
+            uint32_t NameLength;
+            uint32_t Padding;
+        };
+
+        static_assert(sizeof(TocEntry) == 48, "AssetArchive::TocEntry layout must not change without bumping VERSION");
+
+        // A file to pack, stored under Name.
+        struct Source {
+            std::string Name;
+            std::string Filepath;
+        };
+
+        struct WriteStats {
+            uint32_t EntryCount { 0 };
+            uint32_t CompressedCount { 0 };
+            uint64_t Bytes { 0 };
+            uint64_t StoredBytes { 0 };
+            double Seconds { 0.0 };
+        };
+
+        // Throws if the file is not an archive or its table of contents is damaged.
+        explicit AssetArchive(const std::string& filepath);
+
+        AssetArchive(const AssetArchive&) = delete;
+        AssetArchive& operator=(const AssetArchive&) = delete;
+
+        const TocEntry* Find(const std::string& name) const;
+
+        // Uncompressed entries point into the mapping, compressed ones are decompressed into storage.
+        // Null if the entry data is damaged.
+        const uint8_t* Read(const TocEntry& entry, std::vector<uint8_t>& storage) const;
+
+        uint32_t GetEntryCount() const {
+            return static_cast<uint32_t>(_entries.size());
+        }
+
+        std::string GetName(const TocEntry& entry) const {
+            return _names.substr(entry.NameOffset, entry.NameLength);
+        }
+
+        static WriteStats Write(const std::string& filepath, const std::vector<Source>& sources);
+
+        // Forward slashes and no leading "./", so "assets\\models\\cube.obj" and "./assets/models/cube.obj" find the same entry.
+        static std::string NormalizeName(const std::string& name);
+
+    private:
+        MappedFile _file;
+        std::vector<TocEntry> _entries {};
+        std::string _names {};
+    };
+
+} // namespace Engine
@@ -0,0 +1,68 @@
+#include "asset_file.hpp"
+
+#include "asset_archive.hpp"
+
+// std
+#include <iostream>
+#include <memory>
+#include <utility>
+
+namespace Engine {
+
+    static std::unique_ptr<AssetArchive> mountedArchive {};
+
+    AssetFile::AssetFile(const std::string& filepath) {
+        if (mountedArchive != nullptr) {
+            if (const AssetArchive::TocEntry* entry = mountedArchive->Find(filepath); entry != nullptr) {
+                _data = mountedArchive->Read(*entry, _storage);
+
+                if (_data == nullptr) {
+                    std::cerr << "Asset archive entry " << filepath << " is damaged" << '\n';
+                    return;
+                }
+
+                _size = entry->Size;
+                _isOpen = true;
+                return;
+            }
+        }
+
+        _file = MappedFile { filepath };
+        _data = _file.GetData();
+        _size = _file.GetSize();
+        _isOpen = _file.IsOpen();
+    }
+
+    AssetFile::AssetFile(AssetFile&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    AssetFile& AssetFile::operator=(AssetFile&& other) noexcept {
+        if (this != &other) {
+            _file = std::move(other._file);
+            _storage = std::move(other._storage); // moving keeps the buffer, _data stays valid
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0);
+            _isOpen = std::exchange(other._isOpen, false);
+        }
+
+        return *this;
+    }
+
+    bool AssetFile::Mount(const std::string& archivePath) {
+        if (!MappedFile { archivePath }.IsOpen()) {
+            return false;
+        }
+
+        mountedArchive = std::make_unique<AssetArchive>(archivePath);
+
+        std::cout << "Mounted asset archive " << archivePath << " (" << mountedArchive->GetEntryCount() << " entries)" << std::endl;
+
+        return true;
+    }
+
+    void AssetFile::Unmount() {
+        mountedArchive.reset();
+    }
+
+} // namespace Engine
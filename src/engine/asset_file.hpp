@@ -0,0 +1,53 @@
+#pragma once
+
+#include "mapped_file.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+    class AssetArchive;
+
+    // Read-only contents of an asset. The path is looked up in the mounted archive first and falls back to the
+    // loose file, uncompressed archive entries and loose files are used straight from their mapping.
+    class AssetFile {
+
+    public:
+        AssetFile() = default;
+        explicit AssetFile(const std::string& filepath);
+
+        AssetFile(const AssetFile&) = delete;
+        AssetFile& operator=(const AssetFile&) = delete;
+        AssetFile(AssetFile&& other) noexcept;
+        AssetFile& operator=(AssetFile&& other) noexcept;
+
+        bool IsOpen() const {
+            return _isOpen;
+        }
+
+        const uint8_t* GetData() const {
+            return _data;
+        }
+
+        size_t GetSize() const {
+            return _size;
+        }
+
+        // Not thread safe, mount before anything loads assets and unmount once nothing does anymore.
+        // Returns false if there is no archive at the path, throws if it is damaged.
+        static bool Mount(const std::string& archivePath);
+        static void Unmount();
+
+    private:
+        MappedFile _file {};
+        std::vector<uint8_t> _storage {}; // decompressed archive entry
+        const uint8_t* _data { nullptr };
+        size_t _size { 0 };
+        bool _isOpen { false };
+    };
+
+} // namespace Engine
@@ -0,0 +1,241 @@
+#pragma once
+
+#include "entity.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Engine {
+
+    // Maps entities to indices into tightly packed arrays. Removing moves the last element into the hole, so the
+    // dense arrays never have gaps and iterating them touches nothing but live components.
+    // The entity to index table is split in fixed size pages, a store only pays for the index ranges it has entities in.
+    class SparseSet {
+
+    public:
+        static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+        static constexpr uint32_t PAGE_SIZE = 4096;
+
+        bool Contains(Entity entity) const {
+            return IndexOf(entity) != INVALID_INDEX;
+        }
+
+        // INVALID_INDEX for entities without this component, and for stale handles whose index has been reused.
+        uint32_t IndexOf(Entity entity) const {
+            const uint32_t page = entity.Index / PAGE_SIZE;
+
+            if (page >= _pages.size() || _pages[page] == nullptr) {
+                return INVALID_INDEX;
+            }
+
+            const uint32_t index = _pages[page][entity.Index % PAGE_SIZE];
+
+            return index != INVALID_INDEX && _entities[index] == entity ? index : INVALID_INDEX;
+        }
+
+        uint32_t GetSize() const {
+            return static_cast<uint32_t>(_entities.size());
+        }
+
+        // Entity owning each dense index.
+        const Entity* GetEntities() const {
+            return _entities.data();
+        }
+
+    protected:
+        void Reserve(uint32_t count) {
+            _entities.reserve(count);
+        }
+
+        uint32_t Insert(Entity entity) {
+            assert(!Contains(entity) && "Entity already has this component.");
+
+            const uint32_t index = GetSize();
+
+            GetSparse(entity) = index;
+            _entities.push_back(entity);
+
+            return index;
+        }
+
+        // Returns the index of the first one, the rest follow in order.
+        uint32_t InsertRange(const Entity* entities, uint32_t count) {
+            const uint32_t first = GetSize();
+
+            _entities.insert(_entities.end(), entities, entities + count);
+
+            for (uint32_t i = 0; i < count; i++) {
+                assert(GetSparse(entities[i]) == INVALID_INDEX && "Entity already has this component.");
+                GetSparse(entities[i]) = first + i;
+            }
+
+            return first;
+        }
+
+        // Returns the index the entity had, the caller moves its last element there the same way.
+        uint32_t Erase(Entity entity) {
+            assert(Contains(entity) && "Entity does not have this component.");
+
+            const uint32_t index = IndexOf(entity);
+            const Entity last = _entities.back();
+
+            _entities[index] = last;
+            GetSparse(last) = index;
+            GetSparse(entity) = INVALID_INDEX;
+            _entities.pop_back();
+
+            return index;
+        }
+
+        template<typename T>
+        static void EraseAt(std::vector<T>& values, uint32_t index) {
+            values[index] = std::move(values.back());
+            values.pop_back();
+        }
+
+        // Moves the entity at order[i] to index i, the caller reorders its arrays the same way with Reorder.
+        void Permute(const std::vector<uint32_t>& order) {
+            std::vector<Entity> entities(order.size());
+
+            for (uint32_t i = 0; i < order.size(); i++) {
+                entities[i] = _entities[order[i]];
+                GetSparse(entities[i]) = i;
+            }
+
+            _entities.swap(entities);
+        }
+
+        template<typename T>
+        static void Reorder(std::vector<T>& values, const std::vector<uint32_t>& order) {
+            std::vector<T> reordered {};
+            reordered.reserve(values.size());
+
+            for (uint32_t index : order) {
+                reordered.push_back(std::move(values[index]));
+            }
+
+            values.swap(reordered);
+        }
+
+    private:
+        uint32_t& GetSparse(Entity entity) {
+            const uint32_t page = entity.Index / PAGE_SIZE;
+
+            if (page >= _pages.size()) {
+                _pages.resize(page + 1);
+            }
+
+            if (_pages[page] == nullptr) {
+                _pages[page] = std::make_unique<uint32_t[]>(PAGE_SIZE);
+                std::fill_n(_pages[page].get(), PAGE_SIZE, INVALID_INDEX);
+            }
+
+            return _pages[page][entity.Index % PAGE_SIZE];
+        }
+
+    private:
+        std::vector<std::unique_ptr<uint32_t[]>> _pages {}; // indexed by entity index
+        std::vector<Entity> _entities {};
+    };
+
+    // Components of one type, stored contiguously in the order of the set.
+    //
+    // Also keeps track of what changed since the last ClearChanges: added components, the index a removal moved the
+    // last one into, and whatever was passed to MarkChanged after editing it in place.
+    template<typename T>
+    class ComponentStore : public SparseSet {
+
+    public:
+        T& Add(Entity entity, T component = {}) {
+            const uint32_t index = Insert(entity);
+            _components.push_back(std::move(component));
+            MarkChanged(index);
+            return _components.back();
+        }
+
+        // One bulk copy of the components, for loading many at once.
+        void AddRange(const Entity* entities, const T* components, uint32_t count) {
+            const uint32_t first = InsertRange(entities, count);
+            _components.insert(_components.end(), components, components + count);
+
+            for (uint32_t i = 0; i < count; i++) {
+                MarkChanged(first + i);
+            }
+        }
+
+        // Room for count components in total, for callers that add many one at a time.
+        void Reserve(uint32_t count) {
+            SparseSet::Reserve(count);
+            _components.reserve(count);
+        }
+
+        void Remove(Entity entity) {
+            const uint32_t index = Erase(entity);
+            EraseAt(_components, index);
+
+            if (index < GetSize()) {
+                MarkChanged(index);
+            }
+        }
+
+        void MarkChanged(uint32_t index) {
+            if (index / 64 >= _changedBits.size()) {
+                _changedBits.resize(index / 64 + 1, 0);
+            }
+
+            const uint64_t bit = uint64_t { 1 } << (index % 64);
+
+            if ((_changedBits[index / 64] & bit) == 0) {
+                _changedBits[index / 64] |= bit;
+                _changedIndices.push_back(index);
+            }
+        }
+
+        bool WasChanged(uint32_t index) const {
+            return index / 64 < _changedBits.size() && (_changedBits[index / 64] & (uint64_t { 1 } << (index % 64))) != 0;
+        }
+
+        // In the order they changed. After removals some may be past the end of the store, skip those.
+        const std::vector<uint32_t>& GetChangedIndices() const {
+            return _changedIndices;
+        }
+
+        void ClearChanges() {
+            for (uint32_t index : _changedIndices) {
+                _changedBits[index / 64] = 0;
+            }
+
+            _changedIndices.clear();
+        }
+
+        T* Find(Entity entity) {
+            const uint32_t index = IndexOf(entity);
+            return index != INVALID_INDEX ? &_components[index] : nullptr;
+        }
+
+        const T* Find(Entity entity) const {
+            const uint32_t index = IndexOf(entity);
+            return index != INVALID_INDEX ? &_components[index] : nullptr;
+        }
+
+        T* GetComponents() {
+            return _components.data();
+        }
+
+        const T* GetComponents() const {
+            return _components.data();
+        }
+
+    private:
+        std::vector<T> _components {};
+
+        std::vector<uint64_t> _changedBits {}; // by index
+        std::vector<uint32_t> _changedIndices {};
+    };
+
+} // namespace Engine
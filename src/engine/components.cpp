@@ -1,4 +1,7 @@
-#include "game_object.hpp"
+#include "components.hpp"
+
+// libs
+#include <glm/gtc/constants.hpp>
 
 namespace Engine {
 
@@ -74,15 +77,15 @@ namespace Engine {
         };
     }
 
-    GameObject GameObject::CreatePointLight(float intensity, float radius, glm::vec3 color) {
-        auto gameObject = GameObject::CreateGameObject();
-        
-        gameObject.Color = color;
-        gameObject.Transform.Scale.x = radius;
-        gameObject.PointLight = std::make_unique<PointLightComponent>();
-        gameObject.PointLight->LightIntensity = intensity;
+    TransformComponent TransformComponent::Interpolate(const TransformComponent& from, const TransformComponent& to, float alpha) {
+        const glm::vec3 rotationDelta = to.Rotation - from.Rotation;
+        const glm::vec3 shortRotationDelta = rotationDelta - glm::two_pi<float>() * glm::round(rotationDelta / glm::two_pi<float>());
 
-        return gameObject;
+        return TransformComponent {
+            glm::mix(from.Position, to.Position, alpha),
+            glm::mix(from.Scale, to.Scale, alpha),
+            from.Rotation + shortRotationDelta * alpha,
+        };
     }
 
 } // namespace Engine
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "model.hpp"
+#include "model_registry.hpp"
+
+// libs
+#include <glm/gtc/matrix_transform.hpp>
+
+// std
+#include <cstdint>
+#include <string>
+
+namespace Engine {
+
+    struct TransformComponent {
+        glm::vec3 Position {}; // translation offset
+        glm::vec3 Scale { 1.0f, 1.0f, 1.0f };
+        glm::vec3 Rotation {};
+
+        // Matrix corrsponds to Translate * Ry * Rx * Rz * Scale
+        // Rotations correspond to Tait-bryan angles of Y(1), X(2), Z(3)
+        // https://en.wikipedia.org/wiki/Euler_angles#Rotation_matrix
+        glm::mat4 GetMat4();
+        glm::mat4 GetMat4Slow();
+        glm::mat3 GetNormalMatrix();
+
+        // Blend between two states of the same transform, alpha 0 is from and 1 is to. Angles take the short way
+        // around, so one that wrapped from 2 pi to 0 does not spin back.
+        static TransformComponent Interpolate(const TransformComponent& from, const TransformComponent& to, float alpha);
+    };
+
+    struct PointLightComponent {
+        glm::vec3 Color { 1.0f };
+        float LightIntensity = 1.0f;
+        float Radius = 0.1f;
+    };
+
+    struct RenderableComponent {
+        ModelRegistry::Handle ModelHandle {}; // does not own a reference, whoever loaded the model keeps it alive
+        uint32_t Lod { 0 }; // LOD drawn last frame, for hysteresis
+    };
+
+    // Model loaded in the background by ModelStreamer, which also keeps the entity's RenderableComponent pointed at it.
+    struct StreamedModelComponent {
+        std::string Filepath;
+        Model::VertexFormat VertexFormat = Model::VertexFormat::Float;
+    };
+
+} // namespace Engine
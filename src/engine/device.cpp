@@ -57,6 +57,9 @@ Device::Device(Window &window) : window{window} {
 }
 
 Device::~Device() {
+  if (transferCommandPool != commandPool) {
+    vkDestroyCommandPool(device_, transferCommandPool, nullptr);
+  }
   vkDestroyCommandPool(device_, commandPool, nullptr);
   vkDestroyDevice(device_, nullptr);
 
@@ -138,6 +141,9 @@ void Device::createLogicalDevice() {
 
   std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
   std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily};
+  if (indices.hasDedicatedTransfer()) {
+    uniqueQueueFamilies.insert(indices.transferFamily);
+  }
 
   float queuePriority = 1.0f;
   for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -177,6 +183,14 @@ void Device::createLogicalDevice() {
 
   vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
   vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+
+  if (indices.hasDedicatedTransfer()) {
+    vkGetDeviceQueue(device_, indices.transferFamily, 0, &transferQueue_);
+    std::cout << "Transfer queue family: " << indices.transferFamily << std::endl;
+  } else {
+    transferQueue_ = graphicsQueue_;
+    std::cout << "Transfer queue family: none, uploads use the graphics queue" << std::endl;
+  }
 }
 
 void Device::createCommandPool() {
@@ -191,6 +205,15 @@ void Device::createCommandPool() {
   if (vkCreateCommandPool(device_, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
     throw std::runtime_error("failed to create command pool!");
   }
+
+  transferCommandPool = commandPool;
+  if (queueFamilyIndices.hasDedicatedTransfer()) {
+    poolInfo.queueFamilyIndex = queueFamilyIndices.transferFamily;
+
+    if (vkCreateCommandPool(device_, &poolInfo, nullptr, &transferCommandPool) != VK_SUCCESS) {
+      throw std::runtime_error("failed to create transfer command pool!");
+    }
+  }
 }
 
 void Device::createSurface() { window.CreateWindowSurface(instance, &surface_); }
@@ -345,6 +368,25 @@ QueueFamilyIndices Device::findQueueFamilies(VkPhysicalDevice device) {
     i++;
   }
 
+  // Prefer a transfer only family (usually the copy engine), otherwise any family without graphics,
+  // compute families can copy as well.
+  indices.transferFamily = indices.graphicsFamily;
+  for (uint32_t j = 0; j < queueFamilyCount; j++) {
+    VkQueueFlags flags = queueFamilies[j].queueFlags;
+    if (queueFamilies[j].queueCount == 0 || (flags & VK_QUEUE_GRAPHICS_BIT) ||
+        !(flags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT))) {
+      continue;
+    }
+    bool transferOnly = !(flags & VK_QUEUE_COMPUTE_BIT);
+    if (!indices.transferFamilyHasValue || transferOnly) {
+      indices.transferFamily = j;
+      indices.transferFamilyHasValue = true;
+    }
+    if (transferOnly) {
+      break;
+    }
+  }
+
   return indices;
 }
 
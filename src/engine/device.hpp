@@ -17,9 +17,12 @@ struct SwapChainSupportDetails {
 struct QueueFamilyIndices {
   uint32_t graphicsFamily;
   uint32_t presentFamily;
+  uint32_t transferFamily;  // same as graphicsFamily without a dedicated transfer family
   bool graphicsFamilyHasValue = false;
   bool presentFamilyHasValue = false;
+  bool transferFamilyHasValue = false;  // a family without graphics that can copy, optional
   bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
+  bool hasDedicatedTransfer() { return transferFamilyHasValue; }
 };
 
 class Device {
@@ -45,6 +48,11 @@ class Device {
   VkQueue graphicsQueue() { return graphicsQueue_; }
   VkQueue presentQueue() { return presentQueue_; }
 
+  // Fall back to the graphics queue and commandPool when there is no dedicated transfer family.
+  VkCommandPool getTransferCommandPool() { return transferCommandPool; }
+  VkQueue transferQueue() { return transferQueue_; }
+  bool hasDedicatedTransferQueue() { return transferQueue_ != graphicsQueue_; }
+
   SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice); }
   uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
   QueueFamilyIndices findPhysicalQueueFamilies() { return findQueueFamilies(physicalDevice); }
@@ -95,11 +103,13 @@ class Device {
   VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
   Window &window;
   VkCommandPool commandPool;
+  VkCommandPool transferCommandPool;
 
   VkDevice device_;
   VkSurfaceKHR surface_;
   VkQueue graphicsQueue_;
   VkQueue presentQueue_;
+  VkQueue transferQueue_;
 
   const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
   const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
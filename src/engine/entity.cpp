@@ -0,0 +1,106 @@
+#include "entity.hpp"
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+namespace Engine {
+
+    EntityAllocator::~EntityAllocator() {
+        for (auto& block : _generationBlocks) {
+            delete[] block.load();
+        }
+    }
+
+    Entity EntityAllocator::Create() {
+        const uint32_t freeSlot = _freeCursor.fetch_add(1, std::memory_order_relaxed);
+
+        if (freeSlot < _freeIndices.size()) {
+            const uint32_t index = _freeIndices[freeSlot];
+            return Entity { index, GetBlock(index)[index % BLOCK_SIZE] };
+        }
+
+        const uint32_t index = _nextIndex.fetch_add(1, std::memory_order_relaxed);
+
+        if (index >= BLOCK_SIZE * MAX_BLOCKS) {
+            throw std::runtime_error("Out of entities");
+        }
+
+        return Entity { index, GetBlock(index)[index % BLOCK_SIZE] };
+    }
+
+    // Same as count single creates, but one atomic add for the free indices and one for the fresh ones.
+    void EntityAllocator::Create(uint32_t count, Entity* entities) {
+        const uint32_t firstFreeSlot = _freeCursor.fetch_add(count, std::memory_order_relaxed);
+        const uint32_t freeCount = static_cast<uint32_t>(_freeIndices.size());
+
+        uint32_t created = 0;
+
+        for (; created < count && firstFreeSlot < freeCount && created < freeCount - firstFreeSlot; created++) {
+            const uint32_t index = _freeIndices[firstFreeSlot + created];
+            entities[created] = Entity { index, GetBlock(index)[index % BLOCK_SIZE] };
+        }
+
+        if (created == count) {
+            return;
+        }
+
+        const uint32_t firstIndex = _nextIndex.fetch_add(count - created, std::memory_order_relaxed);
+
+        if (static_cast<uint64_t>(firstIndex) + (count - created) > static_cast<uint64_t>(BLOCK_SIZE) * MAX_BLOCKS) {
+            throw std::runtime_error("Out of entities");
+        }
+
+        for (uint32_t index = firstIndex; created < count; created++, index++) {
+            entities[created] = Entity { index, GetBlock(index)[index % BLOCK_SIZE] };
+        }
+    }
+
+    void EntityAllocator::Destroy(Entity entity) {
+        if (!IsAlive(entity)) {
+            return;
+        }
+
+        // Nobody is creating right now, so the taken part of the free list can go.
+        const uint32_t taken = std::min(_freeCursor.exchange(0), static_cast<uint32_t>(_freeIndices.size()));
+        _freeIndices.erase(_freeIndices.begin(), _freeIndices.begin() + taken);
+
+        GetBlock(entity.Index)[entity.Index % BLOCK_SIZE]++;
+        _freeIndices.push_back(entity.Index);
+    }
+
+    bool EntityAllocator::IsAlive(Entity entity) const {
+        if (entity.Index >= _nextIndex.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        const uint32_t* block = _generationBlocks[entity.Index / BLOCK_SIZE].load(std::memory_order_acquire);
+
+        return block != nullptr && block[entity.Index % BLOCK_SIZE] == entity.Generation;
+    }
+
+    uint32_t EntityAllocator::GetAliveCount() const {
+        const uint32_t taken = std::min(_freeCursor.load(), static_cast<uint32_t>(_freeIndices.size()));
+        return _nextIndex.load() - static_cast<uint32_t>(_freeIndices.size()) + taken;
+    }
+
+    // Blocks are allocated the first time an index in them is handed out, the loser of a race frees its copy.
+    uint32_t* EntityAllocator::GetBlock(uint32_t index) {
+        std::atomic<uint32_t*>& slot = _generationBlocks[index / BLOCK_SIZE];
+        uint32_t* block = slot.load(std::memory_order_acquire);
+
+        if (block == nullptr) {
+            uint32_t* newBlock = new uint32_t[BLOCK_SIZE] {};
+
+            if (slot.compare_exchange_strong(block, newBlock, std::memory_order_acq_rel)) {
+                block = newBlock;
+            }
+            else {
+                delete[] newBlock;
+            }
+        }
+
+        return block;
+    }
+
+} // namespace Engine
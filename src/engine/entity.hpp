@@ -0,0 +1,67 @@
+#pragma once
+
+// std
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+
+    // Index plus the generation of the slot when the entity was created. Destroying an entity bumps the generation,
+    // so a handle to a destroyed entity never matches whatever reuses its index later.
+    struct Entity {
+        uint32_t Index { UINT32_MAX };
+        uint32_t Generation { 0 };
+
+        bool IsValid() const {
+            return Index != UINT32_MAX;
+        }
+
+        bool operator==(const Entity& other) const {
+            return Index == other.Index && Generation == other.Generation;
+        }
+
+        bool operator!=(const Entity& other) const {
+            return !(*this == other);
+        }
+    };
+
+    constexpr Entity INVALID_ENTITY {};
+
+    // Hands out entity handles, reusing destroyed indices. Create is lock free and safe from any thread, Destroy belongs
+    // to the thread that owns the scene and must not run while other threads create. Generations live in fixed size
+    // blocks that never move, so growing never invalidates what another thread is reading.
+    class EntityAllocator {
+
+    public:
+        static constexpr uint32_t BLOCK_SIZE = 4096;
+        static constexpr uint32_t MAX_BLOCKS = 4096; // 16M live entities
+
+        EntityAllocator() = default;
+        ~EntityAllocator();
+
+        EntityAllocator(const EntityAllocator&) = delete;
+        EntityAllocator& operator=(const EntityAllocator&) = delete;
+
+        Entity Create();
+        void Create(uint32_t count, Entity* entities);
+        void Destroy(Entity entity);
+
+        bool IsAlive(Entity entity) const;
+
+        uint32_t GetAliveCount() const;
+
+    private:
+        uint32_t* GetBlock(uint32_t index);
+
+    private:
+        std::array<std::atomic<uint32_t*>, MAX_BLOCKS> _generationBlocks {};
+        std::atomic<uint32_t> _nextIndex { 0 };
+
+        // Destroyed indices, Create takes them from the front by bumping _freeCursor. Destroy drops the taken ones.
+        std::vector<uint32_t> _freeIndices {};
+        std::atomic<uint32_t> _freeCursor { 0 };
+    };
+
+} // namespace Engine
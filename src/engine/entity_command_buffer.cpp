@@ -0,0 +1,205 @@
+#include "entity_command_buffer.hpp"
+
+namespace Engine {
+
+    EntityCommandBuffer::EntityCommandBuffer(Scene& scene, JobSystem& jobSystem) : _scene { scene }, _jobSystem { jobSystem } {
+        for (uint32_t i = 0; i < _jobSystem.GetThreadCount() + 1; i++) {
+            _threadCommands.push_back(std::make_unique<ThreadCommands>());
+        }
+    }
+
+    Entity EntityCommandBuffer::CreateEntity(const TransformComponent& transform, Entity parent) {
+        const Entity entity = _scene.ReserveEntity();
+
+        std::unique_lock<std::mutex> lock {};
+        LockThreadCommands(lock)->Creates.push_back({ entity, parent, transform });
+
+        return entity;
+    }
+
+    void EntityCommandBuffer::CreateEntities(uint32_t count, const TransformComponent* transforms, Entity* entities) {
+        _scene.ReserveEntities(count, entities);
+
+        std::unique_lock<std::mutex> lock {};
+        std::vector<CreateCommand>& creates = LockThreadCommands(lock)->Creates;
+
+        creates.reserve(creates.size() + count);
+
+        for (uint32_t i = 0; i < count; i++) {
+            creates.push_back({ entities[i], INVALID_ENTITY, transforms[i] });
+        }
+    }
+
+    void EntityCommandBuffer::DestroyEntity(Entity entity) {
+        std::unique_lock<std::mutex> lock {};
+        LockThreadCommands(lock)->Destroys.push_back(entity);
+    }
+
+    void EntityCommandBuffer::AddRenderable(Entity entity, const RenderableComponent& renderable) {
+        std::unique_lock<std::mutex> lock {};
+        ComponentCommands<RenderableComponent>& commands = LockThreadCommands(lock)->Renderables;
+
+        commands.AddedEntities.push_back(entity);
+        commands.Added.push_back(renderable);
+    }
+
+    void EntityCommandBuffer::AddPointLight(Entity entity, const PointLightComponent& pointLight) {
+        std::unique_lock<std::mutex> lock {};
+        ComponentCommands<PointLightComponent>& commands = LockThreadCommands(lock)->PointLights;
+
+        commands.AddedEntities.push_back(entity);
+        commands.Added.push_back(pointLight);
+    }
+
+    void EntityCommandBuffer::AddStreamedModel(Entity entity, const StreamedModelComponent& streamedModel) {
+        std::unique_lock<std::mutex> lock {};
+        ComponentCommands<StreamedModelComponent>& commands = LockThreadCommands(lock)->StreamedModels;
+
+        commands.AddedEntities.push_back(entity);
+        commands.Added.push_back(streamedModel);
+    }
+
+    void EntityCommandBuffer::RemoveRenderable(Entity entity) {
+        std::unique_lock<std::mutex> lock {};
+        LockThreadCommands(lock)->Renderables.Removed.push_back(entity);
+    }
+
+    void EntityCommandBuffer::RemovePointLight(Entity entity) {
+        std::unique_lock<std::mutex> lock {};
+        LockThreadCommands(lock)->PointLights.Removed.push_back(entity);
+    }
+
+    void EntityCommandBuffer::RemoveStreamedModel(Entity entity) {
+        std::unique_lock<std::mutex> lock {};
+        LockThreadCommands(lock)->StreamedModels.Removed.push_back(entity);
+    }
+
+    EntityCommandBuffer::Stats EntityCommandBuffer::Playback() {
+        Stats stats {};
+
+        // Creates from every thread as one bulk add, parents after that since they may be in the batch themselves.
+        for (const std::unique_ptr<ThreadCommands>& thread : _threadCommands) {
+            stats.CreatedCount += static_cast<uint32_t>(thread->Creates.size());
+        }
+
+        if (stats.CreatedCount > 0) {
+            std::vector<Entity> entities {};
+            std::vector<glm::vec3> positions {};
+            std::vector<glm::vec3> rotations {};
+            std::vector<glm::vec3> scales {};
+
+            entities.reserve(stats.CreatedCount);
+            positions.reserve(stats.CreatedCount);
+            rotations.reserve(stats.CreatedCount);
+            scales.reserve(stats.CreatedCount);
+
+            for (const std::unique_ptr<ThreadCommands>& thread : _threadCommands) {
+                for (const CreateCommand& create : thread->Creates) {
+                    entities.push_back(create.CreatedEntity);
+                    positions.push_back(create.Transform.Position);
+                    rotations.push_back(create.Transform.Rotation);
+                    scales.push_back(create.Transform.Scale);
+                }
+            }
+
+            const std::vector<uint32_t> parentIndices(stats.CreatedCount, SparseSet::INVALID_INDEX);
+
+            _scene.Transforms.AddRange(entities.data(), stats.CreatedCount, positions.data(), rotations.data(), scales.data(), parentIndices.data());
+
+            for (const std::unique_ptr<ThreadCommands>& thread : _threadCommands) {
+                for (const CreateCommand& create : thread->Creates) {
+                    if (create.Parent.IsValid() && _scene.IsAlive(create.Parent)) {
+                        _scene.Transforms.SetParent(create.CreatedEntity, create.Parent);
+                    }
+                }
+
+                thread->Creates.clear();
+            }
+        }
+
+        PlaybackRemovals(&ThreadCommands::Renderables, _scene.Renderables, stats);
+        PlaybackRemovals(&ThreadCommands::PointLights, _scene.PointLights, stats);
+        PlaybackRemovals(&ThreadCommands::StreamedModels, _scene.StreamedModels, stats);
+
+        PlaybackAdds(&ThreadCommands::Renderables, _scene.Renderables, stats);
+        PlaybackAdds(&ThreadCommands::PointLights, _scene.PointLights, stats);
+        PlaybackAdds(&ThreadCommands::StreamedModels, _scene.StreamedModels, stats);
+
+        for (const std::unique_ptr<ThreadCommands>& thread : _threadCommands) {
+            for (Entity entity : thread->Destroys) {
+                if (_scene.IsAlive(entity)) {
+                    _scene.DestroyEntity(entity);
+                    stats.DestroyedCount++;
+                }
+            }
+
+            thread->Destroys.clear();
+        }
+
+        return stats;
+    }
+
+    EntityCommandBuffer::ThreadCommands* EntityCommandBuffer::LockThreadCommands(std::unique_lock<std::mutex>& lock) {
+        const uint32_t thread = _jobSystem.GetThreadIndex();
+
+        if (thread != JobSystem::INVALID_THREAD) {
+            return _threadCommands[thread].get();
+        }
+
+        lock = std::unique_lock<std::mutex> { _sharedMutex };
+        return _threadCommands.back().get();
+    }
+
+    template<typename T>
+    void EntityCommandBuffer::PlaybackRemovals(ComponentCommands<T> ThreadCommands::*commands, ComponentStore<T>& store, Stats& stats) {
+        for (const std::unique_ptr<ThreadCommands>& thread : _threadCommands) {
+            std::vector<Entity>& removed = ((*thread).*commands).Removed;
+
+            for (Entity entity : removed) {
+                if (store.Contains(entity)) {
+                    store.Remove(entity);
+                    stats.RemovedCount++;
+                }
+            }
+
+            removed.clear();
+        }
+    }
+
+    template<typename T>
+    void EntityCommandBuffer::PlaybackAdds(ComponentCommands<T> ThreadCommands::*commands, ComponentStore<T>& store, Stats& stats) {
+        uint32_t addedCount = 0;
+
+        for (const std::unique_ptr<ThreadCommands>& thread : _threadCommands) {
+            addedCount += static_cast<uint32_t>(((*thread).*commands).Added.size());
+        }
+
+        store.Reserve(store.GetSize() + addedCount);
+
+        for (const std::unique_ptr<ThreadCommands>& thread : _threadCommands) {
+            ComponentCommands<T>& threadCommands = (*thread).*commands;
+
+            for (size_t i = 0; i < threadCommands.Added.size(); i++) {
+                const Entity entity = threadCommands.AddedEntities[i];
+
+                if (!_scene.IsAlive(entity)) {
+                    continue;
+                }
+
+                if (T* component = store.Find(entity)) {
+                    *component = std::move(threadCommands.Added[i]);
+                    store.MarkChanged(store.IndexOf(entity));
+                }
+                else {
+                    store.Add(entity, std::move(threadCommands.Added[i]));
+                }
+
+                stats.AddedCount++;
+            }
+
+            threadCommands.AddedEntities.clear();
+            threadCommands.Added.clear();
+        }
+    }
+
+} // namespace Engine
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "components.hpp"
+#include "entity.hpp"
+#include "job_system.hpp"
+#include "scene.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Engine {
+
+    // Structural changes to the scene recorded from any thread and applied in one go by Playback, so jobs can spawn and
+    // destroy entities while systems are iterating the stores. Every job system thread records into its own buffer
+    // without locking, threads that are not the job system's share one behind a mutex.
+    //
+    // Playback does not follow the recording order, it goes by kind: creates, component removals, component adds,
+    // destroys. Anything can be done to an entity created in the same batch, and destroying it wins over the rest.
+    // Commands on entities that are gone by then are dropped.
+    class EntityCommandBuffer {
+
+    public:
+        struct Stats {
+            uint32_t CreatedCount { 0 };
+            uint32_t DestroyedCount { 0 };
+            uint32_t AddedCount { 0 };   // components, replaced ones included
+            uint32_t RemovedCount { 0 };
+        };
+
+        EntityCommandBuffer(Scene& scene, JobSystem& jobSystem);
+
+        EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+        EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+
+        // Any thread. The handle can go into other commands right away, the entity exists after Playback.
+        Entity CreateEntity(const TransformComponent& transform = {}, Entity parent = INVALID_ENTITY);
+
+        // Any thread, count entities with one allocation of handles.
+        void CreateEntities(uint32_t count, const TransformComponent* transforms, Entity* entities);
+
+        void DestroyEntity(Entity entity);
+
+        // Adding a component the entity already has replaces it.
+        void AddRenderable(Entity entity, const RenderableComponent& renderable);
+        void AddPointLight(Entity entity, const PointLightComponent& pointLight);
+        void AddStreamedModel(Entity entity, const StreamedModelComponent& streamedModel);
+
+        void RemoveRenderable(Entity entity);
+        void RemovePointLight(Entity entity);
+        void RemoveStreamedModel(Entity entity);
+
+        // Owning thread, at a point where nothing reads the scene or records commands, between frames. The buffers
+        // keep their memory, a steady stream of commands does not allocate once they have grown.
+        Stats Playback();
+
+    private:
+        struct CreateCommand {
+            Entity CreatedEntity;
+            Entity Parent;
+            TransformComponent Transform;
+        };
+
+        template<typename T>
+        struct ComponentCommands {
+            std::vector<Entity> AddedEntities {};
+            std::vector<T> Added {};
+            std::vector<Entity> Removed {};
+        };
+
+        // Own cache lines, threads record next to each other.
+        struct alignas(64) ThreadCommands {
+            std::vector<CreateCommand> Creates {};
+            std::vector<Entity> Destroys {};
+            ComponentCommands<RenderableComponent> Renderables {};
+            ComponentCommands<PointLightComponent> PointLights {};
+            ComponentCommands<StreamedModelComponent> StreamedModels {};
+        };
+
+        ThreadCommands* LockThreadCommands(std::unique_lock<std::mutex>& lock);
+
+        template<typename T>
+        void PlaybackRemovals(ComponentCommands<T> ThreadCommands::*commands, ComponentStore<T>& store, Stats& stats);
+
+        template<typename T>
+        void PlaybackAdds(ComponentCommands<T> ThreadCommands::*commands, ComponentStore<T>& store, Stats& stats);
+
+    private:
+        Scene& _scene;
+        JobSystem& _jobSystem;
+
+        std::vector<std::unique_ptr<ThreadCommands>> _threadCommands {}; // by job system thread, the last one is shared
+        std::mutex _sharedMutex {};
+    };
+
+} // namespace Engine
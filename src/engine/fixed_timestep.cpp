@@ -0,0 +1,29 @@
+#include "fixed_timestep.hpp"
+
+// std
+#include <cassert>
+
+namespace Engine {
+
+    FixedTimestep::FixedTimestep(float stepSeconds, uint32_t maxStepsPerFrame) : _step { stepSeconds }, _maxStepsPerFrame { maxStepsPerFrame } {
+        assert(stepSeconds > 0.0f && maxStepsPerFrame > 0 && "FixedTimestep needs a positive step");
+    }
+
+    uint32_t FixedTimestep::Advance(float deltaTime) {
+        _accumulator += deltaTime;
+
+        uint32_t stepCount = 0;
+
+        while (_accumulator >= _step && stepCount < _maxStepsPerFrame) {
+            _accumulator -= _step;
+            stepCount++;
+        }
+
+        if (_accumulator >= _step) {
+            _accumulator = 0.0f;
+        }
+
+        return stepCount;
+    }
+
+} // namespace Engine
@@ -0,0 +1,35 @@
+#pragma once
+
+// std
+#include <cstdint>
+
+namespace Engine {
+
+    // Turns frame times into a whole number of fixed simulation steps. What is left over carries to the next frame and
+    // is how far rendering should interpolate past the last step.
+    class FixedTimestep {
+
+    public:
+        // A frame that owes more than maxStepsPerFrame steps drops the rest, the simulation slows down instead of
+        // spending the next frame catching up.
+        FixedTimestep(float stepSeconds, uint32_t maxStepsPerFrame);
+
+        // Steps to run for a frame that took deltaTime seconds.
+        uint32_t Advance(float deltaTime);
+
+        float GetStep() const {
+            return _step;
+        }
+
+        // 0 right on the last step, towards 1 as the next one comes due.
+        float GetAlpha() const {
+            return _accumulator / _step;
+        }
+
+    private:
+        float _step;
+        uint32_t _maxStepsPerFrame;
+        float _accumulator { 0.0f };
+    };
+
+} // namespace Engine
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "camera.hpp"
-#include "game_object.hpp"
+#include "scene.hpp"
 
 // lib
 #include <vulkan/vulkan.h>
@@ -34,7 +34,7 @@ namespace Engine {
         VkCommandBuffer CommandBuffer;
         Camera& Camera;
         VkDescriptorSet GlobalDescriptorSet;
-        GameObject::Map& GameObjectByID;
+        Scene& CurrentScene;
     };
     
 } // namespace Engine
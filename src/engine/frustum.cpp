@@ -0,0 +1,48 @@
+#include "frustum.hpp"
+
+namespace Engine {
+
+    Frustum Frustum::FromMatrix(const glm::mat4& clipMatrix) {
+        auto row = [&clipMatrix](int i) {
+            return glm::vec4 { clipMatrix[0][i], clipMatrix[1][i], clipMatrix[2][i], clipMatrix[3][i] };
+        };
+
+        Frustum frustum {};
+        frustum._planes[0] = row(3) + row(0); // left
+        frustum._planes[1] = row(3) - row(0); // right
+        frustum._planes[2] = row(3) + row(1); // top (vulkan clip space has +y down)
+        frustum._planes[3] = row(3) - row(1); // bottom
+        frustum._planes[4] = row(2);          // near, depth is [0, 1] (GLM_FORCE_DEPTH_ZERO_TO_ONE)
+        frustum._planes[5] = row(3) - row(2); // far
+
+        for (glm::vec4& plane : frustum._planes) {
+            plane /= glm::length(glm::vec3 { plane });
+        }
+
+        return frustum;
+    }
+
+    bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const {
+        for (const glm::vec4& plane : _planes) {
+            if (glm::dot(glm::vec3 { plane }, center) + plane.w < -radius) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool Frustum::IntersectsBox(const glm::vec3& min, const glm::vec3& max) const {
+        for (const glm::vec4& plane : _planes) {
+            // Corner furthest along the plane normal, if even that one is behind the plane the whole box is.
+            const glm::vec3 corner { plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z };
+
+            if (glm::dot(glm::vec3 { plane }, corner) + plane.w < 0.0f) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+} // namespace Engine
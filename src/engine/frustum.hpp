@@ -0,0 +1,26 @@
+#pragma once
+
+// libs
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+namespace Engine {
+
+    // Six inward facing planes extracted from a clip matrix (Gribb & Hartmann). Built from
+    // Projection * View * Model the planes live in model space, so model space bounds can be tested directly.
+    class Frustum {
+
+    public:
+        static Frustum FromMatrix(const glm::mat4& clipMatrix);
+
+        bool IntersectsSphere(const glm::vec3& center, float radius) const;
+
+        // Conservative like the sphere test, a box outside near a corner still counts as intersecting.
+        bool IntersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+
+    private:
+        glm::vec4 _planes[6] {}; // xyz normal, w distance, normalized
+    };
+
+} // namespace Engine
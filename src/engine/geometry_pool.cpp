@@ -0,0 +1,309 @@
+#include "geometry_pool.hpp"
+
+#include "swap_chain.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <stdexcept>
+
+namespace Engine {
+
+    GeometryPool::GeometryPool(Device& device, UploadManager& uploadManager)
+        : _device(device), _uploadManager(uploadManager)
+    {
+    }
+
+    GeometryPool::~GeometryPool() {
+        // Copies into the arenas may still be recorded or in flight.
+        _uploadManager.Wait(_uploadManager.Flush());
+    }
+
+    GeometryPool::Allocation GeometryPool::Allocate(const void* vertices, uint32_t vertexSize, uint32_t vertexCount, const void* indices, VkIndexType indexType,
+                                                    uint32_t indexCount) {
+        const uint32_t indexSize = indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+        Region region {};
+        region.VertexArena = GetArena(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertexSize);
+        region.VertexOffset = AllocateRange(region.VertexArena, vertexCount);
+        region.VertexCount = vertexCount;
+        region.IndexArena = indexCount > 0 ? GetArena(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indexSize) : NO_ARENA;
+        region.FirstIndex = indexCount > 0 ? AllocateRange(region.IndexArena, indexCount) : 0;
+        region.IndexCount = indexCount;
+        region.InUse = true;
+
+        Allocation allocation = static_cast<Allocation>(_regions.size());
+
+        if (!_freeAllocations.empty()) {
+            allocation = _freeAllocations.back();
+            _freeAllocations.pop_back();
+            _regions[allocation] = region;
+        }
+        else {
+            _regions.push_back(region);
+        }
+
+        if (vertexCount > 0) {
+            _uploadManager.Upload(_arenas[region.VertexArena].Buffer->getBuffer(), static_cast<VkDeviceSize>(region.VertexOffset) * vertexSize,
+                                  vertices, static_cast<VkDeviceSize>(vertexSize) * vertexCount);
+        }
+
+        if (indexCount > 0) {
+            _uploadManager.Upload(_arenas[region.IndexArena].Buffer->getBuffer(), static_cast<VkDeviceSize>(region.FirstIndex) * indexSize,
+                                  indices, static_cast<VkDeviceSize>(indexSize) * indexCount);
+        }
+
+        return allocation;
+    }
+
+    void GeometryPool::Free(Allocation allocation) {
+        Region& region = _regions[allocation];
+
+        assert(region.InUse && "Geometry pool allocation freed twice.");
+
+        FreeRange(region.VertexArena, region.VertexOffset, region.VertexCount);
+
+        if (region.IndexArena != NO_ARENA) {
+            FreeRange(region.IndexArena, region.FirstIndex, region.IndexCount);
+        }
+
+        region.InUse = false;
+        _freeAllocations.push_back(allocation);
+    }
+
+    void GeometryPool::Compact() {
+        for (uint32_t i = 0; i < _arenas.size(); i++) {
+            const Arena& arena = _arenas[i];
+
+            if (arena.Buffer == nullptr) {
+                continue;
+            }
+
+            // Halve while the data would still fill at most half of the buffer.
+            uint32_t capacity = arena.Capacity;
+
+            while (capacity / 2 >= GetMinCapacity(arena) && capacity / 2 >= static_cast<uint64_t>(arena.UsedCount) * 2) {
+                capacity /= 2;
+            }
+
+            if (capacity != arena.Capacity || GetHoleCount(arena) > arena.Capacity * MAX_HOLE_RATIO) {
+                Rebuild(i, capacity);
+            }
+        }
+    }
+
+    void GeometryPool::Update() {
+        _frame++;
+
+        _retiredBuffers.erase(std::remove_if(_retiredBuffers.begin(), _retiredBuffers.end(), [this](const RetiredBuffer& retired) {
+            return retired.ReleaseFrame <= _frame && _uploadManager.IsComplete(retired.CopyTicket);
+        }), _retiredBuffers.end());
+    }
+
+    void GeometryPool::Bind(VkCommandBuffer commandBuffer, Allocation allocation) {
+        const Region& region = _regions[allocation];
+
+        VkBuffer buffers[] = { _arenas[region.VertexArena].Buffer->getBuffer() };
+        VkDeviceSize offsets[] = { 0 };
+
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+
+        if (region.IndexArena != NO_ARENA) {
+            const Arena& arena = _arenas[region.IndexArena];
+            vkCmdBindIndexBuffer(commandBuffer, arena.Buffer->getBuffer(), 0, arena.ElementSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+        }
+    }
+
+    GeometryPool::Stats GeometryPool::GetStats() const {
+        Stats stats {};
+        stats.AllocationCount = static_cast<uint32_t>(_regions.size() - _freeAllocations.size());
+        stats.RebuildCount = _rebuildCount;
+        stats.RetiredBufferCount = static_cast<uint32_t>(_retiredBuffers.size());
+
+        for (const auto& arena : _arenas) {
+            if (arena.Buffer == nullptr) {
+                continue;
+            }
+
+            stats.BufferCount++;
+            stats.CapacityBytes += static_cast<VkDeviceSize>(arena.Capacity) * arena.ElementSize;
+            stats.UsedBytes += static_cast<VkDeviceSize>(arena.UsedCount) * arena.ElementSize;
+        }
+
+        return stats;
+    }
+
+    uint32_t GeometryPool::GetArena(VkBufferUsageFlags usage, uint32_t elementSize) {
+        for (uint32_t i = 0; i < _arenas.size(); i++) {
+            if (_arenas[i].Usage == usage && _arenas[i].ElementSize == elementSize) {
+                return i;
+            }
+        }
+
+        Arena arena {};
+        arena.Usage = usage;
+        arena.ElementSize = elementSize;
+
+        _arenas.push_back(std::move(arena));
+
+        return static_cast<uint32_t>(_arenas.size() - 1);
+    }
+
+    // Best fit, when nothing fits the arena is compacted or grown into a new buffer first.
+    uint32_t GeometryPool::AllocateRange(uint32_t arenaIndex, uint32_t count) {
+        if (count == 0) {
+            return 0;
+        }
+
+        Arena& arena = _arenas[arenaIndex];
+        auto best = arena.FreeRanges.end();
+
+        for (auto it = arena.FreeRanges.begin(); it != arena.FreeRanges.end(); it++) {
+            if (it->second >= count && (best == arena.FreeRanges.end() || it->second < best->second)) {
+                best = it;
+            }
+        }
+
+        if (best == arena.FreeRanges.end()) {
+            uint64_t capacity = std::max(arena.Capacity, GetMinCapacity(arena));
+
+            while (capacity - arena.UsedCount < count) {
+                capacity *= 2;
+            }
+
+            if (capacity > UINT32_MAX) {
+                throw std::runtime_error("Geometry pool arena is out of addressable elements");
+            }
+
+            Rebuild(arenaIndex, static_cast<uint32_t>(capacity));
+            best = arena.FreeRanges.begin(); // everything free is one range at the end now
+        }
+
+        const uint32_t offset = best->first;
+        const uint32_t remaining = best->second - count;
+
+        arena.FreeRanges.erase(best);
+
+        if (remaining > 0) {
+            arena.FreeRanges[offset + count] = remaining;
+        }
+
+        arena.UsedCount += count;
+
+        return offset;
+    }
+
+    void GeometryPool::FreeRange(uint32_t arenaIndex, uint32_t offset, uint32_t count) {
+        if (count == 0) {
+            return;
+        }
+
+        Arena& arena = _arenas[arenaIndex];
+        arena.UsedCount -= count;
+
+        auto next = arena.FreeRanges.lower_bound(offset);
+
+        if (next != arena.FreeRanges.end() && offset + count == next->first) {
+            count += next->second;
+            next = arena.FreeRanges.erase(next);
+        }
+
+        if (next != arena.FreeRanges.begin()) {
+            auto previous = std::prev(next);
+
+            if (previous->first + previous->second == offset) {
+                previous->second += count;
+                return;
+            }
+        }
+
+        arena.FreeRanges[offset] = count;
+    }
+
+    // Copies every live range of the arena, in order and without gaps, into a new buffer of the given capacity.
+    void GeometryPool::Rebuild(uint32_t arenaIndex, uint32_t capacity) {
+        Arena& arena = _arenas[arenaIndex];
+
+        auto buffer = std::make_unique<VulkanBuffer> (
+            _device,
+            arena.ElementSize,
+            capacity,
+            arena.Usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+        );
+
+        std::vector<std::pair<uint32_t*, uint32_t>> ranges {}; // offset to patch, count
+
+        for (auto& region : _regions) {
+            if (!region.InUse) {
+                continue;
+            }
+
+            if (region.VertexArena == arenaIndex && region.VertexCount > 0) {
+                ranges.push_back({ &region.VertexOffset, region.VertexCount });
+            }
+
+            if (region.IndexArena == arenaIndex && region.IndexCount > 0) {
+                ranges.push_back({ &region.FirstIndex, region.IndexCount });
+            }
+        }
+
+        std::sort(ranges.begin(), ranges.end(), [](const auto& a, const auto& b) { return *a.first < *b.first; });
+
+        std::vector<VkBufferCopy> copyRegions {};
+        uint32_t packedOffset = 0;
+
+        for (auto& [offset, count] : ranges) {
+            copyRegions.push_back({
+                static_cast<VkDeviceSize>(*offset) * arena.ElementSize,
+                static_cast<VkDeviceSize>(packedOffset) * arena.ElementSize,
+                static_cast<VkDeviceSize>(count) * arena.ElementSize
+            });
+
+            *offset = packedOffset;
+            packedOffset += count;
+        }
+
+        assert(packedOffset == arena.UsedCount && "Geometry pool arena lost track of its allocations.");
+
+        if (arena.Buffer != nullptr) {
+            // The copy goes after the uploads still recorded against the old buffer. Frames in flight may draw from it,
+            // and the copy reads it, so it is destroyed later.
+            const UploadManager::Ticket ticket = copyRegions.empty() ? _uploadManager.Flush()
+                                                                     : _uploadManager.Copy(arena.Buffer->getBuffer(), buffer->getBuffer(), copyRegions);
+
+            _retiredBuffers.push_back({ std::move(arena.Buffer), _frame + SwapChain::MAX_FRAMES_IN_FLIGHT, ticket });
+        }
+
+        arena.Buffer = std::move(buffer);
+        arena.Capacity = capacity;
+        arena.FreeRanges.clear();
+
+        if (capacity > packedOffset) {
+            arena.FreeRanges[packedOffset] = capacity - packedOffset;
+        }
+
+        _rebuildCount++;
+    }
+
+    // Free elements that are not part of the range at the end.
+    uint32_t GeometryPool::GetHoleCount(const Arena& arena) const {
+        uint32_t holeCount = arena.Capacity - arena.UsedCount;
+
+        if (!arena.FreeRanges.empty()) {
+            const auto& last = *arena.FreeRanges.rbegin();
+
+            if (last.first + last.second == arena.Capacity) {
+                holeCount -= last.second;
+            }
+        }
+
+        return holeCount;
+    }
+
+    uint32_t GeometryPool::GetMinCapacity(const Arena& arena) const {
+        return static_cast<uint32_t>(std::max<VkDeviceSize>(MIN_ARENA_SIZE / arena.ElementSize, 1));
+    }
+
+} // namespace Engine
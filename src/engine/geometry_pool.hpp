@@ -0,0 +1,117 @@
+#pragma once
+
+#include "device.hpp"
+#include "upload_manager.hpp"
+#include "vulkan_buffer.hpp"
+
+// std
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace Engine {
+
+    // Suballocates vertex and index data of every model from a few large device local buffers, one arena per
+    // vertex stride and index type. Models draw with firstIndex/vertexOffset, so objects sharing an arena share one bind.
+    // Allocate and Compact may move data to a new buffer, never call them while recording a command buffer that binds the pool.
+    // The move is a copy on the upload manager, the old buffer stays alive until no frame in flight can draw from it.
+    class GeometryPool {
+
+    public:
+        using Allocation = uint32_t;
+
+        static constexpr Allocation INVALID_ALLOCATION = UINT32_MAX;
+        static constexpr VkDeviceSize MIN_ARENA_SIZE = 16 * 1024 * 1024; // the first buffer of an arena, it doubles when full
+        static constexpr float MAX_HOLE_RATIO = 0.25f; // Compact leaves an arena alone until holes take this much of it
+
+        // Where an allocation currently lives, offsets are in elements and change when its arena is compacted.
+        struct Region {
+            uint32_t VertexArena;
+            uint32_t VertexOffset;
+            uint32_t VertexCount;
+
+            uint32_t IndexArena; // NO_ARENA without indices
+            uint32_t FirstIndex;
+            uint32_t IndexCount;
+
+            bool InUse;
+        };
+
+        struct Stats {
+            uint32_t BufferCount { 0 };
+            uint32_t AllocationCount { 0 };
+            VkDeviceSize CapacityBytes { 0 };
+            VkDeviceSize UsedBytes { 0 };
+            uint32_t RebuildCount { 0 };
+            uint32_t RetiredBufferCount { 0 }; // replaced buffers frames in flight may still draw from
+        };
+
+        static constexpr uint32_t NO_ARENA = UINT32_MAX;
+
+        GeometryPool(Device& device, UploadManager& uploadManager);
+        ~GeometryPool();
+
+        GeometryPool(const GeometryPool&) = delete;
+        GeometryPool& operator=(const GeometryPool&) = delete;
+
+        // Queues the vertices and indices on the upload manager, they can be drawn by anything submitted after its next Flush.
+        // indices may be null when indexCount is 0.
+        Allocation Allocate(const void* vertices, uint32_t vertexSize, uint32_t vertexCount, const void* indices, VkIndexType indexType, uint32_t indexCount);
+        // No frame in flight may still draw the allocation, its range is handed out again right away.
+        void Free(Allocation allocation);
+
+        // Moves allocations together in every arena with too many holes and shrinks arenas that mostly went unused.
+        void Compact();
+
+        // Once per frame, destroys the buffers Compact and Allocate replaced once nothing can use them anymore.
+        void Update();
+
+        // Binds the vertex and index buffer of the arenas the allocation lives in.
+        void Bind(VkCommandBuffer commandBuffer, Allocation allocation);
+
+        const Region& GetRegion(Allocation allocation) const {
+            return _regions[allocation];
+        }
+
+        Stats GetStats() const;
+
+    private:
+        struct Arena {
+            VkBufferUsageFlags Usage;
+            uint32_t ElementSize;
+            uint32_t Capacity { 0 };
+            uint32_t UsedCount { 0 };
+
+            std::unique_ptr<VulkanBuffer> Buffer {};
+            std::map<uint32_t, uint32_t> FreeRanges {}; // offset -> count, neighbours are always merged
+        };
+
+        struct RetiredBuffer {
+            std::unique_ptr<VulkanBuffer> Buffer;
+            uint64_t ReleaseFrame;
+            UploadManager::Ticket CopyTicket; // the copy out of it
+        };
+
+        uint32_t GetArena(VkBufferUsageFlags usage, uint32_t elementSize);
+        uint32_t AllocateRange(uint32_t arenaIndex, uint32_t count);
+        void FreeRange(uint32_t arenaIndex, uint32_t offset, uint32_t count);
+        void Rebuild(uint32_t arenaIndex, uint32_t capacity);
+
+        uint32_t GetHoleCount(const Arena& arena) const;
+        uint32_t GetMinCapacity(const Arena& arena) const;
+
+    private:
+        Device& _device;
+        UploadManager& _uploadManager;
+
+        std::vector<Arena> _arenas {};
+        std::vector<Region> _regions {};
+        std::vector<Allocation> _freeAllocations {};
+
+        std::vector<RetiredBuffer> _retiredBuffers {};
+        uint64_t _frame { 0 };
+        uint32_t _rebuildCount { 0 };
+    };
+
+} // namespace Engine
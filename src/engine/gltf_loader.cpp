@@ -0,0 +1,726 @@
+#include "gltf_loader.hpp"
+
+#include "asset_file.hpp"
+#include "utils.hpp"
+
+// libs
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+namespace Engine {
+
+    constexpr uint32_t COMPONENT_BYTE = 5120;
+    constexpr uint32_t COMPONENT_UNSIGNED_BYTE = 5121;
+    constexpr uint32_t COMPONENT_SHORT = 5122;
+    constexpr uint32_t COMPONENT_UNSIGNED_SHORT = 5123;
+    constexpr uint32_t COMPONENT_UNSIGNED_INT = 5125;
+    constexpr uint32_t COMPONENT_FLOAT = 5126;
+
+    constexpr uint32_t MODE_TRIANGLES = 4;
+    constexpr uint32_t MAX_NODE_DEPTH = 256; // guards against cyclic node hierarchies
+    constexpr uint32_t MAX_BYTE_STRIDE = 252; // from the spec, keeps stride * count far from overflowing
+
+    // Just enough JSON for the glTF chunk, the document is small next to the binary data.
+    struct JsonValue {
+        enum class Type { Null, Bool, Number, String, Array, Object };
+
+        Type ValueType { Type::Null };
+        bool Bool { false };
+        double Number { 0.0 };
+        std::string String {};
+        std::vector<JsonValue> Array {};
+        std::vector<std::pair<std::string, JsonValue>> Object {};
+
+        const JsonValue* Find(const char* key) const {
+            for (const auto& [name, value] : Object) {
+                if (name == key) {
+                    return &value;
+                }
+            }
+
+            return nullptr;
+        }
+
+        const JsonValue& operator[](size_t index) const {
+            if (ValueType != Type::Array || index >= Array.size()) {
+                throw std::runtime_error("glTF index out of range");
+            }
+
+            return Array[index];
+        }
+
+        size_t GetSize() const {
+            return ValueType == Type::Array ? Array.size() : 0;
+        }
+
+        double GetNumber(const char* key, double fallback) const {
+            const JsonValue* value = Find(key);
+            return value != nullptr && value->ValueType == Type::Number ? value->Number : fallback;
+        }
+
+        // Offsets, counts, strides and indices. Anything that does not fit a uint32_t throws instead of being cast.
+        uint32_t AsUint() const {
+            if (ValueType != Type::Number || !(Number >= 0.0 && Number <= static_cast<double>(UINT32_MAX))) {
+                throw std::runtime_error("glTF number out of range");
+            }
+
+            return static_cast<uint32_t>(Number);
+        }
+
+        uint32_t GetUint(const char* key, uint32_t fallback) const {
+            const JsonValue* value = Find(key);
+            return value != nullptr ? value->AsUint() : fallback;
+        }
+
+        uint32_t GetIndex(const char* key) const {
+            const JsonValue* value = Find(key);
+
+            if (value == nullptr || value->ValueType != Type::Number) {
+                throw std::runtime_error(std::string { "glTF property " } + key + " is missing");
+            }
+
+            return value->AsUint();
+        }
+    };
+
+    class JsonParser {
+
+    public:
+        JsonParser(const char* text, size_t size) : _at(text), _end(text + size) {}
+
+        JsonValue ParseDocument() {
+            JsonValue value = ParseValue(0);
+            SkipWhitespace();
+
+            if (_at != _end && *_at != '\0') { // the chunk is padded with spaces, some exporters pad with zeros
+                throw std::runtime_error("Unexpected data after the glTF JSON document");
+            }
+
+            return value;
+        }
+
+    private:
+        JsonValue ParseValue(uint32_t depth) {
+            if (depth > MAX_NODE_DEPTH) {
+                throw std::runtime_error("glTF JSON is nested too deep");
+            }
+
+            SkipWhitespace();
+
+            if (_at == _end) {
+                throw std::runtime_error("Unexpected end of glTF JSON");
+            }
+
+            JsonValue value {};
+
+            switch (*_at) {
+                case '{':
+                    value.ValueType = JsonValue::Type::Object;
+                    _at++;
+
+                    if (Consume('}')) {
+                        break;
+                    }
+
+                    do {
+                        SkipWhitespace();
+                        std::string key = ParseString();
+
+                        if (!Consume(':')) {
+                            throw std::runtime_error("Expected ':' in glTF JSON");
+                        }
+
+                        value.Object.emplace_back(std::move(key), ParseValue(depth + 1));
+                    } while (Consume(','));
+
+                    if (!Consume('}')) {
+                        throw std::runtime_error("Expected '}' in glTF JSON");
+                    }
+                    break;
+
+                case '[':
+                    value.ValueType = JsonValue::Type::Array;
+                    _at++;
+
+                    if (Consume(']')) {
+                        break;
+                    }
+
+                    do {
+                        value.Array.push_back(ParseValue(depth + 1));
+                    } while (Consume(','));
+
+                    if (!Consume(']')) {
+                        throw std::runtime_error("Expected ']' in glTF JSON");
+                    }
+                    break;
+
+                case '"':
+                    value.ValueType = JsonValue::Type::String;
+                    value.String = ParseString();
+                    break;
+
+                case 't':
+                    ExpectWord("true");
+                    value.ValueType = JsonValue::Type::Bool;
+                    value.Bool = true;
+                    break;
+
+                case 'f':
+                    ExpectWord("false");
+                    value.ValueType = JsonValue::Type::Bool;
+                    break;
+
+                case 'n':
+                    ExpectWord("null");
+                    break;
+
+                default:
+                    value.ValueType = JsonValue::Type::Number;
+                    value.Number = ParseNumber();
+                    break;
+            }
+
+            return value;
+        }
+
+        // Escaped code points outside of ASCII become '?', glTF only uses strings for names and URIs.
+        std::string ParseString() {
+            if (_at == _end || *_at != '"') {
+                throw std::runtime_error("Expected a string in glTF JSON");
+            }
+
+            _at++;
+            std::string string {};
+
+            while (_at != _end && *_at != '"') {
+                char c = *_at++;
+
+                if (c == '\\') {
+                    if (_at == _end) {
+                        break;
+                    }
+
+                    c = *_at++;
+
+                    switch (c) {
+                        case 'b': c = '\b'; break;
+                        case 'f': c = '\f'; break;
+                        case 'n': c = '\n'; break;
+                        case 'r': c = '\r'; break;
+                        case 't': c = '\t'; break;
+                        case 'u': {
+                            if (_end - _at < 4) {
+                                throw std::runtime_error("Invalid escape in glTF JSON");
+                            }
+
+                            const long codePoint = std::strtol(std::string { _at, 4 }.c_str(), nullptr, 16);
+                            c = codePoint < 0x80 ? static_cast<char>(codePoint) : '?';
+                            _at += 4;
+                            break;
+                        }
+                        default: break; // '"', '\\' and '/' stand for themselves
+                    }
+                }
+
+                string.push_back(c);
+            }
+
+            if (_at == _end) {
+                throw std::runtime_error("Unterminated string in glTF JSON");
+            }
+
+            _at++;
+            return string;
+        }
+
+        double ParseNumber() {
+            const char* begin = _at;
+
+            while (_at != _end && (std::strchr("+-.eE", *_at) != nullptr || (*_at >= '0' && *_at <= '9'))) {
+                _at++;
+            }
+
+            if (_at == begin) {
+                throw std::runtime_error("Unexpected character in glTF JSON");
+            }
+
+            return std::strtod(std::string { begin, _at }.c_str(), nullptr);
+        }
+
+        void ExpectWord(const char* word) {
+            const size_t length = std::strlen(word);
+
+            if (static_cast<size_t>(_end - _at) < length || std::strncmp(_at, word, length) != 0) {
+                throw std::runtime_error("Unexpected character in glTF JSON");
+            }
+
+            _at += length;
+        }
+
+        bool Consume(char c) {
+            SkipWhitespace();
+
+            if (_at != _end && *_at == c) {
+                _at++;
+                return true;
+            }
+
+            return false;
+        }
+
+        void SkipWhitespace() {
+            while (_at != _end && (*_at == ' ' || *_at == '\t' || *_at == '\n' || *_at == '\r')) {
+                _at++;
+            }
+        }
+
+    private:
+        const char* _at;
+        const char* _end;
+    };
+
+    // An accessor resolved to a pointer into the binary chunk.
+    struct AccessorView {
+        const uint8_t* Data;
+        uint32_t Count;
+        uint32_t ComponentType;
+        uint32_t ComponentCount;
+        uint32_t Stride; // bytes between elements
+        bool Normalized;
+    };
+
+    static uint32_t GetComponentSize(uint32_t componentType) {
+        switch (componentType) {
+            case COMPONENT_BYTE:
+            case COMPONENT_UNSIGNED_BYTE: return 1;
+            case COMPONENT_SHORT:
+            case COMPONENT_UNSIGNED_SHORT: return 2;
+            case COMPONENT_UNSIGNED_INT:
+            case COMPONENT_FLOAT: return 4;
+            default: throw std::runtime_error("Unknown glTF component type " + std::to_string(componentType));
+        }
+    }
+
+    static uint32_t GetComponentCount(const std::string& type) {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        if (type == "MAT4") return 16;
+
+        throw std::runtime_error("Unsupported glTF accessor type " + type);
+    }
+
+    static AccessorView GetAccessor(const JsonValue& document, uint32_t accessorIndex, const uint8_t* bin, size_t binSize) {
+        const JsonValue* accessors = document.Find("accessors");
+        const JsonValue* bufferViews = document.Find("bufferViews");
+
+        if (accessors == nullptr || bufferViews == nullptr) {
+            throw std::runtime_error("glTF file has no accessors");
+        }
+
+        const JsonValue& accessor = (*accessors)[accessorIndex];
+
+        if (accessor.Find("sparse") != nullptr) {
+            throw std::runtime_error("Sparse glTF accessors are not supported");
+        }
+
+        const JsonValue* type = accessor.Find("type");
+
+        AccessorView view {};
+        view.Count = accessor.GetIndex("count");
+        view.ComponentType = accessor.GetIndex("componentType");
+        view.ComponentCount = GetComponentCount(type != nullptr ? type->String : "");
+
+        const JsonValue* normalized = accessor.Find("normalized");
+        view.Normalized = normalized != nullptr && normalized->Bool;
+
+        const JsonValue& bufferView = (*bufferViews)[accessor.GetIndex("bufferView")];
+
+        if (bufferView.GetUint("buffer", 0) != 0) {
+            throw std::runtime_error("glTF buffers other than the GLB binary chunk are not supported");
+        }
+
+        const uint32_t elementSize = GetComponentSize(view.ComponentType) * view.ComponentCount;
+        const size_t viewOffset = bufferView.GetUint("byteOffset", 0);
+        const size_t viewLength = bufferView.GetUint("byteLength", 0);
+        const size_t accessorOffset = accessor.GetUint("byteOffset", 0);
+
+        view.Stride = bufferView.GetUint("byteStride", elementSize);
+
+        if (view.Count > 0 && (viewOffset + viewLength > binSize || view.Stride < elementSize || view.Stride > MAX_BYTE_STRIDE
+            || accessorOffset + static_cast<size_t>(view.Stride) * (view.Count - 1) + elementSize > viewLength)) {
+            throw std::runtime_error("glTF accessor " + std::to_string(accessorIndex) + " reaches outside of its buffer view");
+        }
+
+        view.Data = bin + viewOffset + accessorOffset;
+
+        return view;
+    }
+
+    // Reads up to count components of an element as floats, normalized integers are mapped to [0, 1] or [-1, 1].
+    static void ReadFloats(const AccessorView& view, uint32_t element, float* out, uint32_t count) {
+        const uint8_t* source = view.Data + static_cast<size_t>(view.Stride) * element;
+        count = std::min(count, view.ComponentCount);
+
+        if (view.ComponentType == COMPONENT_FLOAT) {
+            std::memcpy(out, source, count * sizeof(float));
+            return;
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            float value = 0.0f;
+            float scale = 1.0f;
+
+            switch (view.ComponentType) {
+                case COMPONENT_BYTE: { int8_t v; std::memcpy(&v, source + i, 1); value = v; scale = 127.0f; break; }
+                case COMPONENT_UNSIGNED_BYTE: { value = source[i]; scale = 255.0f; break; }
+                case COMPONENT_SHORT: { int16_t v; std::memcpy(&v, source + 2 * i, 2); value = v; scale = 32767.0f; break; }
+                case COMPONENT_UNSIGNED_SHORT: { uint16_t v; std::memcpy(&v, source + 2 * i, 2); value = v; scale = 65535.0f; break; }
+                case COMPONENT_UNSIGNED_INT: { uint32_t v; std::memcpy(&v, source + 4 * i, 4); value = static_cast<float>(v); break; }
+            }
+
+            out[i] = view.Normalized ? std::max(value / scale, -1.0f) : value;
+        }
+    }
+
+    // Appends the indices of a primitive, rebased onto the vertices already in data. Tightly packed 32 bit indices
+    // are copied in one go.
+    static void ReadIndices(const AccessorView& view, uint32_t baseVertex, uint32_t vertexCount, std::vector<uint32_t>& indices) {
+        const size_t first = indices.size();
+        indices.resize(first + view.Count);
+        uint32_t* out = indices.data() + first;
+
+        if (view.ComponentType == COMPONENT_UNSIGNED_INT && view.Stride == sizeof(uint32_t)) {
+            std::memcpy(out, view.Data, view.Count * sizeof(uint32_t));
+        }
+        else {
+            for (uint32_t i = 0; i < view.Count; i++) {
+                const uint8_t* source = view.Data + static_cast<size_t>(view.Stride) * i;
+
+                switch (view.ComponentType) {
+                    case COMPONENT_UNSIGNED_BYTE: out[i] = source[0]; break;
+                    case COMPONENT_UNSIGNED_SHORT: { uint16_t v; std::memcpy(&v, source, 2); out[i] = v; break; }
+                    case COMPONENT_UNSIGNED_INT: std::memcpy(&out[i], source, 4); break;
+                    default: throw std::runtime_error("Invalid glTF index component type");
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < view.Count; i++) {
+            if (out[i] >= vertexCount) {
+                throw std::runtime_error("glTF index out of range");
+            }
+
+            out[i] += baseVertex;
+        }
+    }
+
+    static void LoadPrimitive(const JsonValue& document, const JsonValue& primitive, const uint8_t* bin, size_t binSize, Model::Data& data) {
+        const uint32_t mode = primitive.GetUint("mode", MODE_TRIANGLES);
+
+        if (mode != MODE_TRIANGLES) {
+            std::cerr << "Skipped glTF primitive with mode " << mode << ", only triangle lists are supported" << '\n';
+            return;
+        }
+
+        const JsonValue* attributes = primitive.Find("attributes");
+
+        if (attributes == nullptr || attributes->Find("POSITION") == nullptr) {
+            throw std::runtime_error("glTF primitive has no positions");
+        }
+
+        const AccessorView positions = GetAccessor(document, attributes->GetIndex("POSITION"), bin, binSize);
+        const uint32_t baseVertex = static_cast<uint32_t>(data.Vertices.size());
+
+        data.Vertices.resize(baseVertex + positions.Count);
+        Model::Vertex* vertices = data.Vertices.data() + baseVertex;
+
+        for (uint32_t i = 0; i < positions.Count; i++) {
+            ReadFloats(positions, i, &vertices[i].Position.x, 3);
+            vertices[i].Color = glm::vec3 { 1.0f }; // same default as OBJ files without vertex colors
+            vertices[i].Normal = glm::vec3 { 0.0f };
+            vertices[i].UV = glm::vec2 { 0.0f };
+        }
+
+        auto readAttribute = [&](const char* name, uint32_t componentCount, size_t memberOffset) {
+            if (attributes->Find(name) == nullptr) {
+                return;
+            }
+
+            const AccessorView view = GetAccessor(document, attributes->GetIndex(name), bin, binSize);
+
+            if (view.Count != positions.Count) {
+                throw std::runtime_error(std::string { "glTF attribute " } + name + " does not match the vertex count");
+            }
+
+            for (uint32_t i = 0; i < view.Count; i++) {
+                ReadFloats(view, i, reinterpret_cast<float*>(reinterpret_cast<uint8_t*>(&vertices[i]) + memberOffset), componentCount);
+            }
+        };
+
+        readAttribute("NORMAL", 3, offsetof(Model::Vertex, Normal));
+        readAttribute("TEXCOORD_0", 2, offsetof(Model::Vertex, UV));
+        readAttribute("COLOR_0", 3, offsetof(Model::Vertex, Color)); // alpha is dropped
+
+        if (primitive.Find("indices") != nullptr) {
+            const AccessorView indices = GetAccessor(document, primitive.GetIndex("indices"), bin, binSize);
+
+            // Everything after the loader reads triangles three indices at a time.
+            if (indices.Count % 3 != 0) {
+                throw std::runtime_error("glTF triangle list has " + std::to_string(indices.Count) + " indices, not a multiple of 3");
+            }
+
+            ReadIndices(indices, baseVertex, positions.Count, data.Indices);
+        }
+        else {
+            if (positions.Count % 3 != 0) {
+                throw std::runtime_error("glTF triangle list has " + std::to_string(positions.Count) + " vertices, not a multiple of 3");
+            }
+
+            for (uint32_t i = 0; i < positions.Count; i++) {
+                data.Indices.push_back(baseVertex + i);
+            }
+        }
+    }
+
+    static glm::mat4 GetNodeTransform(const JsonValue& node) {
+        if (const JsonValue* matrix = node.Find("matrix"); matrix != nullptr && matrix->GetSize() == 16) {
+            glm::mat4 transform { 1.0f };
+
+            for (int i = 0; i < 16; i++) { // column major, like glm
+                glm::value_ptr(transform)[i] = static_cast<float>((*matrix)[i].Number);
+            }
+
+            return transform;
+        }
+
+        glm::vec3 translation { 0.0f };
+        glm::quat rotation { 1.0f, 0.0f, 0.0f, 0.0f };
+        glm::vec3 scale { 1.0f };
+
+        if (const JsonValue* value = node.Find("translation"); value != nullptr && value->GetSize() == 3) {
+            translation = { (*value)[0].Number, (*value)[1].Number, (*value)[2].Number };
+        }
+
+        if (const JsonValue* value = node.Find("rotation"); value != nullptr && value->GetSize() == 4) { // stored xyzw
+            rotation = glm::quat { static_cast<float>((*value)[3].Number), static_cast<float>((*value)[0].Number),
+                                   static_cast<float>((*value)[1].Number), static_cast<float>((*value)[2].Number) };
+        }
+
+        if (const JsonValue* value = node.Find("scale"); value != nullptr && value->GetSize() == 3) {
+            scale = { (*value)[0].Number, (*value)[1].Number, (*value)[2].Number };
+        }
+
+        return glm::translate(glm::mat4 { 1.0f }, translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4 { 1.0f }, scale);
+    }
+
+    static void AddNode(const JsonValue& nodes, uint32_t nodeIndex, const glm::mat4& parentTransform, uint32_t depth, const std::vector<int32_t>& meshMap,
+                        GltfLoader::Scene& scene) {
+        if (depth > MAX_NODE_DEPTH) {
+            throw std::runtime_error("glTF node hierarchy is too deep or cyclic");
+        }
+
+        const JsonValue& node = nodes[nodeIndex];
+        const glm::mat4 transform = parentTransform * GetNodeTransform(node);
+
+        if (node.Find("mesh") != nullptr) {
+            const uint32_t meshIndex = node.GetIndex("mesh");
+
+            if (meshIndex >= meshMap.size()) {
+                throw std::runtime_error("glTF node references a missing mesh");
+            }
+
+            if (meshMap[meshIndex] >= 0) {
+                scene.Instances.push_back({ static_cast<uint32_t>(meshMap[meshIndex]), transform });
+            }
+        }
+
+        if (const JsonValue* children = node.Find("children"); children != nullptr) {
+            for (size_t i = 0; i < children->GetSize(); i++) {
+                AddNode(nodes, (*children)[i].AsUint(), transform, depth + 1, meshMap, scene);
+            }
+        }
+    }
+
+    GltfLoader::Stats GltfLoader::Load(const std::string& filepath, Scene& scene) {
+        AssetFile file { filepath };
+
+        if (!file.IsOpen()) {
+            throw std::runtime_error("Failed to open " + filepath);
+        }
+
+        scene.SourceHash = hashBytes(file.GetData(), file.GetSize());
+
+        return Parse(file.GetData(), file.GetSize(), scene);
+    }
+
+    GltfLoader::Stats GltfLoader::Parse(const uint8_t* data, size_t size, Scene& scene) {
+        const auto startTime = std::chrono::high_resolution_clock::now();
+
+        // 12 byte header, then chunks of { length, type, data } each padded to 4 bytes.
+        uint32_t header[3] {};
+
+        if (size < sizeof(header)) {
+            throw std::runtime_error("File is too small to be a GLB file");
+        }
+
+        std::memcpy(header, data, sizeof(header));
+
+        if (header[0] != MAGIC || header[1] != 2) {
+            throw std::runtime_error("Not a glTF 2.0 binary file");
+        }
+
+        size = std::min<size_t>(size, header[2]);
+
+        const char* json = nullptr;
+        size_t jsonSize = 0;
+        const uint8_t* bin = nullptr;
+        size_t binSize = 0;
+
+        for (size_t offset = sizeof(header); offset + 8 <= size;) {
+            uint32_t chunk[2] {};
+            std::memcpy(chunk, data + offset, sizeof(chunk));
+            offset += sizeof(chunk);
+
+            if (chunk[0] > size - offset) {
+                throw std::runtime_error("GLB chunk reaches past the end of the file");
+            }
+
+            if (chunk[1] == CHUNK_JSON && json == nullptr) {
+                json = reinterpret_cast<const char*>(data + offset);
+                jsonSize = chunk[0];
+            }
+            else if (chunk[1] == CHUNK_BIN && bin == nullptr) {
+                bin = data + offset;
+                binSize = chunk[0];
+            }
+
+            offset += (static_cast<size_t>(chunk[0]) + 3) & ~static_cast<size_t>(3);
+        }
+
+        if (json == nullptr) {
+            throw std::runtime_error("GLB file has no JSON chunk");
+        }
+
+        const JsonValue document = JsonParser { json, jsonSize }.ParseDocument();
+
+        // Meshes without triangles are dropped, meshMap takes glTF mesh indices to scene mesh indices.
+        std::vector<int32_t> meshMap {};
+        Stats stats {};
+
+        if (const JsonValue* meshes = document.Find("meshes"); meshes != nullptr) {
+            for (size_t i = 0; i < meshes->GetSize(); i++) {
+                const JsonValue& mesh = (*meshes)[i];
+                const JsonValue* primitives = mesh.Find("primitives");
+
+                Model::Data meshData {};
+
+                for (size_t p = 0; primitives != nullptr && p < primitives->GetSize(); p++) {
+                    LoadPrimitive(document, (*primitives)[p], bin, binSize, meshData);
+                }
+
+                if (meshData.Vertices.size() < 3 || meshData.Indices.empty()) {
+                    meshMap.push_back(-1);
+                    continue;
+                }
+
+                const JsonValue* name = mesh.Find("name");
+
+                stats.VertexCount += meshData.Vertices.size();
+                stats.IndexCount += meshData.Indices.size();
+
+                meshMap.push_back(static_cast<int32_t>(scene.Meshes.size()));
+                scene.Meshes.push_back(std::move(meshData));
+                scene.MeshNames.push_back(name != nullptr && !name->String.empty() ? name->String : "mesh" + std::to_string(i));
+            }
+        }
+
+        const JsonValue* nodes = document.Find("nodes");
+        const JsonValue* scenes = document.Find("scenes");
+
+        if (nodes != nullptr && scenes != nullptr && scenes->GetSize() > 0) {
+            const JsonValue& root = (*scenes)[document.GetUint("scene", 0)];
+
+            if (const JsonValue* rootNodes = root.Find("nodes"); rootNodes != nullptr) {
+                for (size_t i = 0; i < rootNodes->GetSize(); i++) {
+                    AddNode(*nodes, (*rootNodes)[i].AsUint(), glm::mat4 { 1.0f }, 0, meshMap, scene);
+                }
+            }
+        }
+        else if (nodes != nullptr) { // no scene, every node that is nobody's child is a root
+            std::vector<bool> isChild(nodes->GetSize(), false);
+
+            for (size_t i = 0; i < nodes->GetSize(); i++) {
+                if (const JsonValue* children = (*nodes)[i].Find("children"); children != nullptr) {
+                    for (size_t c = 0; c < children->GetSize(); c++) {
+                        const size_t child = (*children)[c].AsUint();
+
+                        if (child < isChild.size()) {
+                            isChild[child] = true;
+                        }
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < nodes->GetSize(); i++) {
+                if (!isChild[i]) {
+                    AddNode(*nodes, static_cast<uint32_t>(i), glm::mat4 { 1.0f }, 0, meshMap, scene);
+                }
+            }
+        }
+        else { // meshes only
+            for (uint32_t i = 0; i < scene.Meshes.size(); i++) {
+                scene.Instances.push_back({ i, glm::mat4 { 1.0f } });
+            }
+        }
+
+        stats.Bytes = size;
+        stats.MeshCount = static_cast<uint32_t>(scene.Meshes.size());
+        stats.InstanceCount = static_cast<uint32_t>(scene.Instances.size());
+        stats.Seconds = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        return stats;
+    }
+
+    void GltfLoader::Flatten(const Scene& scene, Model::Data& data) {
+        data.Vertices.clear();
+        data.Indices.clear();
+        data.Lods.clear();
+
+        for (const auto& instance : scene.Instances) {
+            const Model::Data& mesh = scene.Meshes[instance.MeshIndex];
+            const glm::mat3 normalMatrix = glm::inverseTranspose(glm::mat3 { instance.Transform });
+            const uint32_t baseVertex = static_cast<uint32_t>(data.Vertices.size());
+
+            for (Model::Vertex vertex : mesh.Vertices) {
+                vertex.Position = glm::vec3 { instance.Transform * glm::vec4 { vertex.Position, 1.0f } };
+
+                if (vertex.Normal != glm::vec3 { 0.0f }) {
+                    vertex.Normal = glm::normalize(normalMatrix * vertex.Normal);
+                }
+
+                data.Vertices.push_back(vertex);
+            }
+
+            for (uint32_t index : mesh.Indices) {
+                data.Indices.push_back(baseVertex + index);
+            }
+        }
+    }
+
+} // namespace Engine
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "model.hpp"
+
+// libs
+#include <glm/glm.hpp>
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+    // glTF 2.0 binary (.glb) reader. The file is memory mapped and only the JSON chunk is parsed, vertex and index data
+    // is copied out of the binary chunk through the accessors as it is. glTF is already indexed, so there is nothing to weld.
+    // Triangle list primitives only, external buffers and sparse accessors are not supported.
+    class GltfLoader {
+
+    public:
+        // A node that draws a mesh, the transform includes all of its parents.
+        struct Instance {
+            uint32_t MeshIndex;
+            glm::mat4 Transform;
+        };
+
+        struct Scene {
+            std::vector<Model::Data> Meshes {}; // all primitives of a glTF mesh end up in one Data
+            std::vector<std::string> MeshNames {};
+            std::vector<Instance> Instances {};
+            uint64_t SourceHash { 0 }; // of the whole file, set by Load, the mesh caches of the scene are keyed on it
+        };
+
+        struct Stats {
+            size_t Bytes { 0 };
+            double Seconds { 0.0 };
+            uint32_t MeshCount { 0 };
+            uint32_t InstanceCount { 0 };
+            size_t VertexCount { 0 };
+            size_t IndexCount { 0 };
+
+            double GetThroughput() const { // MB/s
+                return Seconds > 0.0 ? (static_cast<double>(Bytes) / (1024.0 * 1024.0)) / Seconds : 0.0;
+            }
+        };
+
+        static constexpr uint32_t MAGIC = 0x46546c67;      // "glTF"
+        static constexpr uint32_t CHUNK_JSON = 0x4e4f534a; // "JSON"
+        static constexpr uint32_t CHUNK_BIN = 0x004e4942;  // "BIN\0"
+
+        static Stats Load(const std::string& filepath, Scene& scene);
+        static Stats Parse(const uint8_t* data, size_t size, Scene& scene);
+
+        // Bakes every instance into one mesh, to load a whole file as a single model.
+        static void Flatten(const Scene& scene, Model::Data& data);
+    };
+
+} // namespace Engine
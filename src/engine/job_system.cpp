@@ -0,0 +1,292 @@
+#include "job_system.hpp"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+// std
+#include <cassert>
+
+namespace Engine {
+
+    // Which system and queue the running thread belongs to.
+    static thread_local const JobSystem* currentSystem = nullptr;
+    static thread_local uint32_t currentThread = JobSystem::INVALID_THREAD;
+
+    JobSystem::WorkQueue::WorkQueue() : _items { new std::atomic<Job*>[QUEUE_CAPACITY] } {}
+
+    bool JobSystem::WorkQueue::Push(Job* job) {
+        const int64_t bottom = _bottom.load(std::memory_order_relaxed);
+        const int64_t top = _top.load(std::memory_order_acquire);
+
+        if (bottom - top >= static_cast<int64_t>(QUEUE_CAPACITY)) {
+            return false;
+        }
+
+        _items[bottom & (QUEUE_CAPACITY - 1)].store(job, std::memory_order_relaxed);
+        _bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    JobSystem::Job* JobSystem::WorkQueue::Pop() {
+        const int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(bottom, std::memory_order_seq_cst); // thieves have to see the claim before we look at top
+        int64_t top = _top.load(std::memory_order_seq_cst);
+
+        if (top > bottom) { // empty
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = _items[bottom & (QUEUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+
+        // The last job, a thief may be after it too.
+        if (top == bottom) {
+            if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                job = nullptr;
+            }
+
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return job;
+    }
+
+    JobSystem::Job* JobSystem::WorkQueue::Steal() {
+        int64_t top = _top.load(std::memory_order_seq_cst);
+        const int64_t bottom = _bottom.load(std::memory_order_seq_cst);
+
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        Job* job = _items[top & (QUEUE_CAPACITY - 1)].load(std::memory_order_relaxed);
+
+        // Lost to the owner or another thief, the slot may already hold something else.
+        if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+
+        return job;
+    }
+
+    JobSystem::JobSystem() : JobSystem(Options {}) {}
+
+    JobSystem::JobSystem(const Options& options) {
+        assert(currentSystem == nullptr && "JobSystem: one system per thread");
+
+        for (uint32_t i = 0; i < options.WorkerCount + 1; i++) {
+            _queues.push_back(std::make_unique<WorkQueue>());
+        }
+
+        currentSystem = this;
+        currentThread = 0;
+
+        for (uint32_t i = 0; i < options.WorkerCount; i++) {
+            _workers.emplace_back(&JobSystem::WorkerLoop, this, i + 1, options.PinThreads);
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock { _sleepMutex };
+            _isStopping = true;
+        }
+
+        _sleepCondition.notify_all();
+
+        for (std::thread& worker : _workers) {
+            worker.join();
+        }
+
+        if (currentSystem == this) {
+            currentSystem = nullptr;
+            currentThread = INVALID_THREAD;
+        }
+    }
+
+    uint32_t JobSystem::GetThreadIndex() const {
+        return currentSystem == this ? currentThread : INVALID_THREAD;
+    }
+
+    void JobSystem::Run(std::function<void()> job, Counter& counter) {
+        Job* queuedJob = new Job { std::move(job), &counter };
+        const uint32_t thread = GetThreadIndex();
+
+        counter._pending.fetch_add(1, std::memory_order_relaxed);
+
+        // Counted before it is pushed, so a thief can never take it below zero.
+        _queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+
+        if (thread != INVALID_THREAD) {
+            if (!_queues[thread]->Push(queuedJob)) {
+                _queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+                Execute(queuedJob);
+                return;
+            }
+        }
+        else {
+            std::lock_guard<std::mutex> lock { _sharedMutex };
+            _sharedJobs.push_back(queuedJob);
+            _sharedJobCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        WakeWorker();
+    }
+
+    void JobSystem::Wait(Counter& counter) {
+        while (!counter.IsDone()) {
+            if (!TryRunOne()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    bool JobSystem::TryRunOne() {
+        Job* job = FindJob(GetThreadIndex());
+
+        if (job == nullptr) {
+            return false;
+        }
+
+        Execute(job);
+        return true;
+    }
+
+    void JobSystem::ParallelFor(uint32_t count, uint32_t minGrainSize, const RangeFunction& body) {
+        if (count == 0) {
+            return;
+        }
+
+        const uint32_t grainSize = std::max({ minGrainSize, count / (GetThreadCount() * CHUNKS_PER_THREAD), 1u });
+
+        if (GetThreadCount() == 1 || count <= grainSize) {
+            body(0, count);
+            return;
+        }
+
+        Counter counter {};
+        SplitRange(0, count, grainSize, body, counter);
+        Wait(counter);
+    }
+
+    void JobSystem::WorkerLoop(uint32_t thread, bool pinThread) {
+        currentSystem = this;
+        currentThread = thread;
+
+        if (pinThread) {
+            PinCurrentThread(thread % std::max(std::thread::hardware_concurrency(), 1u));
+        }
+
+        while (true) {
+            if (Job* job = FindJob(thread)) {
+                Execute(job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock { _sleepMutex };
+
+            // Run checks _sleepingCount after counting its job, one of the two sees the other.
+            _sleepingCount.fetch_add(1, std::memory_order_seq_cst);
+            _sleepCondition.wait(lock, [this] { return _isStopping || _queuedJobs.load(std::memory_order_seq_cst) > 0; });
+            _sleepingCount.fetch_sub(1, std::memory_order_relaxed);
+
+            if (_isStopping) {
+                return;
+            }
+        }
+    }
+
+    JobSystem::Job* JobSystem::FindJob(uint32_t thread) {
+        Job* job = nullptr;
+
+        if (thread != INVALID_THREAD) {
+            job = _queues[thread]->Pop();
+        }
+
+        if (job == nullptr && _sharedJobCount.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock { _sharedMutex };
+
+            if (!_sharedJobs.empty()) {
+                job = _sharedJobs.front();
+                _sharedJobs.pop_front();
+                _sharedJobCount.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+        // Steal, starting after our own queue so thieves spread over the victims.
+        const uint32_t threadCount = GetThreadCount();
+        const uint32_t start = thread != INVALID_THREAD ? thread + 1 : 0;
+
+        for (uint32_t i = 0; job == nullptr && i < threadCount; i++) {
+            const uint32_t victim = (start + i) % threadCount;
+
+            if (victim != thread) {
+                job = _queues[victim]->Steal();
+
+                if (job != nullptr) {
+                    _stealCount.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        if (job != nullptr) {
+            _queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        return job;
+    }
+
+    void JobSystem::Execute(Job* job) {
+        job->Work();
+
+        Counter* counter = job->JobCounter;
+        delete job;
+
+        counter->_pending.fetch_sub(1, std::memory_order_acq_rel); // the waiter may free the counter right after this
+    }
+
+    void JobSystem::WakeWorker() {
+        if (_sleepingCount.load(std::memory_order_seq_cst) == 0) {
+            return;
+        }
+
+        // Taking the lock makes sure a worker that just counted itself as sleeping is waiting by the time we notify.
+        {
+            std::lock_guard<std::mutex> lock { _sleepMutex };
+        }
+
+        _sleepCondition.notify_one();
+    }
+
+    // Hands out the upper half until the range is small enough, so the first thieves get the biggest pieces.
+    void JobSystem::SplitRange(uint32_t begin, uint32_t end, uint32_t grainSize, const RangeFunction& body, Counter& counter) {
+        while (end - begin > grainSize) {
+            const uint32_t middle = begin + (end - begin) / 2;
+
+            Run([this, middle, end, grainSize, &body, &counter]() { SplitRange(middle, end, grainSize, body, counter); }, counter);
+            end = middle;
+        }
+
+        body(begin, end);
+    }
+
+    void JobSystem::PinCurrentThread(uint32_t core) {
+#ifdef _WIN32
+        SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << (core % (sizeof(DWORD_PTR) * 8)));
+#elif defined(__linux__)
+        cpu_set_t cores;
+        CPU_ZERO(&cores);
+        CPU_SET(core, &cores);
+        pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores);
+#else
+        (void)core;
+#endif
+    }
+
+} // namespace Engine
@@ -0,0 +1,134 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Engine {
+
+    // Work stealing thread pool the rest of the engine runs its parallel work on. Every thread has its own queue, it
+    // pushes and pops at one end and idle threads steal the oldest job from the other, so a thread splitting its work
+    // keeps the pieces it is about to touch and hands out the big ones.
+    //
+    // The thread that creates the system is thread 0 and has a queue too, it only runs jobs while it waits. Other
+    // threads can submit jobs, they go through a shared queue.
+    class JobSystem {
+
+    public:
+        static constexpr uint32_t QUEUE_CAPACITY = 4096;  // jobs per thread, past that Run does the job right away
+        static constexpr uint32_t CHUNKS_PER_THREAD = 8;  // ParallelFor splits into about this many ranges per thread
+        static constexpr uint32_t INVALID_THREAD = UINT32_MAX;
+
+        static_assert((QUEUE_CAPACITY & (QUEUE_CAPACITY - 1)) == 0, "JobSystem::QUEUE_CAPACITY must be a power of two");
+
+        struct Options {
+            uint32_t WorkerCount { std::max(std::thread::hardware_concurrency(), 1u) - 1 }; // threads besides the creating one
+            bool PinThreads { false }; // worker n stays on core n, the creating thread is left alone
+        };
+
+        // Jobs started with a counter that have not finished yet.
+        class Counter {
+
+        public:
+            bool IsDone() const {
+                return _pending.load(std::memory_order_acquire) == 0;
+            }
+
+        private:
+            friend class JobSystem;
+
+            std::atomic<uint32_t> _pending { 0 };
+        };
+
+        using RangeFunction = std::function<void(uint32_t begin, uint32_t end)>;
+
+        JobSystem();
+        explicit JobSystem(const Options& options);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        uint32_t GetThreadCount() const {
+            return static_cast<uint32_t>(_queues.size());
+        }
+
+        // 0 for the thread that created the system, INVALID_THREAD for threads that are not its own.
+        uint32_t GetThreadIndex() const;
+
+        // Jobs must not throw, catch inside them and hand the error to whoever waits.
+        void Run(std::function<void()> job, Counter& counter);
+
+        // Runs other jobs until every job started with the counter is done, so waiting inside a job can not deadlock.
+        void Wait(Counter& counter);
+
+        // Runs one queued job if there is one, returns false if there was nothing to do.
+        bool TryRunOne();
+
+        // Calls body on ranges that cover [0, count) and returns once all are done. Ranges are at least minGrainSize
+        // long and otherwise sized from the thread count. The range is halved recursively and the halves stolen, so
+        // uneven work spreads out on its own.
+        void ParallelFor(uint32_t count, uint32_t minGrainSize, const RangeFunction& body);
+
+        uint64_t GetStealCount() const {
+            return _stealCount.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct Job {
+            std::function<void()> Work;
+            Counter* JobCounter;
+        };
+
+        // Chase-Lev deque on a fixed ring, the owner pushes and pops at the bottom, everyone else steals from the top.
+        class WorkQueue {
+
+        public:
+            WorkQueue();
+
+            bool Push(Job* job);
+            Job* Pop();
+            Job* Steal();
+
+        private:
+            std::unique_ptr<std::atomic<Job*>[]> _items;
+            alignas(64) std::atomic<int64_t> _top { 0 };
+            alignas(64) std::atomic<int64_t> _bottom { 0 };
+        };
+
+        void WorkerLoop(uint32_t thread, bool pinThread);
+        Job* FindJob(uint32_t thread);
+        void Execute(Job* job);
+        void WakeWorker();
+        void SplitRange(uint32_t begin, uint32_t end, uint32_t grainSize, const RangeFunction& body, Counter& counter);
+
+        static void PinCurrentThread(uint32_t core);
+
+    private:
+        std::vector<std::unique_ptr<WorkQueue>> _queues {}; // by thread
+        std::vector<std::thread> _workers {};
+
+        // Jobs from threads without a queue.
+        std::mutex _sharedMutex {};
+        std::deque<Job*> _sharedJobs {};
+        std::atomic<uint32_t> _sharedJobCount { 0 }; // so the queues only take the lock when there is something
+
+        // Workers sleep when no queue has anything, _queuedJobs is checked under _sleepMutex before they do.
+        std::mutex _sleepMutex {};
+        std::condition_variable _sleepCondition {};
+        std::atomic<uint32_t> _queuedJobs { 0 };
+        std::atomic<uint32_t> _sleepingCount { 0 };
+        bool _isStopping { false };
+
+        std::atomic<uint64_t> _stealCount { 0 };
+    };
+
+} // namespace Engine
@@ -5,7 +5,7 @@
 
 namespace Engine {
 
-    void KeyboardMovement::MoveInPlaneXZ(GLFWwindow *window, float deltaTime, GameObject &gameObject) {
+    void KeyboardMovement::MoveInPlaneXZ(GLFWwindow *window, float deltaTime, TransformComponent& transform) {
         glm::vec3 rotate { 0.0f };
 
         if (glfwGetKey(window, Keys.LookRight) == GLFW_PRESS) {
@@ -25,13 +25,13 @@ namespace Engine {
         }
 
         if (glm::dot(rotate, rotate) > std::numeric_limits<float>::epsilon()) { // rotate is not zero
-            gameObject.Transform.Rotation += LookSpeed * deltaTime * glm::normalize(rotate);
+            transform.Rotation += LookSpeed * deltaTime * glm::normalize(rotate);
         }
 
-        gameObject.Transform.Rotation.x = glm::clamp(gameObject.Transform.Rotation.x, -1.5f, 1.5f);
-        gameObject.Transform.Rotation.y = glm::mod(gameObject.Transform.Rotation.y, glm::two_pi<float>());
+        transform.Rotation.x = glm::clamp(transform.Rotation.x, -1.5f, 1.5f);
+        transform.Rotation.y = glm::mod(transform.Rotation.y, glm::two_pi<float>());
 
-        float yaw = gameObject.Transform.Rotation.y;
+        float yaw = transform.Rotation.y;
         const glm::vec3 forwardDirection { sin(yaw), 0.0f, cos(yaw) };
         const glm::vec3 rightDirection { forwardDirection.z, 0.0f, -forwardDirection.x };
         const glm::vec3 upDirection { 0.0f, -1.0f, 0.0f };
@@ -63,7 +63,7 @@ namespace Engine {
         }
 
         if (glm::dot(moveDirection, moveDirection) > std::numeric_limits<float>::epsilon()) { // rotate is not zero
-            gameObject.Transform.Position += MoveSpeed * deltaTime * glm::normalize(moveDirection);
+            transform.Position += MoveSpeed * deltaTime * glm::normalize(moveDirection);
         }
     }
     
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "game_object.hpp"
+#include "components.hpp"
 #include "window.hpp"
 
 namespace Engine {
@@ -21,7 +21,7 @@ namespace Engine {
             int LookDown     = GLFW_KEY_DOWN;
         };
 
-        void MoveInPlaneXZ(GLFWwindow* window, float deltaTime, GameObject& gameObject);
+        void MoveInPlaneXZ(GLFWwindow* window, float deltaTime, TransformComponent& transform);
 
     public:
         KeyMappings Keys {};
@@ -0,0 +1,174 @@
+#include "lz4.hpp"
+
+// std
+#include <cstring>
+
+namespace Engine {
+
+    constexpr size_t LAST_LITERALS = 5;  // the block always ends with at least this many literals
+    constexpr size_t MATCH_LIMIT = 12;   // no match may start in the last 12 bytes
+    constexpr uint32_t HASH_BITS = 16;
+
+    static uint32_t Read32(const uint8_t* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    static void WriteLength(std::vector<uint8_t>& out, size_t length) { // the part that did not fit the token nibble
+        while (length >= 255) {
+            out.push_back(255);
+            length -= 255;
+        }
+
+        out.push_back(static_cast<uint8_t>(length));
+    }
+
+    static void WriteSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength) {
+        const size_t matchCode = matchLength > 0 ? matchLength - Lz4::MIN_MATCH : 0;
+
+        out.push_back(static_cast<uint8_t>(((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15)));
+
+        if (literalCount >= 15) {
+            WriteLength(out, literalCount - 15);
+        }
+
+        out.insert(out.end(), literals, literals + literalCount);
+
+        if (matchLength == 0) { // the last sequence has no match
+            return;
+        }
+
+        out.push_back(static_cast<uint8_t>(offset & 0xff));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+
+        if (matchCode >= 15) {
+            WriteLength(out, matchCode - 15);
+        }
+    }
+
+    size_t Lz4::Compress(const uint8_t* source, size_t size, std::vector<uint8_t>& out) {
+        const size_t start = out.size();
+        out.reserve(start + GetMaxCompressedSize(size));
+
+        size_t anchor = 0;
+
+        if (size > MATCH_LIMIT) {
+            std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0); // position + 1, 0 is empty
+            const size_t matchEnd = size - LAST_LITERALS;
+
+            for (size_t i = 0; i < size - MATCH_LIMIT;) {
+                const uint32_t sequence = Read32(source + i);
+                const uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+                const size_t candidate = table[hash];
+
+                table[hash] = static_cast<uint32_t>(i + 1);
+
+                if (candidate == 0 || i - (candidate - 1) > MAX_OFFSET || Read32(source + candidate - 1) != sequence) {
+                    i++;
+                    continue;
+                }
+
+                const size_t match = candidate - 1;
+                size_t length = MIN_MATCH;
+
+                while (i + length < matchEnd && source[match + length] == source[i + length]) {
+                    length++;
+                }
+
+                WriteSequence(out, source + anchor, i - anchor, i - match, length);
+
+                i += length;
+                anchor = i;
+            }
+        }
+
+        WriteSequence(out, source + anchor, size - anchor, 0, 0);
+
+        return out.size() - start;
+    }
+
+    bool Lz4::Decompress(const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t destinationSize) {
+        const uint8_t* in = source;
+        const uint8_t* const inEnd = source + sourceSize;
+        uint8_t* out = destination;
+        uint8_t* const outEnd = destination + destinationSize;
+
+        auto readLength = [&](size_t& length) {
+            uint8_t byte;
+
+            do {
+                if (in == inEnd) {
+                    return false;
+                }
+
+                byte = *in++;
+                length += byte;
+            } while (byte == 255);
+
+            return true;
+        };
+
+        while (in < inEnd) {
+            const uint8_t token = *in++;
+            size_t literalCount = token >> 4;
+
+            if (literalCount == 15 && !readLength(literalCount)) {
+                return false;
+            }
+
+            if (literalCount > static_cast<size_t>(inEnd - in) || literalCount > static_cast<size_t>(outEnd - out)) {
+                return false;
+            }
+
+            if (literalCount > 0) {
+                std::memcpy(out, in, literalCount);
+            }
+
+            in += literalCount;
+            out += literalCount;
+
+            if (in == inEnd) { // last sequence
+                break;
+            }
+
+            if (inEnd - in < 2) {
+                return false;
+            }
+
+            const size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+            in += 2;
+
+            if (offset == 0 || offset > static_cast<size_t>(out - destination)) {
+                return false;
+            }
+
+            size_t matchLength = token & 0x0f;
+
+            if (matchLength == 15 && !readLength(matchLength)) {
+                return false;
+            }
+
+            matchLength += MIN_MATCH;
+
+            if (matchLength > static_cast<size_t>(outEnd - out)) {
+                return false;
+            }
+
+            const uint8_t* match = out - offset;
+
+            if (offset >= matchLength) {
+                std::memcpy(out, match, matchLength);
+                out += matchLength;
+            }
+            else { // overlapping, repeats the last offset bytes
+                for (size_t i = 0; i < matchLength; i++) {
+                    *out++ = match[i];
+                }
+            }
+        }
+
+        return out == outEnd;
+    }
+
+} // namespace Engine
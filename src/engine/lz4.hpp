@@ -0,0 +1,29 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+
+    // LZ4 block format codec (no frame format, the caller keeps the sizes). Single pass greedy compressor,
+    // decompression is a tight copy loop that checks every length against both buffers.
+    class Lz4 {
+
+    public:
+        static constexpr uint32_t MIN_MATCH = 4;
+        static constexpr uint32_t MAX_OFFSET = 65535;
+
+        // Appends the compressed block to out and returns its size.
+        static size_t Compress(const uint8_t* source, size_t size, std::vector<uint8_t>& out);
+
+        // False if the block is malformed or does not decompress to exactly destinationSize bytes.
+        static bool Decompress(const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t destinationSize);
+
+        static size_t GetMaxCompressedSize(size_t size) {
+            return size + size / 255 + 16;
+        }
+    };
+
+} // namespace Engine
@@ -0,0 +1,151 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// std
+#include <utility>
+
+namespace Engine {
+
+#ifdef _WIN32
+
+    MappedFile::MappedFile(const std::string& filepath) {
+        HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+
+        LARGE_INTEGER fileSize {};
+
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            return;
+        }
+
+        _fileHandle = file;
+        _size = static_cast<size_t>(fileSize.QuadPart);
+        _isOpen = true;
+
+        if (_size == 0) { // empty files cannot be mapped, but they are still valid files.
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (mapping == nullptr) {
+            Close();
+            return;
+        }
+
+        _mappingHandle = mapping;
+        _data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+
+        if (_data == nullptr) {
+            Close();
+        }
+    }
+
+    void MappedFile::Close() {
+        if (_data != nullptr) {
+            UnmapViewOfFile(_data);
+        }
+
+        if (_mappingHandle != nullptr) {
+            CloseHandle(static_cast<HANDLE>(_mappingHandle));
+        }
+
+        if (_fileHandle != nullptr) {
+            CloseHandle(static_cast<HANDLE>(_fileHandle));
+        }
+
+        _data = nullptr;
+        _size = 0;
+        _isOpen = false;
+        _fileHandle = nullptr;
+        _mappingHandle = nullptr;
+    }
+
+#else
+
+    MappedFile::MappedFile(const std::string& filepath) {
+        int file = open(filepath.c_str(), O_RDONLY);
+
+        if (file < 0) {
+            return;
+        }
+
+        struct stat fileStat {};
+
+        if (fstat(file, &fileStat) != 0) {
+            close(file);
+            return;
+        }
+
+        _size = static_cast<size_t>(fileStat.st_size);
+        _isOpen = true;
+
+        if (_size > 0) { // empty files cannot be mapped, but they are still valid files.
+            void* mapped = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, file, 0);
+
+            if (mapped == MAP_FAILED) {
+                _size = 0;
+                _isOpen = false;
+            }
+            else {
+                _data = static_cast<const uint8_t*>(mapped);
+                madvise(mapped, _size, MADV_SEQUENTIAL);
+            }
+        }
+
+        close(file); // the mapping keeps its own reference to the file.
+    }
+
+    void MappedFile::Close() {
+        if (_data != nullptr) {
+            munmap(const_cast<uint8_t*>(_data), _size);
+        }
+
+        _data = nullptr;
+        _size = 0;
+        _isOpen = false;
+    }
+
+#endif
+
+    MappedFile::~MappedFile() {
+        Close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        Close();
+
+        std::swap(_data, other._data);
+        std::swap(_size, other._size);
+        std::swap(_isOpen, other._isOpen);
+#ifdef _WIN32
+        std::swap(_fileHandle, other._fileHandle);
+        std::swap(_mappingHandle, other._mappingHandle);
+#endif
+
+        return *this;
+    }
+
+} // namespace Engine
@@ -0,0 +1,50 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Engine {
+
+    // Read-only memory mapping of a whole file. The OS pages the contents in on demand,
+    // so nothing is copied until the bytes are actually touched.
+    class MappedFile {
+
+    public:
+        MappedFile() = default;
+        explicit MappedFile(const std::string& filepath);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        bool IsOpen() const {
+            return _isOpen;
+        }
+
+        const uint8_t* GetData() const {
+            return _data;
+        }
+
+        size_t GetSize() const {
+            return _size;
+        }
+
+    private:
+        void Close();
+
+    private:
+        const uint8_t* _data { nullptr };
+        size_t _size { 0 };
+        bool _isOpen { false };
+
+#ifdef _WIN32
+        void* _fileHandle { nullptr };
+        void* _mappingHandle { nullptr };
+#endif
+    };
+
+} // namespace Engine
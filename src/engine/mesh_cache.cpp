@@ -0,0 +1,164 @@
+#include "mesh_cache.hpp"
+
+#include "utils.hpp"
+
+// std
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace Engine {
+
+    constexpr uint64_t DATA_ALIGNMENT = 16;
+
+    static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    MeshCache::MeshCache(const std::string& sourcePath)
+        : _cachePath(GetCachePath(sourcePath))
+    {
+        {
+            AssetFile source { sourcePath };
+
+            if (!source.IsOpen()) {
+                return;
+            }
+
+            _sourceHash = hashBytes(source.GetData(), source.GetSize());
+        }
+
+        Open();
+    }
+
+    MeshCache::MeshCache(const std::string& cachePath, uint64_t sourceHash)
+        : _cachePath(cachePath), _sourceHash(sourceHash)
+    {
+        Open();
+    }
+
+    void MeshCache::Open() {
+        _cacheFile = AssetFile { _cachePath };
+
+        if (!_cacheFile.IsOpen() || _cacheFile.GetSize() < sizeof(Header)) {
+            return;
+        }
+
+        std::memcpy(&_header, _cacheFile.GetData(), sizeof(Header));
+        _isValid = Validate();
+    }
+
+    bool MeshCache::Validate() const {
+        if (_header.Magic != MAGIC || _header.Version != VERSION) {
+            return false;
+        }
+
+        if (_header.SourceHash != _sourceHash || _header.VertexStride != sizeof(Model::Vertex)) {
+            return false;
+        }
+
+        const uint64_t vertexBytes = static_cast<uint64_t>(_header.VertexCount) * sizeof(Model::Vertex);
+        const uint64_t indexBytes = static_cast<uint64_t>(_header.IndexCount) * sizeof(uint32_t);
+        const uint64_t lodBytes = static_cast<uint64_t>(_header.LodCount) * sizeof(Model::Lod);
+
+        const bool isInFile = _header.VertexOffset % DATA_ALIGNMENT == 0
+            && _header.IndexOffset % DATA_ALIGNMENT == 0
+            && _header.LodOffset % DATA_ALIGNMENT == 0
+            && _header.VertexOffset + vertexBytes <= _cacheFile.GetSize()
+            && _header.IndexOffset + indexBytes <= _cacheFile.GetSize()
+            && _header.LodOffset + lodBytes <= _cacheFile.GetSize();
+
+        if (!isInFile) {
+            return false;
+        }
+
+        // Every LOD is drawn as is, its triangles have to lie inside the index array.
+        for (uint32_t i = 0; i < _header.LodCount; i++) {
+            Model::Lod lod;
+            std::memcpy(&lod, _cacheFile.GetData() + _header.LodOffset + i * sizeof(Model::Lod), sizeof(Model::Lod));
+
+            if (lod.IndexCount % 3 != 0 || static_cast<uint64_t>(lod.FirstIndex) + lod.IndexCount > _header.IndexCount) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    const Model::Vertex* MeshCache::GetVertices() const {
+        assert(_isValid && "Cannot read vertices from an invalid mesh cache.");
+        return reinterpret_cast<const Model::Vertex*>(_cacheFile.GetData() + _header.VertexOffset);
+    }
+
+    const uint32_t* MeshCache::GetIndices() const {
+        assert(_isValid && "Cannot read indices from an invalid mesh cache.");
+        return reinterpret_cast<const uint32_t*>(_cacheFile.GetData() + _header.IndexOffset);
+    }
+
+    std::vector<Model::Lod> MeshCache::GetLods() const {
+        assert(_isValid && "Cannot read LODs from an invalid mesh cache.");
+
+        std::vector<Model::Lod> lods(_header.LodCount);
+        std::memcpy(lods.data(), _cacheFile.GetData() + _header.LodOffset, lods.size() * sizeof(Model::Lod));
+
+        return lods;
+    }
+
+    void MeshCache::Write(const Model::Data& data) {
+        // Drop our view of the stale sidecar first, a mapped file cannot be replaced on windows.
+        _cacheFile = AssetFile {};
+        _isValid = false;
+
+        Header header {};
+        header.Magic = MAGIC;
+        header.Version = VERSION;
+        header.SourceHash = _sourceHash;
+        header.VertexStride = sizeof(Model::Vertex);
+        header.VertexCount = static_cast<uint32_t>(data.Vertices.size());
+        header.IndexCount = static_cast<uint32_t>(data.Indices.size());
+        header.LodCount = static_cast<uint32_t>(data.Lods.size());
+        header.VertexOffset = AlignUp(sizeof(Header), DATA_ALIGNMENT);
+        header.IndexOffset = AlignUp(header.VertexOffset + data.Vertices.size() * sizeof(Model::Vertex), DATA_ALIGNMENT);
+        header.LodOffset = AlignUp(header.IndexOffset + data.Indices.size() * sizeof(uint32_t), DATA_ALIGNMENT);
+
+        const std::string tempPath = _cachePath + ".tmp";
+        std::ofstream file { tempPath, std::ios::binary | std::ios::trunc };
+
+        if (!file.is_open()) {
+            std::cerr << "Failed to write mesh cache: " << _cachePath << '\n';
+            return;
+        }
+
+        const char zeros[DATA_ALIGNMENT] {};
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(zeros, header.VertexOffset - sizeof(Header));
+        file.write(reinterpret_cast<const char*>(data.Vertices.data()), data.Vertices.size() * sizeof(Model::Vertex));
+        file.write(zeros, header.IndexOffset - (header.VertexOffset + data.Vertices.size() * sizeof(Model::Vertex)));
+        file.write(reinterpret_cast<const char*>(data.Indices.data()), data.Indices.size() * sizeof(uint32_t));
+        file.write(zeros, header.LodOffset - (header.IndexOffset + data.Indices.size() * sizeof(uint32_t)));
+        file.write(reinterpret_cast<const char*>(data.Lods.data()), data.Lods.size() * sizeof(Model::Lod));
+        file.close();
+
+        if (!file) {
+            std::cerr << "Failed to write mesh cache: " << _cachePath << '\n';
+            std::remove(tempPath.c_str());
+            return;
+        }
+
+        // Write then rename, so a crash mid-write never leaves a truncated sidecar behind.
+        std::remove(_cachePath.c_str());
+
+        if (std::rename(tempPath.c_str(), _cachePath.c_str()) != 0) {
+            std::cerr << "Failed to write mesh cache: " << _cachePath << '\n';
+            std::remove(tempPath.c_str());
+        }
+    }
+
+    std::string MeshCache::GetCachePath(const std::string& sourcePath) {
+        return sourcePath + ".meshcache";
+    }
+
+} // namespace Engine
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "asset_file.hpp"
+#include "model.hpp"
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+    // Binary sidecar ("<model>.meshcache") holding the final vertex and index arrays of a model,
+    // so the OBJ only has to be parsed again when its contents change.
+    class MeshCache {
+
+    public:
+        static constexpr uint32_t MAGIC = 0x48534d56; // "VMSH"
+        static constexpr uint32_t VERSION = 3; // 2: data is stored after MeshOptimizer, 3: LOD table
+
+        // Everything after the header is stored exactly as it will be uploaded, the mapped
+        // arrays can be copied straight into a staging buffer.
+        struct Header {
+            uint32_t Magic;
+            uint32_t Version;
+            uint64_t SourceHash;
+            uint32_t VertexStride;
+            uint32_t VertexCount;
+            uint32_t IndexCount;
+            uint32_t LodCount;
+            uint64_t VertexOffset;
+            uint64_t IndexOffset;
+            uint64_t LodOffset;
+            uint64_t Padding;
+        };
+
+        static_assert(sizeof(Header) == 64, "MeshCache::Header layout must not change without bumping VERSION");
+
+        explicit MeshCache(const std::string& sourcePath);
+
+        // For a mesh that is part of a bigger source (one mesh of a glTF scene), hashed by the caller.
+        MeshCache(const std::string& cachePath, uint64_t sourceHash);
+
+        MeshCache(const MeshCache&) = delete;
+        MeshCache& operator=(const MeshCache&) = delete;
+
+        // True when the sidecar exists and was built from the current contents of the source file.
+        bool IsValid() const {
+            return _isValid;
+        }
+
+        const Model::Vertex* GetVertices() const;
+        const uint32_t* GetIndices() const;
+        std::vector<Model::Lod> GetLods() const;
+
+        uint32_t GetVertexCount() const {
+            return _header.VertexCount;
+        }
+
+        uint32_t GetIndexCount() const {
+            return _header.IndexCount;
+        }
+
+        uint64_t GetSourceHash() const {
+            return _sourceHash;
+        }
+
+        // Replaces the sidecar with the given data, tagged with the hash of the current source file.
+        void Write(const Model::Data& data);
+
+        static std::string GetCachePath(const std::string& sourcePath);
+
+    private:
+        void Open();
+        bool Validate() const;
+
+    private:
+        std::string _cachePath;
+        uint64_t _sourceHash { 0 };
+
+        AssetFile _cacheFile;
+        Header _header {};
+        bool _isValid { false };
+    };
+
+} // namespace Engine
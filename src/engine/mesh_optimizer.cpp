@@ -0,0 +1,335 @@
+#include "mesh_optimizer.hpp"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace Engine {
+
+    constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    // FIFO post-transform cache, a vertex is resident while fewer than CACHE_SIZE misses happened since it was loaded.
+    struct CacheSimulator {
+        std::vector<uint32_t> LoadTimes {};
+        uint32_t Timestamp { MeshOptimizer::CACHE_SIZE + 1 };
+
+        explicit CacheSimulator(size_t vertexCount)
+            : LoadTimes(vertexCount, 0)
+        {
+        }
+
+        bool IsResident(uint32_t vertex) const {
+            return Timestamp - LoadTimes[vertex] <= MeshOptimizer::CACHE_SIZE;
+        }
+
+        // Returns true on a miss.
+        bool Access(uint32_t vertex) {
+            if (IsResident(vertex)) {
+                return false;
+            }
+
+            LoadTimes[vertex] = Timestamp++;
+            return true;
+        }
+
+        void Flush() {
+            Timestamp += MeshOptimizer::CACHE_SIZE + 1;
+        }
+    };
+
+    void MeshOptimizer::Optimize(Model::Data& data) {
+        if (data.Indices.size() < 3) {
+            return;
+        }
+
+        auto log = [](const char* step, const CacheStats& before, const CacheStats& after, std::chrono::steady_clock::time_point start) {
+            const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << "Mesh optimizer, " << step << ": ACMR " << before.ACMR << " -> " << after.ACMR
+                      << ", ATVR " << before.ATVR << " -> " << after.ATVR << " (" << milliseconds << " ms)" << std::endl;
+        };
+
+        const CacheStats input = AnalyzeVertexCache(data.Indices, data.Vertices.size());
+
+        auto start = std::chrono::steady_clock::now();
+        const std::vector<uint32_t> clusters = OptimizeVertexCache(data.Indices, data.Vertices.size());
+        const CacheStats afterVertexCache = AnalyzeVertexCache(data.Indices, data.Vertices.size());
+        log("vertex cache", input, afterVertexCache, start);
+
+        start = std::chrono::steady_clock::now();
+        OptimizeOverdraw(data.Indices, data.Vertices, clusters);
+        const CacheStats afterOverdraw = AnalyzeVertexCache(data.Indices, data.Vertices.size());
+        log("overdraw", afterVertexCache, afterOverdraw, start);
+
+        start = std::chrono::steady_clock::now();
+        OptimizeVertexFetch(data);
+        log("vertex fetch", afterOverdraw, AnalyzeVertexCache(data.Indices, data.Vertices.size()), start);
+    }
+
+    MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount) {
+        CacheSimulator cache { vertexCount };
+        std::vector<bool> used(vertexCount, false);
+
+        size_t misses = 0;
+        size_t usedCount = 0;
+
+        for (uint32_t index : indices) {
+            misses += cache.Access(index) ? 1 : 0;
+
+            if (!used[index]) {
+                used[index] = true;
+                usedCount++;
+            }
+        }
+
+        CacheStats stats {};
+
+        if (indices.size() >= 3) {
+            stats.ACMR = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+            stats.ATVR = static_cast<float>(misses) / static_cast<float>(usedCount);
+        }
+
+        return stats;
+    }
+
+    std::vector<uint32_t> MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+        const size_t triangleCount = indices.size() / 3;
+
+        // Vertex -> triangle adjacency, liveTriangles counts the triangles of a vertex that were not emitted yet.
+        std::vector<uint32_t> liveTriangles(vertexCount, 0);
+        std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+
+        for (size_t i = 0; i < triangleCount * 3; i++) {
+            liveTriangles[indices[i]]++;
+        }
+
+        for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+            adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + liveTriangles[vertex];
+        }
+
+        {
+            std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+            for (size_t i = 0; i < triangleCount * 3; i++) {
+                adjacency[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        CacheSimulator cache { vertexCount };
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnds {};
+        std::vector<uint32_t> candidates {};
+        std::vector<uint32_t> clusters {};
+        std::vector<uint32_t> output {};
+        output.reserve(triangleCount * 3);
+
+        size_t scanCursor = 0;
+
+        auto nextLiveVertex = [&]() {
+            while (!deadEnds.empty()) {
+                const uint32_t vertex = deadEnds.back();
+                deadEnds.pop_back();
+
+                if (liveTriangles[vertex] > 0) {
+                    return vertex;
+                }
+            }
+
+            while (scanCursor < vertexCount && liveTriangles[scanCursor] == 0) {
+                scanCursor++;
+            }
+
+            return scanCursor < vertexCount ? static_cast<uint32_t>(scanCursor) : INVALID_INDEX;
+        };
+
+        uint32_t fanningVertex = nextLiveVertex();
+
+        while (fanningVertex != INVALID_INDEX) {
+            candidates.clear();
+
+            for (uint32_t i = adjacencyOffsets[fanningVertex]; i < adjacencyOffsets[fanningVertex + 1]; i++) {
+                const uint32_t triangle = adjacency[i];
+
+                if (emitted[triangle]) {
+                    continue;
+                }
+
+                for (uint32_t corner = 0; corner < 3; corner++) {
+                    const uint32_t vertex = indices[3 * triangle + corner];
+
+                    output.push_back(vertex);
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    liveTriangles[vertex]--;
+                    cache.Access(vertex);
+                }
+
+                emitted[triangle] = true;
+            }
+
+            // Prefer the candidate that was loaded longest ago but will still be resident after fanning around it.
+            uint32_t nextVertex = INVALID_INDEX;
+            int64_t bestPriority = -1;
+
+            for (uint32_t vertex : candidates) {
+                if (liveTriangles[vertex] == 0) {
+                    continue;
+                }
+
+                const int64_t age = static_cast<int64_t>(cache.Timestamp) - cache.LoadTimes[vertex];
+                const int64_t priority = age + 2 * static_cast<int64_t>(liveTriangles[vertex]) <= CACHE_SIZE ? age : 0;
+
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    nextVertex = vertex;
+                }
+            }
+
+            if (nextVertex == INVALID_INDEX) { // dead end, whatever comes next starts with a cold cache.
+                nextVertex = nextLiveVertex();
+                clusters.push_back(static_cast<uint32_t>(output.size() / 3));
+            }
+
+            fanningVertex = nextVertex;
+        }
+
+        // Every dead end opened a cluster, the first one starts at triangle 0 and the last one is empty.
+        clusters.pop_back();
+        clusters.insert(clusters.begin(), 0);
+        clusters.erase(std::unique(clusters.begin(), clusters.end()), clusters.end());
+
+        indices.swap(output);
+
+        return clusters;
+    }
+
+    void MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Model::Vertex>& vertices, const std::vector<uint32_t>& clusters) {
+        const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+        if (clusters.empty() || triangleCount == 0) {
+            return;
+        }
+
+        // Split the hard clusters wherever the running ACMR since the last split is within the threshold
+        // of the whole cluster, those splits cost next to nothing and give the sort more freedom.
+        std::vector<uint32_t> softClusters {};
+        CacheSimulator cache { vertices.size() };
+
+        for (size_t cluster = 0; cluster < clusters.size(); cluster++) {
+            const uint32_t begin = clusters[cluster];
+            const uint32_t end = cluster + 1 < clusters.size() ? clusters[cluster + 1] : triangleCount;
+
+            cache.Flush();
+            uint32_t clusterMisses = 0;
+
+            for (uint32_t triangle = begin; triangle < end; triangle++) {
+                for (uint32_t corner = 0; corner < 3; corner++) {
+                    clusterMisses += cache.Access(indices[3 * triangle + corner]) ? 1 : 0;
+                }
+            }
+
+            const float threshold = OVERDRAW_THRESHOLD * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+            cache.Flush();
+            softClusters.push_back(begin);
+
+            uint32_t start = begin;
+            uint32_t misses = 0;
+
+            for (uint32_t triangle = begin; triangle < end; triangle++) {
+                for (uint32_t corner = 0; corner < 3; corner++) {
+                    misses += cache.Access(indices[3 * triangle + corner]) ? 1 : 0;
+                }
+
+                if (triangle + 1 < end && static_cast<float>(misses) <= threshold * static_cast<float>(triangle + 1 - start)) {
+                    softClusters.push_back(triangle + 1);
+                    start = triangle + 1;
+                    misses = 0;
+                    cache.Flush();
+                }
+            }
+        }
+
+        glm::vec3 meshCentroid { 0.0f };
+
+        for (uint32_t index : indices) {
+            meshCentroid += vertices[index].Position;
+        }
+
+        meshCentroid /= static_cast<float>(indices.size());
+
+        // Clusters facing away from the mesh center go first, they are the ones most likely to occlude the rest.
+        std::vector<float> sortKeys(softClusters.size());
+
+        for (size_t cluster = 0; cluster < softClusters.size(); cluster++) {
+            const uint32_t begin = softClusters[cluster];
+            const uint32_t end = cluster + 1 < softClusters.size() ? softClusters[cluster + 1] : triangleCount;
+
+            glm::vec3 centroid { 0.0f };
+            glm::vec3 normal { 0.0f };
+            float area = 0.0f;
+
+            for (uint32_t triangle = begin; triangle < end; triangle++) {
+                const glm::vec3& a = vertices[indices[3 * triangle + 0]].Position;
+                const glm::vec3& b = vertices[indices[3 * triangle + 1]].Position;
+                const glm::vec3& c = vertices[indices[3 * triangle + 2]].Position;
+
+                const glm::vec3 triangleNormal = glm::cross(b - a, c - a);
+                const float triangleArea = glm::length(triangleNormal);
+
+                centroid += (a + b + c) * (triangleArea / 3.0f);
+                normal += triangleNormal;
+                area += triangleArea;
+            }
+
+            const float normalLength = glm::length(normal);
+
+            if (area <= 0.0f || normalLength <= 0.0f) {
+                sortKeys[cluster] = 0.0f;
+                continue;
+            }
+
+            sortKeys[cluster] = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+        }
+
+        std::vector<uint32_t> order(softClusters.size());
+
+        for (uint32_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+
+        std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+        std::vector<uint32_t> output {};
+        output.reserve(indices.size());
+
+        for (uint32_t cluster : order) {
+            const uint32_t begin = softClusters[cluster];
+            const uint32_t end = cluster + 1 < softClusters.size() ? softClusters[cluster + 1] : triangleCount;
+
+            output.insert(output.end(), indices.begin() + 3 * begin, indices.begin() + 3 * end);
+        }
+
+        indices.swap(output);
+    }
+
+    void MeshOptimizer::OptimizeVertexFetch(Model::Data& data) {
+        std::vector<uint32_t> remap(data.Vertices.size(), INVALID_INDEX);
+        std::vector<Model::Vertex> vertices {};
+        vertices.reserve(data.Vertices.size());
+
+        for (uint32_t& index : data.Indices) {
+            if (remap[index] == INVALID_INDEX) {
+                remap[index] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(data.Vertices[index]);
+            }
+
+            index = remap[index];
+        }
+
+        data.Vertices.swap(vertices);
+    }
+
+} // namespace Engine
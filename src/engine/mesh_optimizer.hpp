@@ -0,0 +1,40 @@
+#pragma once
+
+#include "model.hpp"
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+
+    // Post-import reordering of an indexed triangle list: triangles for the post-transform cache
+    // (Tipsify, Sander et al. 2007), clusters of them for less overdraw, then vertices for fetch locality.
+    // None of the steps change the rendered mesh, only the order things are stored in.
+    class MeshOptimizer {
+
+    public:
+        static constexpr uint32_t CACHE_SIZE = 16;        // FIFO entries assumed by the optimizer and the stats
+        static constexpr float OVERDRAW_THRESHOLD = 1.05f; // clusters are split where the running ACMR is within 5% of the whole cluster
+
+        struct CacheStats {
+            float ACMR { 0.0f }; // average cache miss ratio, transformed vertices per triangle (0.5 - 3.0)
+            float ATVR { 0.0f }; // average transform to vertex ratio, transformed vertices per unique vertex (1.0 is optimal)
+        };
+
+        // Runs every pass in order and logs the stats after each one.
+        static void Optimize(Model::Data& data);
+
+        static CacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount);
+
+        // Reorders triangles for cache locality, returns the first triangle of every cluster (hard boundaries, where the cache went cold).
+        static std::vector<uint32_t> OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+        // Sorts the clusters so outward facing ones are drawn first, clusters are split further where that is cheap for the cache.
+        static void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Model::Vertex>& vertices, const std::vector<uint32_t>& clusters);
+
+        // Renumbers and reorders the vertices by first use in the index buffer.
+        static void OptimizeVertexFetch(Model::Data& data);
+    };
+
+} // namespace Engine
@@ -0,0 +1,523 @@
+#include "mesh_simplifier.hpp"
+
+#include "mesh_optimizer.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace Engine {
+
+    constexpr uint32_t MAX_PASSES = 64;
+    constexpr float MIN_LOD_REDUCTION = 0.8f; // a LOD keeping more triangles than this (relative to the previous one) is not worth it
+    constexpr double BORDER_WEIGHT = 10.0;    // open edges are held in place by a plane perpendicular to their triangle
+
+    // Symmetric 4x4 quadric, error(p) is the weighted mean of the squared distances from p to the accumulated planes.
+    struct Quadric {
+        double A00 { 0.0 }, A11 { 0.0 }, A22 { 0.0 }, A01 { 0.0 }, A02 { 0.0 }, A12 { 0.0 };
+        double B0 { 0.0 }, B1 { 0.0 }, B2 { 0.0 };
+        double C { 0.0 };
+        double Weight { 0.0 };
+
+        static Quadric FromPlane(const glm::dvec3& normal, double distance, double weight) {
+            Quadric quadric {};
+            quadric.A00 = weight * normal.x * normal.x;
+            quadric.A11 = weight * normal.y * normal.y;
+            quadric.A22 = weight * normal.z * normal.z;
+            quadric.A01 = weight * normal.x * normal.y;
+            quadric.A02 = weight * normal.x * normal.z;
+            quadric.A12 = weight * normal.y * normal.z;
+            quadric.B0 = weight * normal.x * distance;
+            quadric.B1 = weight * normal.y * distance;
+            quadric.B2 = weight * normal.z * distance;
+            quadric.C = weight * distance * distance;
+            quadric.Weight = weight;
+
+            return quadric;
+        }
+
+        Quadric& operator+=(const Quadric& other) {
+            A00 += other.A00; A11 += other.A11; A22 += other.A22;
+            A01 += other.A01; A02 += other.A02; A12 += other.A12;
+            B0 += other.B0; B1 += other.B1; B2 += other.B2;
+            C += other.C;
+            Weight += other.Weight;
+
+            return *this;
+        }
+
+        double Error(const glm::dvec3& p) const {
+            const double error = A00 * p.x * p.x + A11 * p.y * p.y + A22 * p.z * p.z
+                               + 2.0 * (A01 * p.x * p.y + A02 * p.x * p.z + A12 * p.y * p.z)
+                               + 2.0 * (B0 * p.x + B1 * p.y + B2 * p.z)
+                               + C;
+
+            return Weight > 0.0 ? std::max(error, 0.0) / Weight : 0.0;
+        }
+    };
+
+    struct Collapse {
+        uint32_t From;
+        uint32_t To;
+        double Error;
+    };
+
+    // Closest point on a triangle (Ericson, Real-Time Collision Detection 5.1.5), returns the distance to it.
+    static double DistanceToTriangle(const glm::dvec3& p, const glm::dvec3& a, const glm::dvec3& b, const glm::dvec3& c) {
+        const glm::dvec3 ab = b - a;
+        const glm::dvec3 ac = c - a;
+        const glm::dvec3 ap = p - a;
+
+        const double d1 = glm::dot(ab, ap);
+        const double d2 = glm::dot(ac, ap);
+
+        if (d1 <= 0.0 && d2 <= 0.0) {
+            return glm::length(ap);
+        }
+
+        const glm::dvec3 bp = p - b;
+        const double d3 = glm::dot(ab, bp);
+        const double d4 = glm::dot(ac, bp);
+
+        if (d3 >= 0.0 && d4 <= d3) {
+            return glm::length(bp);
+        }
+
+        const double vc = d1 * d4 - d3 * d2;
+
+        if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+            return glm::length(p - (a + ab * (d1 / (d1 - d3))));
+        }
+
+        const glm::dvec3 cp = p - c;
+        const double d5 = glm::dot(ab, cp);
+        const double d6 = glm::dot(ac, cp);
+
+        if (d6 >= 0.0 && d5 <= d6) {
+            return glm::length(cp);
+        }
+
+        const double vb = d5 * d2 - d1 * d6;
+
+        if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+            return glm::length(p - (a + ac * (d2 / (d2 - d6))));
+        }
+
+        const double va = d3 * d6 - d5 * d4;
+
+        if (va <= 0.0 && d4 - d3 >= 0.0 && d5 - d6 >= 0.0) {
+            return glm::length(p - (b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)))));
+        }
+
+        const double denominator = 1.0 / (va + vb + vc);
+
+        return glm::length(p - (a + ab * (vb * denominator) + ac * (vc * denominator)));
+    }
+
+    static float AttributeDistance(const Model::Vertex& a, const Model::Vertex& b) {
+        const glm::vec3 normal = a.Normal - b.Normal;
+        const glm::vec3 color = a.Color - b.Color;
+        const glm::vec2 uv = a.UV - b.UV;
+
+        return glm::dot(normal, normal) + glm::dot(color, color) + glm::dot(uv, uv);
+    }
+
+    void MeshSimplifier::GenerateLods(Model::Data& data) {
+        data.Lods.clear();
+        data.Lods.push_back({ 0, static_cast<uint32_t>(data.Indices.size()), 0.0f });
+
+        std::vector<uint32_t> previous = data.Indices;
+        float previousError = 0.0f;
+
+        while (data.Lods.size() < MAX_LOD_COUNT) {
+            const size_t targetIndexCount = static_cast<size_t>(previous.size() / 3 * LOD_TRIANGLE_RATIO) * 3;
+
+            float error = 0.0f;
+            std::vector<uint32_t> lodIndices = Simplify(data.Vertices, previous, targetIndexCount, MAX_LOD_ERROR, error);
+
+            if (lodIndices.empty() || lodIndices.size() > previous.size() * MIN_LOD_REDUCTION) {
+                break;
+            }
+
+            MeshOptimizer::OptimizeVertexCache(lodIndices, data.Vertices.size());
+
+            // Every LOD is built from the one before it, so the errors add up.
+            previousError += error;
+
+            data.Lods.push_back({ static_cast<uint32_t>(data.Indices.size()), static_cast<uint32_t>(lodIndices.size()), previousError });
+            data.Indices.insert(data.Indices.end(), lodIndices.begin(), lodIndices.end());
+
+            previous.swap(lodIndices);
+        }
+
+        std::cout << "Generated " << data.Lods.size() << " LODs:";
+
+        for (const auto& lod : data.Lods) {
+            std::cout << ' ' << lod.IndexCount / 3 << " tris (error " << lod.Error << ')';
+        }
+
+        std::cout << std::endl;
+    }
+
+    std::vector<uint32_t> MeshSimplifier::Simplify(const std::vector<Model::Vertex>& vertices, const std::vector<uint32_t>& indices,
+                                                   size_t targetIndexCount, float maxError, float& resultError)
+    {
+        resultError = 0.0f;
+
+        const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+
+        // Weld by position, vertices that only differ in normal/uv/color (seams) collapse as one.
+        std::vector<uint32_t> sortedVertices(vertexCount);
+
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            sortedVertices[i] = i;
+        }
+
+        std::sort(sortedVertices.begin(), sortedVertices.end(), [&vertices](uint32_t a, uint32_t b) {
+            return std::memcmp(&vertices[a].Position, &vertices[b].Position, sizeof(glm::vec3)) < 0;
+        });
+
+        std::vector<uint32_t> groupOf(vertexCount);
+        std::vector<uint32_t> groupOffsets {};
+        std::vector<glm::dvec3> groupPositions {};
+
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            const uint32_t vertex = sortedVertices[i];
+
+            if (i == 0 || std::memcmp(&vertices[vertex].Position, &vertices[sortedVertices[i - 1]].Position, sizeof(glm::vec3)) != 0) {
+                groupOffsets.push_back(i);
+                groupPositions.push_back(glm::dvec3 { vertices[vertex].Position });
+            }
+
+            groupOf[vertex] = static_cast<uint32_t>(groupPositions.size() - 1);
+        }
+
+        groupOffsets.push_back(vertexCount);
+
+        const uint32_t groupCount = static_cast<uint32_t>(groupPositions.size());
+
+        if (groupCount == 0 || indices.size() < 3) {
+            return indices;
+        }
+
+        glm::dvec3 boundsMin { groupPositions[0] };
+        glm::dvec3 boundsMax { groupPositions[0] };
+
+        for (const auto& position : groupPositions) {
+            boundsMin = glm::min(boundsMin, position);
+            boundsMax = glm::max(boundsMax, position);
+        }
+
+        const double diagonal = std::max(glm::length(boundsMax - boundsMin), 1e-12);
+        const double maxQuadricError = static_cast<double>(maxError) * maxError * diagonal * diagonal;
+
+        // Triangles as position groups, corners keep the original vertex so attributes can be picked back up at the end.
+        std::vector<uint32_t> triangles {};
+        std::vector<uint32_t> corners {};
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const uint32_t a = groupOf[indices[i + 0]];
+            const uint32_t b = groupOf[indices[i + 1]];
+            const uint32_t c = groupOf[indices[i + 2]];
+
+            if (a == b || b == c || c == a) {
+                continue;
+            }
+
+            triangles.insert(triangles.end(), { a, b, c });
+            corners.insert(corners.end(), { indices[i + 0], indices[i + 1], indices[i + 2] });
+        }
+
+        std::vector<Quadric> quadrics(groupCount);
+
+        for (size_t i = 0; i < triangles.size(); i += 3) {
+            const glm::dvec3& p0 = groupPositions[triangles[i + 0]];
+            const glm::dvec3 normal = glm::cross(groupPositions[triangles[i + 1]] - p0, groupPositions[triangles[i + 2]] - p0);
+            const double area = glm::length(normal);
+
+            if (area <= 0.0) {
+                continue;
+            }
+
+            const glm::dvec3 unitNormal = normal / area;
+            const Quadric quadric = Quadric::FromPlane(unitNormal, -glm::dot(unitNormal, p0), area * 0.5);
+
+            for (size_t corner = 0; corner < 3; corner++) {
+                quadrics[triangles[i + corner]] += quadric;
+            }
+        }
+
+        // Open edges only appear once, an edge shared by two triangles shows up in both directions.
+        {
+            std::vector<std::pair<uint64_t, uint32_t>> edges {}; // (from << 32 | to, triangle)
+            edges.reserve(triangles.size());
+
+            for (size_t i = 0; i < triangles.size(); i += 3) {
+                for (size_t corner = 0; corner < 3; corner++) {
+                    const uint64_t from = triangles[i + corner];
+                    const uint64_t to = triangles[i + (corner + 1) % 3];
+                    edges.push_back({ (from << 32) | to, static_cast<uint32_t>(i / 3) });
+                }
+            }
+
+            std::sort(edges.begin(), edges.end());
+
+            for (const auto& edge : edges) {
+                const uint32_t from = static_cast<uint32_t>(edge.first >> 32);
+                const uint32_t to = static_cast<uint32_t>(edge.first & 0xffffffff);
+                const uint64_t reversed = (static_cast<uint64_t>(to) << 32) | from;
+
+                if (std::binary_search(edges.begin(), edges.end(), std::make_pair(reversed, 0u),
+                                       [](const auto& a, const auto& b) { return a.first < b.first; }))
+                {
+                    continue;
+                }
+
+                const uint32_t* triangle = &triangles[3 * edge.second];
+                const glm::dvec3& p0 = groupPositions[triangle[0]];
+                const glm::dvec3 faceNormal = glm::cross(groupPositions[triangle[1]] - p0, groupPositions[triangle[2]] - p0);
+                const glm::dvec3 edgeVector = groupPositions[to] - groupPositions[from];
+                const glm::dvec3 borderNormal = glm::cross(edgeVector, faceNormal);
+                const double length = glm::length(borderNormal);
+
+                if (length <= 0.0) {
+                    continue;
+                }
+
+                const glm::dvec3 unitNormal = borderNormal / length;
+                const Quadric quadric = Quadric::FromPlane(unitNormal, -glm::dot(unitNormal, groupPositions[from]), BORDER_WEIGHT * glm::dot(edgeVector, edgeVector));
+
+                quadrics[from] += quadric;
+                quadrics[to] += quadric;
+            }
+        }
+
+        std::vector<uint32_t> adjacencyOffsets(groupCount + 1);
+        std::vector<uint32_t> adjacency {};
+        std::vector<Collapse> collapses {};
+        std::vector<uint32_t> remap(groupCount);
+        std::vector<bool> locked(groupCount);
+        std::vector<uint32_t> collapsedInto(groupCount);
+
+        for (uint32_t group = 0; group < groupCount; group++) {
+            collapsedInto[group] = group;
+        }
+
+        size_t triangleCount = triangles.size() / 3;
+        const size_t targetTriangleCount = targetIndexCount / 3;
+
+        for (uint32_t pass = 0; pass < MAX_PASSES && triangleCount > targetTriangleCount; pass++) {
+            // Group -> triangle adjacency for this pass.
+            std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+
+            for (uint32_t group : triangles) {
+                adjacencyOffsets[group + 1]++;
+            }
+
+            for (uint32_t group = 0; group < groupCount; group++) {
+                adjacencyOffsets[group + 1] += adjacencyOffsets[group];
+            }
+
+            adjacency.resize(triangles.size());
+
+            {
+                std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+                for (size_t i = 0; i < triangles.size(); i++) {
+                    adjacency[cursors[triangles[i]]++] = static_cast<uint32_t>(i / 3);
+                }
+            }
+
+            // Every edge is a candidate in both directions, collapsing From onto To.
+            collapses.clear();
+
+            auto collapseError = [&](uint32_t from, uint32_t to) {
+                Quadric merged = quadrics[from];
+                merged += quadrics[to];
+
+                return merged.Error(groupPositions[to]);
+            };
+
+            for (size_t i = 0; i < triangles.size(); i += 3) {
+                for (size_t corner = 0; corner < 3; corner++) {
+                    const uint32_t a = triangles[i + corner];
+                    const uint32_t b = triangles[i + (corner + 1) % 3];
+
+                    collapses.push_back({ a, b, collapseError(a, b) });
+                    collapses.push_back({ b, a, collapseError(b, a) });
+                }
+            }
+
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Error < b.Error; });
+
+            for (uint32_t group = 0; group < groupCount; group++) {
+                remap[group] = group;
+            }
+
+            std::fill(locked.begin(), locked.end(), false);
+
+            size_t collapsedCount = 0;
+
+            for (const Collapse& collapse : collapses) {
+                if (collapse.Error > maxQuadricError || triangleCount <= targetTriangleCount) {
+                    break;
+                }
+
+                if (locked[collapse.From] || locked[collapse.To]) {
+                    continue;
+                }
+
+                // Reject collapses that flip a surviving triangle.
+                bool flips = false;
+                size_t removedTriangles = 0;
+
+                for (uint32_t i = adjacencyOffsets[collapse.From]; i < adjacencyOffsets[collapse.From + 1] && !flips; i++) {
+                    const uint32_t* triangle = &triangles[3 * adjacency[i]];
+
+                    if (triangle[0] == collapse.To || triangle[1] == collapse.To || triangle[2] == collapse.To) {
+                        removedTriangles++;
+                        continue;
+                    }
+
+                    glm::dvec3 before[3];
+                    glm::dvec3 after[3];
+
+                    for (int corner = 0; corner < 3; corner++) {
+                        before[corner] = groupPositions[triangle[corner]];
+                        after[corner] = triangle[corner] == collapse.From ? groupPositions[collapse.To] : before[corner];
+                    }
+
+                    const glm::dvec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                    const glm::dvec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+                    flips = glm::dot(normalBefore, normalAfter) <= 0.0;
+                }
+
+                if (flips) {
+                    continue;
+                }
+
+                // Lock the whole one ring, the adjacency of this pass is stale around it from now on.
+                for (uint32_t i = adjacencyOffsets[collapse.From]; i < adjacencyOffsets[collapse.From + 1]; i++) {
+                    const uint32_t* triangle = &triangles[3 * adjacency[i]];
+                    locked[triangle[0]] = locked[triangle[1]] = locked[triangle[2]] = true;
+                }
+
+                remap[collapse.From] = collapse.To;
+                collapsedInto[collapse.From] = collapse.To;
+                quadrics[collapse.To] += quadrics[collapse.From];
+
+                triangleCount -= removedTriangles;
+                collapsedCount++;
+            }
+
+            if (collapsedCount == 0) {
+                break;
+            }
+
+            size_t writeIndex = 0;
+
+            for (size_t i = 0; i < triangles.size(); i += 3) {
+                const uint32_t a = remap[triangles[i + 0]];
+                const uint32_t b = remap[triangles[i + 1]];
+                const uint32_t c = remap[triangles[i + 2]];
+
+                if (a == b || b == c || c == a) {
+                    continue;
+                }
+
+                triangles[writeIndex + 0] = a;
+                triangles[writeIndex + 1] = b;
+                triangles[writeIndex + 2] = c;
+
+                std::copy(corners.begin() + i, corners.begin() + i + 3, corners.begin() + writeIndex);
+                writeIndex += 3;
+            }
+
+            triangles.resize(writeIndex);
+            corners.resize(writeIndex);
+            triangleCount = writeIndex / 3;
+        }
+
+        // The quadric error is a weighted mean and underestimates the worst spot, so measure instead: every
+        // removed position against the final triangles around the vertex it ended up in.
+        {
+            std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+
+            for (uint32_t group : triangles) {
+                adjacencyOffsets[group + 1]++;
+            }
+
+            for (uint32_t group = 0; group < groupCount; group++) {
+                adjacencyOffsets[group + 1] += adjacencyOffsets[group];
+            }
+
+            adjacency.resize(triangles.size());
+            std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+            for (size_t i = 0; i < triangles.size(); i++) {
+                adjacency[cursors[triangles[i]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        double largestError = 0.0;
+
+        for (uint32_t group = 0; group < groupCount; group++) {
+            uint32_t target = group;
+
+            while (collapsedInto[target] != target) {
+                target = collapsedInto[target];
+            }
+
+            collapsedInto[group] = target;
+
+            if (target == group || adjacencyOffsets[target] == adjacencyOffsets[target + 1]) {
+                continue;
+            }
+
+            double distance = std::numeric_limits<double>::max();
+
+            for (uint32_t i = adjacencyOffsets[target]; i < adjacencyOffsets[target + 1]; i++) {
+                const uint32_t* triangle = &triangles[3 * adjacency[i]];
+                distance = std::min(distance, DistanceToTriangle(groupPositions[group], groupPositions[triangle[0]], groupPositions[triangle[1]], groupPositions[triangle[2]]));
+            }
+
+            largestError = std::max(largestError, distance);
+        }
+
+        // Back to real vertices, a corner that moved takes the vertex of its new position whose attributes are closest.
+        std::vector<uint32_t> result(triangles.size());
+
+        for (size_t i = 0; i < triangles.size(); i++) {
+            const uint32_t original = corners[i];
+            const uint32_t group = triangles[i];
+
+            if (groupOf[original] == group) {
+                result[i] = original;
+                continue;
+            }
+
+            uint32_t best = sortedVertices[groupOffsets[group]];
+            float bestDistance = AttributeDistance(vertices[original], vertices[best]);
+
+            for (uint32_t member = groupOffsets[group] + 1; member < groupOffsets[group + 1]; member++) {
+                const float distance = AttributeDistance(vertices[original], vertices[sortedVertices[member]]);
+
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = sortedVertices[member];
+                }
+            }
+
+            result[i] = best;
+        }
+
+        resultError = static_cast<float>(largestError / diagonal);
+
+        return result;
+    }
+
+} // namespace Engine
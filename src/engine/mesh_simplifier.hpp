@@ -0,0 +1,30 @@
+#pragma once
+
+#include "model.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+
+    // Quadric error edge collapse (Garland & Heckbert 1997). Vertices only ever collapse onto a neighbour,
+    // so every LOD indexes the original vertex buffer and the whole chain shares one allocation.
+    class MeshSimplifier {
+
+    public:
+        static constexpr uint32_t MAX_LOD_COUNT = 5;     // including the full detail mesh
+        static constexpr float LOD_TRIANGLE_RATIO = 0.5f; // triangles each LOD aims for, relative to the previous one
+        static constexpr float MAX_LOD_ERROR = 0.05f;     // relative to the mesh diagonal
+
+        // Appends the LOD chain to data.Indices and fills data.Lods, LOD 0 is the current index buffer.
+        static void GenerateLods(Model::Data& data);
+
+        // Collapses edges until the index count reaches targetIndexCount or the next collapse would move the
+        // surface by more than maxError (relative to the mesh diagonal). resultError receives the measured deviation, same units.
+        static std::vector<uint32_t> Simplify(const std::vector<Model::Vertex>& vertices, const std::vector<uint32_t>& indices,
+                                              size_t targetIndexCount, float maxError, float& resultError);
+    };
+
+} // namespace Engine
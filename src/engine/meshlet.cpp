@@ -0,0 +1,168 @@
+#include "meshlet.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Engine {
+
+    // Normal cones wider than this (cos of the half angle) are not worth testing, some face will always look at the camera.
+    constexpr float MIN_CONE_SPREAD = 0.1f;
+
+    static void ComputeBounds(Meshlet& meshlet, const void* positions, size_t positionStride, const uint32_t* indices) {
+        auto position = [&](uint32_t vertex) {
+            glm::vec3 result;
+            std::memcpy(&result, static_cast<const uint8_t*>(positions) + static_cast<size_t>(vertex) * positionStride, sizeof(glm::vec3));
+
+            return result;
+        };
+
+        const uint32_t* begin = indices + meshlet.FirstIndex;
+        const uint32_t* end = begin + meshlet.IndexCount;
+
+        glm::vec3 boundsMin { position(*begin) };
+        glm::vec3 boundsMax { boundsMin };
+
+        for (const uint32_t* index = begin; index != end; index++) {
+            boundsMin = glm::min(boundsMin, position(*index));
+            boundsMax = glm::max(boundsMax, position(*index));
+        }
+
+        meshlet.Center = (boundsMin + boundsMax) * 0.5f;
+        meshlet.Radius = 0.0f;
+
+        for (const uint32_t* index = begin; index != end; index++) {
+            meshlet.Radius = std::max(meshlet.Radius, glm::length(position(*index) - meshlet.Center));
+        }
+
+        // Normal cone, axis is the average face normal and the spread is set by the face furthest away from it.
+        std::vector<glm::vec3> normals {};
+        normals.reserve(meshlet.IndexCount / 3);
+
+        glm::vec3 normalSum { 0.0f };
+
+        for (const uint32_t* index = begin; index + 2 < end; index += 3) {
+            const glm::vec3 a = position(index[0]);
+            const glm::vec3 normal = glm::cross(position(index[1]) - a, position(index[2]) - a);
+            const float length = glm::length(normal);
+
+            if (length > 0.0f) { // degenerate triangles face nowhere
+                normals.push_back(normal / length);
+                normalSum += normals.back();
+            }
+        }
+
+        meshlet.ConeAxis = glm::vec3 { 0.0f, 0.0f, 1.0f };
+        meshlet.ConeCutoff = 1.0f;
+
+        const float axisLength = glm::length(normalSum);
+
+        if (normals.empty() || axisLength <= 0.0f) {
+            return;
+        }
+
+        meshlet.ConeAxis = normalSum / axisLength;
+
+        float minDot = 1.0f;
+
+        for (const glm::vec3& normal : normals) {
+            minDot = std::min(minDot, glm::dot(normal, meshlet.ConeAxis));
+        }
+
+        if (minDot > MIN_CONE_SPREAD) {
+            meshlet.ConeCutoff = std::sqrt(1.0f - minDot * minDot);
+        }
+    }
+
+    std::vector<Meshlet> Meshlet::Build(const void* positions, size_t positionStride, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount) {
+        std::vector<Meshlet> meshlets {};
+
+        // Id of the last meshlet that referenced each vertex, so membership is a single compare.
+        std::vector<uint32_t> lastMeshlet(vertexCount, UINT32_MAX);
+
+        Meshlet current {};
+        uint32_t currentVertexCount = 0;
+
+        auto countNewVertices = [&](const uint32_t* triangle, uint32_t meshletId) {
+            uint32_t count = 0;
+
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                const bool repeated = (corner > 0 && triangle[corner] == triangle[0]) || (corner > 1 && triangle[corner] == triangle[1]);
+                count += (lastMeshlet[triangle[corner]] != meshletId && !repeated) ? 1 : 0;
+            }
+
+            return count;
+        };
+
+        for (uint32_t first = 0; first + 2 < indexCount; first += 3) {
+            const uint32_t* triangle = indices + first;
+            uint32_t meshletId = static_cast<uint32_t>(meshlets.size());
+            uint32_t newVertices = countNewVertices(triangle, meshletId);
+
+            if (current.IndexCount / 3 == MAX_TRIANGLES || currentVertexCount + newVertices > MAX_VERTICES) {
+                meshlets.push_back(current);
+
+                current = Meshlet {};
+                current.FirstIndex = first;
+                currentVertexCount = 0;
+
+                meshletId++;
+                newVertices = countNewVertices(triangle, meshletId);
+            }
+
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                lastMeshlet[triangle[corner]] = meshletId;
+            }
+
+            current.IndexCount += 3;
+            currentVertexCount += newVertices;
+        }
+
+        if (current.IndexCount > 0) {
+            meshlets.push_back(current);
+        }
+
+        for (Meshlet& meshlet : meshlets) {
+            ComputeBounds(meshlet, positions, positionStride, indices);
+        }
+
+        return meshlets;
+    }
+
+    bool Meshlet::IsBackfacing(const glm::vec3& cameraPosition) const {
+        // Every face is turned away when the view direction to the sphere stays inside the cone mirrored
+        // through the surface, the radius makes it hold for any point of the sphere.
+        const glm::vec3 toCenter = Center - cameraPosition;
+
+        return glm::dot(toCenter, ConeAxis) >= ConeCutoff * glm::length(toCenter) + Radius;
+    }
+
+    void Meshlet::Cull(const std::vector<Meshlet>& meshlets, const Frustum& frustum, const glm::vec3& cameraPosition, bool coneCulling,
+                       std::vector<DrawRange>& visibleRanges)
+    {
+        const size_t firstRange = visibleRanges.size();
+
+        for (const Meshlet& meshlet : meshlets) {
+            if (!frustum.IntersectsSphere(meshlet.Center, meshlet.Radius)) {
+                continue;
+            }
+
+            if (coneCulling && meshlet.IsBackfacing(cameraPosition)) {
+                continue;
+            }
+
+            if (visibleRanges.size() > firstRange) {
+                DrawRange& last = visibleRanges.back();
+
+                if (last.FirstIndex + last.IndexCount == meshlet.FirstIndex) {
+                    last.IndexCount += meshlet.IndexCount;
+                    continue;
+                }
+            }
+
+            visibleRanges.push_back({ meshlet.FirstIndex, meshlet.IndexCount });
+        }
+    }
+
+} // namespace Engine
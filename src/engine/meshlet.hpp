@@ -0,0 +1,43 @@
+#pragma once
+
+#include "frustum.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+
+    // A run of consecutive triangles in a model's index buffer, small enough to be culled as one unit.
+    struct Meshlet {
+        static constexpr uint32_t MAX_VERTICES = 64;
+        static constexpr uint32_t MAX_TRIANGLES = 124;
+
+        struct DrawRange {
+            uint32_t FirstIndex;
+            uint32_t IndexCount;
+        };
+
+        uint32_t FirstIndex { 0 };
+        uint32_t IndexCount { 0 };
+
+        glm::vec3 Center { 0.0f }; // bounding sphere, model space
+        float Radius { 0.0f };
+
+        glm::vec3 ConeAxis { 0.0f, 0.0f, 1.0f }; // average face normal
+        float ConeCutoff { 1.0f };                // sine of the normal cone half angle, 1 when the cluster can always face the camera
+
+        // Splits the index buffer greedily, a meshlet is closed once one more triangle would break a limit.
+        // Positions are read as glm::vec3 every positionStride bytes.
+        static std::vector<Meshlet> Build(const void* positions, size_t positionStride, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+
+        // Appends the index ranges of the visible meshlets to visibleRanges, merging neighbours into one range.
+        // Frustum and camera position must be in model space. The cone test assumes back faces are culled.
+        static void Cull(const std::vector<Meshlet>& meshlets, const Frustum& frustum, const glm::vec3& cameraPosition, bool coneCulling,
+                         std::vector<DrawRange>& visibleRanges);
+
+        bool IsBackfacing(const glm::vec3& cameraPosition) const;
+    };
+
+} // namespace Engine
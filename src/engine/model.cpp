@@ -1,137 +1,253 @@
 #include "model.hpp"
 
-#include "utils.hpp"
+#include "gltf_loader.hpp"
+#include "mesh_cache.hpp"
+#include "mesh_optimizer.hpp"
+#include "mesh_simplifier.hpp"
+#include "obj_loader.hpp"
+#include "vertex_welder.hpp"
 
 // libs
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tinyobj/tiny_obj_loader.h>
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 
 // std
 #include <stdexcept>
 #include <cassert>
+#include <cmath>
 #include <cstring>
-#include <unordered_map>
+#include <iostream>
+#include <limits>
 
-namespace std {
+namespace Engine {
 
-    template<>
-    struct hash<Engine::Model::Vertex> {
-        size_t operator()(const Engine::Model::Vertex& vertex) const {
-            size_t seed = 0;
-            Engine::hashCombine(seed, vertex.Position, vertex.Color, vertex.UV);
+    static_assert(sizeof(Model::PackedVertex) == 20, "Model::PackedVertex must match the attribute layout of sh_diffuse_packed.vert");
 
-            return seed;
-        }
-    };
-    
-} // namespace std
+    static bool IsGlbFile(const std::string& filepath) {
+        return filepath.size() >= 4 && (filepath.compare(filepath.size() - 4, 4, ".glb") == 0 || filepath.compare(filepath.size() - 4, 4, ".GLB") == 0);
+    }
 
+    // Octahedral normal encoding, the sphere is folded onto the z >= 0 half of an octahedron and flattened to xy.
+    static void EncodeOctahedral(const glm::vec3& normal, int16_t (&encoded)[2]) {
+        const float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
 
-namespace Engine {
+        glm::vec2 octahedral { 0.0f };
+
+        if (length > 0.0f) {
+            octahedral = glm::vec2 { normal.x, normal.y } / length;
+
+            if (normal.z < 0.0f) {
+                octahedral = glm::vec2 {
+                    (1.0f - std::fabs(octahedral.y)) * (octahedral.x >= 0.0f ? 1.0f : -1.0f),
+                    (1.0f - std::fabs(octahedral.x)) * (octahedral.y >= 0.0f ? 1.0f : -1.0f)
+                };
+            }
+        }
+
+        const uint32_t packed = glm::packSnorm2x16(octahedral);
+        encoded[0] = static_cast<int16_t>(packed & 0xffff);
+        encoded[1] = static_cast<int16_t>(packed >> 16);
+    }
     
-    Model::Model(Device &device, const Data& data)
-        : _device(device)
+    Model::Model(GeometryPool& geometryPool, const Data& data, VertexFormat vertexFormat)
+        : Model(geometryPool, data.Vertices.data(), static_cast<uint32_t>(data.Vertices.size()), data.Indices.data(), static_cast<uint32_t>(data.Indices.size()), data.Lods, vertexFormat)
+    {
+    }
+
+    Model::Model(GeometryPool& geometryPool, const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, const std::vector<Lod>& lods,
+                 VertexFormat vertexFormat)
+        : _geometryPool(geometryPool), _vertexFormat(vertexFormat), _lods(lods)
     {
-        CreateVertexBuffers(data.Vertices);
-        CreateIndexBuffer(data.Indices);
+        CreateBuffers(vertices, vertexCount, indices, indexCount);
+
+        if (_lods.empty()) {
+            _lods.push_back({ 0, indexCount, 0.0f });
+        }
+
+        glm::vec3 boundsMin { vertexCount > 0 ? vertices[0].Position : glm::vec3 { 0.0f } };
+        glm::vec3 boundsMax { boundsMin };
+
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            boundsMin = glm::min(boundsMin, vertices[i].Position);
+            boundsMax = glm::max(boundsMax, vertices[i].Position);
+        }
+
+        _boundsCenter = (boundsMin + boundsMax) * 0.5f;
+        _boundsRadius = glm::length(boundsMax - boundsMin) * 0.5f;
+
+        _lodMeshlets.resize(_lods.size());
+
+        for (size_t lod = 0; lod < _lods.size() && _hasIndexBuffer; lod++) {
+            const uint32_t firstIndex = _lods[lod].FirstIndex;
+            _lodMeshlets[lod] = Meshlet::Build(&vertices[0].Position, sizeof(Vertex), vertexCount, indices + firstIndex, _lods[lod].IndexCount);
+
+            for (auto& meshlet : _lodMeshlets[lod]) {
+                meshlet.FirstIndex += firstIndex;
+            }
+        }
     }
 
     Model::~Model() 
     {
+        if (_allocation != GeometryPool::INVALID_ALLOCATION) {
+            _geometryPool.Free(_allocation);
+        }
     }
 
-    std::unique_ptr<Model> Model::CreateModelFromFile(Device &device, const std::string filepath) {
+    std::unique_ptr<Model> Model::CreateModelFromFile(GeometryPool& geometryPool, const std::string filepath, VertexFormat vertexFormat) {
+        MeshCache cache { filepath };
+
+        return CreateModelFromFile(geometryPool, filepath, cache, vertexFormat);
+    }
+
+    std::unique_ptr<Model> Model::CreateModelFromFile(GeometryPool& geometryPool, const std::string& filepath, MeshCache& cache, VertexFormat vertexFormat) {
+        if (cache.IsValid()) { // the mapped arrays go straight into the staging buffers.
+            return std::make_unique<Model>(geometryPool, cache.GetVertices(), cache.GetVertexCount(), cache.GetIndices(), cache.GetIndexCount(), cache.GetLods(), vertexFormat);
+        }
+
+        return std::make_unique<Model>(geometryPool, ImportData(filepath, cache), vertexFormat);
+    }
+
+    std::unique_ptr<Model> Model::CreateModelFromMesh(GeometryPool& geometryPool, Data& data, MeshCache& cache, VertexFormat vertexFormat) {
+        if (cache.IsValid()) {
+            return std::make_unique<Model>(geometryPool, cache.GetVertices(), cache.GetVertexCount(), cache.GetIndices(), cache.GetIndexCount(), cache.GetLods(), vertexFormat);
+        }
+
+        ProcessData(data, cache);
+
+        return std::make_unique<Model>(geometryPool, data, vertexFormat);
+    }
+
+    Model::Data Model::LoadDataFromFile(const std::string& filepath) {
+        MeshCache cache { filepath };
+
+        if (!cache.IsValid()) {
+            return ImportData(filepath, cache);
+        }
+
+        Data data {};
+        data.Vertices.assign(cache.GetVertices(), cache.GetVertices() + cache.GetVertexCount());
+        data.Indices.assign(cache.GetIndices(), cache.GetIndices() + cache.GetIndexCount());
+        data.Lods = cache.GetLods();
+
+        return data;
+    }
+
+    Model::Data Model::ImportData(const std::string& filepath, MeshCache& cache) {
         Data data {};
         data.LoadModel(filepath);
+        ProcessData(data, cache);
 
-        return std::make_unique<Model>(device, data);
+        return data;
     }
 
-    void Model::Bind(VkCommandBuffer commandBuffer) {
-        VkBuffer buffers[] = { _vertexBuffer->getBuffer() };
-        VkDeviceSize offsets[] = { 0 };
+    void Model::ProcessData(Data& data, MeshCache& cache) {
+        MeshOptimizer::Optimize(data);
+        MeshSimplifier::GenerateLods(data);
+        cache.Write(data);
+    }
 
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+    VkDeviceSize Model::EstimateMemorySize(const Data& data, VertexFormat vertexFormat) {
+        const VkDeviceSize vertexSize = vertexFormat == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+        const VkDeviceSize indexSize = data.Vertices.size() <= 65536 ? sizeof(uint16_t) : sizeof(uint32_t);
 
-        if (_hasIndexBuffer) {
-            // uint16 = 65,535 vertices
-            // uint32 = 4,294,967,295 vertices
-            vkCmdBindIndexBuffer(commandBuffer, _indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
-        }
+        return vertexSize * data.Vertices.size() + indexSize * data.Indices.size();
+    }
+
+    void Model::Bind(VkCommandBuffer commandBuffer) {
+        _geometryPool.Bind(commandBuffer, _allocation);
     }
 
     void Model::Draw(VkCommandBuffer commandBuffer) {
+        const auto& region = _geometryPool.GetRegion(_allocation);
+
         if (_hasIndexBuffer) {
-            vkCmdDrawIndexed(commandBuffer, _indexCount, 1, 0, 0, 0);
+            vkCmdDrawIndexed(commandBuffer, _indexCount, 1, region.FirstIndex, static_cast<int32_t>(region.VertexOffset), 0);
         }
         else {
-            vkCmdDraw(commandBuffer, _vertexCount, 1, 0, 0);
+            vkCmdDraw(commandBuffer, _vertexCount, 1, region.VertexOffset, 0);
         }
     }
 
-    void Model::CreateVertexBuffers(const std::vector<Vertex> &vertices) {
-        _vertexCount = static_cast<uint32_t>(vertices.size());
+    void Model::Draw(VkCommandBuffer commandBuffer, const Meshlet::DrawRange* ranges, uint32_t rangeCount) {
+        assert(_hasIndexBuffer && "Cannot draw index ranges of a model without index buffer.");
+
+        const auto& region = _geometryPool.GetRegion(_allocation);
+
+        for (uint32_t i = 0; i < rangeCount; i++) {
+            vkCmdDrawIndexed(commandBuffer, ranges[i].IndexCount, 1, region.FirstIndex + ranges[i].FirstIndex, static_cast<int32_t>(region.VertexOffset), 0);
+        }
+    }
+
+    void Model::CreateBuffers(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount) {
+        _vertexCount = vertexCount;
+        _indexCount = indexCount;
+        _hasIndexBuffer = _indexCount > 0;
 
         assert(_vertexCount >= 3 && "Vertex count must be at least 3");
 
-        VkDeviceSize vertexBufferSize = sizeof(vertices[0]) * _vertexCount;
-        uint32_t vertexSize = sizeof(vertices[0]);
+        std::vector<PackedVertex> packedVertices {};
+
+        if (_vertexFormat == VertexFormat::Packed) {
+            PackVertices(vertices, vertexCount, packedVertices);
+        }
+
+        const void* vertexData = packedVertices.empty() ? static_cast<const void*>(vertices) : packedVertices.data();
+        const uint32_t vertexSize = packedVertices.empty() ? sizeof(Vertex) : sizeof(PackedVertex);
 
-        VulkanBuffer stagingBuffer {
-            _device,
-            vertexSize,
-            _vertexCount,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, // HOST = CPU, DEVICE = GPU, 1st property makes memory accesible from cpu, 2nd property keeps the cpu and gpu regions consistent (or updated) with each other, if this property is abstent, then we are required to call VkFlushMapMemoryRanges() in order to propagate changes from cpu to gpu.
-        };
+        // Indices are relative to the vertexOffset of the pool allocation, so every model with up to 65536 vertices fits 16 bits
+        // (there is no primitive restart to reserve 0xffff for).
+        std::vector<uint16_t> shortIndices {};
 
-        stagingBuffer.map();
-        stagingBuffer.writeToBuffer((void*) vertices.data());
+        if (_hasIndexBuffer && _vertexCount <= 65536) {
+            shortIndices.assign(indices, indices + _indexCount);
+            _indexType = VK_INDEX_TYPE_UINT16;
+        }
 
-        _vertexBuffer = std::make_unique<VulkanBuffer> (
-            _device,
-            vertexSize,
-            _vertexCount,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-        );
+        const void* indexData = shortIndices.empty() ? static_cast<const void*>(indices) : shortIndices.data();
+        const uint32_t indexSize = shortIndices.empty() ? sizeof(uint32_t) : sizeof(uint16_t);
 
-        _device.copyBuffer(stagingBuffer.getBuffer(), _vertexBuffer->getBuffer(), vertexBufferSize);
+        _allocation = _geometryPool.Allocate(vertexData, vertexSize, _vertexCount, indexData, _indexType, _indexCount);
+        _memorySize = static_cast<VkDeviceSize>(vertexSize) * _vertexCount + static_cast<VkDeviceSize>(indexSize) * _indexCount;
     }
 
-    void Model::CreateIndexBuffer(const std::vector<uint32_t> &indices) {
-        _indexCount = static_cast<uint32_t>(indices.size());
-        _hasIndexBuffer = _indexCount > 0;
+    void Model::PackVertices(const Vertex* vertices, uint32_t vertexCount, std::vector<PackedVertex>& packedVertices) {
+        glm::vec3 boundsMin { vertexCount > 0 ? vertices[0].Position : glm::vec3 { 0.0f } };
+        glm::vec3 boundsMax { boundsMin };
 
-        if (!_hasIndexBuffer) {
-            return;
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            boundsMin = glm::min(boundsMin, vertices[i].Position);
+            boundsMax = glm::max(boundsMax, vertices[i].Position);
         }
 
-        VkDeviceSize indexBufferSize = sizeof(indices[0]) * _indexCount;
-        uint32_t indexSize = sizeof(indices[0]);
+        // Flat axes get a tiny extent so nothing divides by zero, every vertex quantizes to 0 on them anyway.
+        const glm::vec3 extent = glm::max(boundsMax - boundsMin, glm::vec3 { std::numeric_limits<float>::min() });
+        _dequantizationMatrix = glm::scale(glm::translate(glm::mat4 { 1.0f }, boundsMin), extent);
+
+        packedVertices.resize(vertexCount);
 
-        VulkanBuffer stagingBuffer {
-            _device,
-            indexSize,
-            _indexCount,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, // HOST = CPU, DEVICE = GPU, 1st property makes memory accesible from cpu, 2nd property keeps the cpu and gpu regions consistent (or updated) with each other, if this property is abstent, then we are required to call VkFlushMapMemoryRanges() in order to propagate changes from cpu to gpu.
-        };
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            const Vertex& vertex = vertices[i];
+            PackedVertex& packed = packedVertices[i];
 
-        stagingBuffer.map();
-        stagingBuffer.writeToBuffer((void*) indices.data());
+            const glm::vec3 normalized = glm::clamp((vertex.Position - boundsMin) / extent, 0.0f, 1.0f);
+
+            for (int axis = 0; axis < 3; axis++) {
+                packed.Position[axis] = static_cast<uint16_t>(std::lround(normalized[axis] * 65535.0f));
+            }
 
-        _indexBuffer = std::make_unique<VulkanBuffer> (
-            _device,
-            indexSize,
-            _indexCount,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-        );
+            packed.Position[3] = 0;
+
+            EncodeOctahedral(vertex.Normal, packed.Normal);
+
+            const uint32_t uv = glm::packHalf2x16(vertex.UV);
+            packed.UV[0] = static_cast<uint16_t>(uv & 0xffff);
+            packed.UV[1] = static_cast<uint16_t>(uv >> 16);
+
+            const uint32_t color = glm::packUnorm4x8(glm::vec4 { vertex.Color, 1.0f });
+            std::memcpy(packed.Color, &color, sizeof(packed.Color));
+        }
 
-        _device.copyBuffer(stagingBuffer.getBuffer(), _indexBuffer->getBuffer(), indexBufferSize);
     }
 
     std::vector<VkVertexInputBindingDescription> Model::Vertex::GetBindingDescriptions() {
@@ -154,64 +270,87 @@ namespace Engine {
         return attributeDescriptions;
     }
 
+    std::vector<VkVertexInputBindingDescription> Model::PackedVertex::GetBindingDescriptions() {
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions { 1 };
+        bindingDescriptions[0].binding = 0;
+        bindingDescriptions[0].stride = sizeof(PackedVertex);
+        bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        return bindingDescriptions;
+    }
+
+    // Same locations as Vertex, the normalized formats hand the shader floats so only the normal needs decoding.
+    std::vector<VkVertexInputAttributeDescription> Model::PackedVertex::GetAttributeDescriptions() {
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions {};
+
+        attributeDescriptions.push_back({ 0, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(PackedVertex, Position) });
+        attributeDescriptions.push_back({ 1, 0, VK_FORMAT_R8G8B8A8_UNORM,     offsetof(PackedVertex, Color) });
+        attributeDescriptions.push_back({ 2, 0, VK_FORMAT_R16G16_SNORM,       offsetof(PackedVertex, Normal) });
+        attributeDescriptions.push_back({ 3, 0, VK_FORMAT_R16G16_SFLOAT,      offsetof(PackedVertex, UV) });
+
+        return attributeDescriptions;
+    }
+
     void Model::Data::LoadModel(const std::string &filepath) {
-        tinyobj::attrib_t modelAttributes;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string warn;
-        std::string error;
-
-        if (!tinyobj::LoadObj(&modelAttributes, &shapes, &materials, &warn, &error, filepath.c_str())) {
-            throw std::runtime_error(warn + error);
-        }
-
-        Vertices.clear();
-        Indices.clear();
-
-        std::unordered_map<Vertex, uint32_t> uniqueVertices {};
-
-        for (const auto& shape : shapes) {
-            for (const auto& index : shape.mesh.indices) {
-
-                Vertex vertex {};
-
-                if (index.vertex_index >= 0) {
-                    vertex.Position = {
-                        modelAttributes.vertices[3 * index.vertex_index + 0],
-                        modelAttributes.vertices[3 * index.vertex_index + 1],
-                        modelAttributes.vertices[3 * index.vertex_index + 2]
-                    };
-
-                    vertex.Color = {
-                        modelAttributes.colors[3 * index.vertex_index + 0],
-                        modelAttributes.colors[3 * index.vertex_index + 1],
-                        modelAttributes.colors[3 * index.vertex_index + 2]
-                    };
-                }
-
-                if (index.normal_index >= 0) {
-                    vertex.Normal = {
-                        modelAttributes.normals[3 * index.normal_index + 0],
-                        modelAttributes.normals[3 * index.normal_index + 1],
-                        modelAttributes.normals[3 * index.normal_index + 2]
-                    };
-                }
-
-                if (index.texcoord_index >= 0) {
-                    vertex.UV = {
-                        modelAttributes.texcoords[2 * index.texcoord_index + 0],
-                        modelAttributes.texcoords[2 * index.texcoord_index + 1],
-                    };
-                }
-
-                if (uniqueVertices.count(vertex) == 0) {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(Vertices.size());
-                    Vertices.push_back(vertex);
-                }
-
-                Indices.push_back(uniqueVertices[vertex]);
+        if (IsGlbFile(filepath)) { // every node of the scene baked into one mesh, with its own transform
+            GltfLoader::Scene scene {};
+            GltfLoader::Stats stats = GltfLoader::Load(filepath, scene);
+
+            std::cout << "Parsed " << filepath << ": " << stats.Bytes / 1024 << " KB in " << stats.Seconds * 1000.0 << " ms ("
+                      << stats.GetThroughput() << " MB/s, " << stats.MeshCount << " meshes, " << stats.InstanceCount << " instances)" << std::endl;
+
+            GltfLoader::Flatten(scene, *this);
+            return;
+        }
+
+        ObjLoader::Mesh mesh {};
+        ObjLoader::Stats stats = ObjLoader::Load(filepath, mesh);
+
+        std::cout << "Parsed " << filepath << ": " << stats.Bytes / 1024 << " KB in " << stats.Seconds * 1000.0 << " ms ("
+                  << stats.GetThroughput() << " MB/s, " << stats.ThreadCount << " threads)" << std::endl;
+
+        Lods.clear();
+
+        std::vector<Vertex> corners(mesh.Corners.size());
+
+        for (size_t i = 0; i < mesh.Corners.size(); i++) {
+            const auto& corner = mesh.Corners[i];
+            Vertex& vertex = corners[i];
+
+            if (corner.Position >= 0) {
+                vertex.Position = {
+                    mesh.Positions[3 * corner.Position + 0],
+                    mesh.Positions[3 * corner.Position + 1],
+                    mesh.Positions[3 * corner.Position + 2]
+                };
+
+                vertex.Color = {
+                    mesh.Colors[3 * corner.Position + 0],
+                    mesh.Colors[3 * corner.Position + 1],
+                    mesh.Colors[3 * corner.Position + 2]
+                };
+            }
+
+            if (corner.Normal >= 0) {
+                vertex.Normal = {
+                    mesh.Normals[3 * corner.Normal + 0],
+                    mesh.Normals[3 * corner.Normal + 1],
+                    mesh.Normals[3 * corner.Normal + 2]
+                };
+            }
+
+            if (corner.TexCoord >= 0) {
+                vertex.UV = {
+                    mesh.TexCoords[2 * corner.TexCoord + 0],
+                    mesh.TexCoords[2 * corner.TexCoord + 1],
+                };
             }
         }
+
+        VertexWelder::Stats weldStats = VertexWelder::Weld(corners, *this);
+
+        std::cout << "Welded " << weldStats.CornerCount << " corners into " << weldStats.VertexCount << " vertices in "
+                  << weldStats.Seconds * 1000.0 << " ms (" << weldStats.ThreadCount << " threads)" << std::endl;
     }
 
 } // namespace Engine
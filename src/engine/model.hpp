@@ -1,7 +1,7 @@
 #pragma once
 
-#include "device.hpp"
-#include "vulkan_buffer.hpp"
+#include "geometry_pool.hpp"
+#include "meshlet.hpp"
 
 // libs
 #define GLM_FORCE_RADIANS
@@ -14,9 +14,16 @@
 
 namespace Engine {
 
+    class MeshCache;
+
     class Model {
 
     public:
+        enum class VertexFormat {
+            Float,  // Vertex, 44 bytes
+            Packed, // PackedVertex, 20 bytes, drawn with sh_diffuse_packed.vert
+        };
+
         struct Vertex {
             glm::vec3 Position;
             glm::vec3 Color;
@@ -34,37 +41,123 @@ namespace Engine {
             }
         };
 
+        // Positions are UNORM16 relative to the mesh bounds (see GetDequantizationMatrix), normals are
+        // octahedral encoded SNORM16, UVs are half floats and colors are UNORM8.
+        struct PackedVertex {
+            uint16_t Position[4]; // w is padding, 3 component 16 bit formats are poorly supported
+            int16_t Normal[2];
+            uint16_t UV[2];
+            uint8_t Color[4];     // a is unused
+
+            static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
+            static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
+        };
+
+        // One detail level, a range of the shared index buffer over the shared vertex buffer.
+        struct Lod {
+            uint32_t FirstIndex;
+            uint32_t IndexCount;
+            float Error; // how far the surface may be off, relative to the mesh diagonal
+        };
+
         struct Data {
             std::vector<Vertex> Vertices {};
             std::vector<uint32_t> Indices {};
+            std::vector<Lod> Lods {}; // empty means a single LOD over every index
 
             void LoadModel(const std::string& filepath);
         };
 
-        Model(Device& device, const Data& data);
+        Model(GeometryPool& geometryPool, const Data& data, VertexFormat vertexFormat = VertexFormat::Float);
+        Model(GeometryPool& geometryPool, const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, const std::vector<Lod>& lods,
+              VertexFormat vertexFormat = VertexFormat::Float);
         ~Model();
 
         Model(const Model&) = delete;
         Model& operator=(const Model&) = delete;
 
-        static std::unique_ptr<Model> CreateModelFromFile(Device& device, const std::string filepath);
+        static std::unique_ptr<Model> CreateModelFromFile(GeometryPool& geometryPool, const std::string filepath, VertexFormat vertexFormat = VertexFormat::Float);
+        // Same, for callers that already opened the mesh cache of the file (e.g. for its source hash).
+        static std::unique_ptr<Model> CreateModelFromFile(GeometryPool& geometryPool, const std::string& filepath, MeshCache& cache, VertexFormat vertexFormat);
+
+        // A mesh that is not a file of its own (one of a glTF scene) goes through the same import as a file: optimized,
+        // LODs generated and written to the cache, unless the cache is still valid. data is changed in place.
+        static std::unique_ptr<Model> CreateModelFromMesh(GeometryPool& geometryPool, Data& data, MeshCache& cache, VertexFormat vertexFormat);
+
+        // CPU half of CreateModelFromFile (mesh cache or full import), touches no vulkan state so it can run on any thread.
+        static Data LoadDataFromFile(const std::string& filepath);
 
+        // Geometry pool memory a model built from data would take.
+        static VkDeviceSize EstimateMemorySize(const Data& data, VertexFormat vertexFormat);
+
+        // Binds the geometry pool buffers, models with the same vertex format and index type share them.
         void Bind(VkCommandBuffer commandBuffer);
         void Draw(VkCommandBuffer commandBuffer);
+        void Draw(VkCommandBuffer commandBuffer, const Meshlet::DrawRange* ranges, uint32_t rangeCount);
+
+        // Always at least one, LOD 0 is the full detail mesh.
+        const std::vector<Lod>& GetLods() const {
+            return _lods;
+        }
+
+        // Meshlets of a LOD, empty for models without an index buffer.
+        const std::vector<Meshlet>& GetMeshlets(uint32_t lod) const {
+            return _lodMeshlets[lod];
+        }
+
+        // Bounding sphere of the full detail mesh in model space, its diameter is what LOD errors are relative to.
+        const glm::vec3& GetBoundsCenter() const {
+            return _boundsCenter;
+        }
+
+        float GetBoundsRadius() const {
+            return _boundsRadius;
+        }
+
+        VkDeviceSize GetMemorySize() const {
+            return _memorySize;
+        }
+
+        VertexFormat GetVertexFormat() const {
+            return _vertexFormat;
+        }
+
+        VkIndexType GetIndexType() const {
+            return _indexType;
+        }
+
+        // Maps packed positions back to model space, identity for VertexFormat::Float. Goes right of the model matrix.
+        const glm::mat4& GetDequantizationMatrix() const {
+            return _dequantizationMatrix;
+        }
     
     private:
-        void CreateVertexBuffers(const std::vector<Vertex>& vertices);
-        void CreateIndexBuffer(const std::vector<uint32_t>& indices);
+        static Data ImportData(const std::string& filepath, MeshCache& cache);
+        static void ProcessData(Data& data, MeshCache& cache);
+
+        void CreateBuffers(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+        void PackVertices(const Vertex* vertices, uint32_t vertexCount, std::vector<PackedVertex>& packedVertices);
 
     private:
-        Device& _device;
+        GeometryPool& _geometryPool;
+        GeometryPool::Allocation _allocation { GeometryPool::INVALID_ALLOCATION };
+
+        VertexFormat _vertexFormat;
+        glm::mat4 _dequantizationMatrix { 1.0f };
 
-        std::unique_ptr<VulkanBuffer> _vertexBuffer;
         uint32_t _vertexCount;
 
         bool _hasIndexBuffer { false };
-        std::unique_ptr<VulkanBuffer> _indexBuffer;
         uint32_t _indexCount;
+        VkIndexType _indexType { VK_INDEX_TYPE_UINT32 };
+
+        std::vector<Lod> _lods {};
+        std::vector<std::vector<Meshlet>> _lodMeshlets {};
+
+        glm::vec3 _boundsCenter { 0.0f };
+        float _boundsRadius { 0.0f };
+
+        VkDeviceSize _memorySize { 0 };
     };
     
 } // namespace Engine
@@ -0,0 +1,282 @@
+#include "model_registry.hpp"
+
+#include "gltf_loader.hpp"
+#include "mesh_cache.hpp"
+#include "swap_chain.hpp"
+#include "utils.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+
+namespace Engine {
+
+    ModelRegistry::ModelRegistry(GeometryPool& geometryPool)
+        : _geometryPool(geometryPool)
+    {
+    }
+
+    ModelRegistry::~ModelRegistry()
+    {
+    }
+
+    ModelRegistry::Handle ModelRegistry::Load(const std::string& filepath, Model::VertexFormat vertexFormat) {
+        const std::string pathKey = GetPathKey(filepath, vertexFormat);
+        auto it = _entryByPath.find(pathKey);
+
+        if (it != _entryByPath.end()) {
+            _stats.PathHits++;
+            return Reference(it->second);
+        }
+
+        const auto startTime = std::chrono::high_resolution_clock::now();
+
+        // The source hash is what the mesh cache checks anyway, so a copy of a file under another name costs one read.
+        MeshCache cache { filepath };
+        const uint64_t contentHash = cache.GetSourceHash(); // 0 if the file could not be opened
+
+        if (contentHash != 0) {
+            auto contentIt = _entryByContent.find(GetContentKey(contentHash, vertexFormat));
+
+            if (contentIt != _entryByContent.end()) {
+                _stats.ContentHits++;
+
+                _entryByPath[pathKey] = contentIt->second;
+                _entries[contentIt->second].PathKeys.push_back(pathKey);
+
+                return Reference(contentIt->second);
+            }
+        }
+
+        std::unique_ptr<Model> model = Model::CreateModelFromFile(_geometryPool, filepath, cache, vertexFormat);
+        const double loadSeconds = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        return CreateEntry(filepath, std::move(model), contentHash, loadSeconds);
+    }
+
+    std::vector<ModelRegistry::SceneInstance> ModelRegistry::LoadScene(const std::string& filepath, Model::VertexFormat vertexFormat) {
+        GltfLoader::Scene scene {};
+        GltfLoader::Stats stats = GltfLoader::Load(filepath, scene);
+
+        std::cout << "Parsed " << filepath << ": " << stats.Bytes / 1024 << " KB in " << stats.Seconds * 1000.0 << " ms ("
+                  << stats.GetThroughput() << " MB/s, " << stats.MeshCount << " meshes, " << stats.InstanceCount << " instances)" << std::endl;
+
+        std::vector<Handle> meshModels(scene.Meshes.size());
+        std::vector<SceneInstance> instances {};
+
+        for (const auto& instance : scene.Instances) {
+            Handle& handle = meshModels[instance.MeshIndex];
+            const std::string name = filepath + "#" + std::to_string(instance.MeshIndex);
+
+            if (handle.IsValid()) {
+                Reference(handle.Index);
+            }
+            else if (handle = Find(name, vertexFormat); handle.IsValid()) { // loaded with an earlier call
+                Reference(handle.Index);
+                _stats.PathHits++;
+            }
+            else { // parsing is shared by every mesh of the file
+                const auto startTime = std::chrono::high_resolution_clock::now();
+
+                MeshCache cache { MeshCache::GetCachePath(name), scene.SourceHash };
+                auto model = Model::CreateModelFromMesh(_geometryPool, scene.Meshes[instance.MeshIndex], cache, vertexFormat);
+
+                const double importSeconds = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+                handle = Add(name, std::move(model), importSeconds + stats.Seconds / scene.Meshes.size());
+            }
+
+            instances.push_back({ handle, instance.Transform });
+        }
+
+        return instances;
+    }
+
+    ModelRegistry::Handle ModelRegistry::Add(const std::string& name, std::unique_ptr<Model> model, double loadSeconds) {
+        assert(model != nullptr && "Cannot add an empty model to the registry.");
+
+        auto it = _entryByPath.find(GetPathKey(name, model->GetVertexFormat()));
+
+        if (it != _entryByPath.end()) { // someone loaded it in the meantime, the new copy is not needed
+            _stats.PathHits++;
+            return Reference(it->second);
+        }
+
+        return CreateEntry(name, std::move(model), 0, loadSeconds);
+    }
+
+    ModelRegistry::Handle ModelRegistry::Find(const std::string& filepath, Model::VertexFormat vertexFormat) const {
+        auto it = _entryByPath.find(GetPathKey(filepath, vertexFormat));
+
+        if (it == _entryByPath.end()) {
+            return {};
+        }
+
+        return { it->second, _entries[it->second].Generation };
+    }
+
+    void ModelRegistry::AddRef(Handle handle) {
+        assert(Get(handle) != nullptr && "Cannot reference a model that is not in the registry.");
+
+        Reference(handle.Index);
+    }
+
+    void ModelRegistry::Release(Handle handle) {
+        assert(Get(handle) != nullptr && "Cannot release a model that is not in the registry.");
+
+        Entry& entry = _entries[handle.Index];
+        assert(entry.RefCount > 0 && "Model released more often than it was referenced.");
+
+        if (--entry.RefCount == 0) {
+            // Command buffers still in flight may draw it, it is destroyed once those frames are done.
+            entry.ReleaseFrame = _frame + SwapChain::MAX_FRAMES_IN_FLIGHT;
+            _releasedEntries.push_back(handle.Index);
+        }
+    }
+
+    Model* ModelRegistry::Get(Handle handle) const {
+        if (handle.Index >= _entries.size() || _entries[handle.Index].Generation != handle.Generation) {
+            return nullptr;
+        }
+
+        return _entries[handle.Index].LoadedModel.get();
+    }
+
+    std::string ModelRegistry::GetName(Handle handle) const {
+        if (Get(handle) == nullptr) {
+            return {};
+        }
+
+        return _entries[handle.Index].Name;
+    }
+
+    void ModelRegistry::Update() {
+        _frame++;
+
+        const size_t releasedCount = _releasedEntries.size();
+
+        _releasedEntries.erase(std::remove_if(_releasedEntries.begin(), _releasedEntries.end(), [this](uint32_t index) {
+            if (_entries[index].ReleaseFrame > _frame) {
+                return false;
+            }
+
+            Destroy(index);
+            return true;
+        }), _releasedEntries.end());
+
+        // Destroyed models left holes in the geometry pool.
+        if (_releasedEntries.size() < releasedCount) {
+            _geometryPool.Compact();
+        }
+    }
+
+    std::vector<ModelRegistry::AssetStats> ModelRegistry::GetAssetStats() const {
+        std::vector<AssetStats> assetStats {};
+
+        for (const auto& entry : _entries) {
+            if (entry.LoadedModel == nullptr) {
+                continue;
+            }
+
+            assetStats.push_back({
+                entry.Name,
+                entry.ContentHash,
+                entry.Format,
+                entry.RefCount,
+                static_cast<uint32_t>(entry.PathKeys.size()),
+                entry.LoadedModel->GetMemorySize(),
+                entry.LoadSeconds
+            });
+        }
+
+        return assetStats;
+    }
+
+    void ModelRegistry::LogStats() const {
+        std::cout << "Model registry: " << _stats.ModelCount << " models, " << _stats.MemorySize / 1024 << " KB, " << _stats.PathHits << " path hits, "
+                  << _stats.ContentHits << " content hits, " << _stats.LoadSeconds * 1000.0 << " ms loading" << std::endl;
+
+        for (const auto& asset : GetAssetStats()) {
+            std::cout << "    " << asset.Name << (asset.Format == Model::VertexFormat::Packed ? " (packed)" : "") << ": " << asset.RefCount << " refs, "
+                      << asset.PathCount << " paths, " << asset.MemorySize / 1024 << " KB, " << asset.LoadSeconds * 1000.0 << " ms" << std::endl;
+        }
+    }
+
+    ModelRegistry::Handle ModelRegistry::CreateEntry(const std::string& name, std::unique_ptr<Model> model, uint64_t contentHash, double loadSeconds) {
+        uint32_t index = static_cast<uint32_t>(_entries.size());
+
+        if (!_freeEntries.empty()) {
+            index = _freeEntries.back();
+            _freeEntries.pop_back();
+        }
+        else {
+            _entries.emplace_back();
+        }
+
+        Entry& entry = _entries[index];
+        entry.Name = name;
+        entry.PathKeys = { GetPathKey(name, model->GetVertexFormat()) };
+        entry.ContentHash = contentHash;
+        entry.Format = model->GetVertexFormat();
+        entry.LoadSeconds = loadSeconds;
+        entry.LoadedModel = std::move(model);
+
+        _entryByPath[entry.PathKeys.front()] = index;
+
+        if (contentHash != 0) {
+            _entryByContent[GetContentKey(contentHash, entry.Format)] = index;
+        }
+
+        _stats.ModelCount++;
+        _stats.MemorySize += entry.LoadedModel->GetMemorySize();
+        _stats.LoadSeconds += loadSeconds;
+
+        return Reference(index);
+    }
+
+    ModelRegistry::Handle ModelRegistry::Reference(uint32_t index) {
+        Entry& entry = _entries[index];
+
+        if (entry.RefCount++ == 0) { // revives a released model that was not destroyed yet
+            _releasedEntries.erase(std::remove(_releasedEntries.begin(), _releasedEntries.end(), index), _releasedEntries.end());
+        }
+
+        return { index, entry.Generation };
+    }
+
+    void ModelRegistry::Destroy(uint32_t index) {
+        Entry& entry = _entries[index];
+
+        for (const auto& pathKey : entry.PathKeys) {
+            _entryByPath.erase(pathKey);
+        }
+
+        if (entry.ContentHash != 0) {
+            _entryByContent.erase(GetContentKey(entry.ContentHash, entry.Format));
+        }
+
+        _stats.ModelCount--;
+        _stats.MemorySize -= entry.LoadedModel->GetMemorySize();
+
+        entry.LoadedModel.reset(); // frees its geometry pool allocation
+        entry.PathKeys.clear();
+        entry.Generation++; // handles still pointing here resolve to nullptr
+
+        _freeEntries.push_back(index);
+    }
+
+    // A file is a different model in every vertex format.
+    std::string ModelRegistry::GetPathKey(const std::string& filepath, Model::VertexFormat vertexFormat) {
+        return filepath + (vertexFormat == Model::VertexFormat::Packed ? "#packed" : "");
+    }
+
+    uint64_t ModelRegistry::GetContentKey(uint64_t contentHash, Model::VertexFormat vertexFormat) {
+        size_t seed = static_cast<size_t>(contentHash);
+        hashCombine(seed, static_cast<int>(vertexFormat));
+
+        return static_cast<uint64_t>(seed);
+    }
+
+} // namespace Engine
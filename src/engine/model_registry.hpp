@@ -0,0 +1,141 @@
+#pragma once
+
+#include "geometry_pool.hpp"
+#include "model.hpp"
+
+// libs
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine {
+
+    // Owns the models of the scene, everything else refers to them through handles. A file is loaded once per vertex
+    // format however many objects use it, and files with identical contents share one model under every path.
+    // Handles do not own anything: Load, Add and AddRef count owners, Release gives a reference back. A handle whose
+    // model is gone resolves to nullptr.
+    class ModelRegistry {
+
+    public:
+        struct Handle {
+            uint32_t Index { UINT32_MAX };
+            uint32_t Generation { 0 };
+
+            bool IsValid() const {
+                return Index != UINT32_MAX;
+            }
+
+            bool operator==(const Handle& other) const {
+                return Index == other.Index && Generation == other.Generation;
+            }
+
+            bool operator!=(const Handle& other) const {
+                return !(*this == other);
+            }
+        };
+
+        // A node of a scene file, every instance holds one reference to its model.
+        struct SceneInstance {
+            Handle ModelHandle;
+            glm::mat4 Transform;
+        };
+
+        struct AssetStats {
+            std::string Name;        // path it was first loaded from
+            uint64_t ContentHash;    // 0 when it was added without one
+            Model::VertexFormat Format;
+            uint32_t RefCount;
+            uint32_t PathCount;      // paths that resolve to it
+            VkDeviceSize MemorySize;
+            double LoadSeconds;
+        };
+
+        struct Stats {
+            uint32_t ModelCount { 0 };
+            uint32_t PathHits { 0 };    // loads answered by a path seen before
+            uint32_t ContentHits { 0 }; // loads of a new path whose contents were already loaded
+            VkDeviceSize MemorySize { 0 };
+            double LoadSeconds { 0.0 };
+        };
+
+        ModelRegistry(GeometryPool& geometryPool);
+        ~ModelRegistry();
+
+        ModelRegistry(const ModelRegistry&) = delete;
+        ModelRegistry& operator=(const ModelRegistry&) = delete;
+
+        // Returns the model of the file, loading it if needed, and adds a reference.
+        Handle Load(const std::string& filepath, Model::VertexFormat vertexFormat = Model::VertexFormat::Float);
+
+        // Loads every mesh of a glTF binary file as its own model, named "<path>#<mesh index>". Meshes drawn by several
+        // nodes are uploaded once. Each is imported like a file from Load, with a mesh cache of its own under that name.
+        std::vector<SceneInstance> LoadScene(const std::string& filepath, Model::VertexFormat vertexFormat = Model::VertexFormat::Float);
+
+        // Takes over a model built elsewhere with one reference. Later loads of name with the same format share it.
+        Handle Add(const std::string& name, std::unique_ptr<Model> model, double loadSeconds = 0.0);
+
+        // The model loaded for the file, without adding a reference. Invalid if there is none.
+        Handle Find(const std::string& filepath, Model::VertexFormat vertexFormat) const;
+
+        void AddRef(Handle handle);
+
+        // At zero references the model is destroyed once no frame in flight can draw it anymore, a Load before that revives it.
+        void Release(Handle handle);
+
+        Model* Get(Handle handle) const;
+
+        // Path or name the model was first loaded or added under, empty for a stale handle.
+        std::string GetName(Handle handle) const;
+
+        // Once per frame, destroys models released long enough ago.
+        void Update();
+
+        std::vector<AssetStats> GetAssetStats() const;
+
+        const Stats& GetStats() const {
+            return _stats;
+        }
+
+        void LogStats() const;
+
+    private:
+        struct Entry {
+            std::unique_ptr<Model> LoadedModel {};
+            uint32_t Generation { 0 };
+            uint32_t RefCount { 0 };
+
+            std::string Name {};
+            std::vector<std::string> PathKeys {};
+            uint64_t ContentHash { 0 };
+            Model::VertexFormat Format { Model::VertexFormat::Float };
+            double LoadSeconds { 0.0 };
+
+            uint64_t ReleaseFrame { 0 }; // only meaningful at zero references
+        };
+
+        Handle CreateEntry(const std::string& name, std::unique_ptr<Model> model, uint64_t contentHash, double loadSeconds);
+        Handle Reference(uint32_t index);
+        void Destroy(uint32_t index);
+
+        static std::string GetPathKey(const std::string& filepath, Model::VertexFormat vertexFormat);
+        static uint64_t GetContentKey(uint64_t contentHash, Model::VertexFormat vertexFormat);
+
+    private:
+        GeometryPool& _geometryPool;
+
+        std::vector<Entry> _entries {};
+        std::vector<uint32_t> _freeEntries {};
+        std::unordered_map<std::string, uint32_t> _entryByPath {};
+        std::unordered_map<uint64_t, uint32_t> _entryByContent {};
+        std::vector<uint32_t> _releasedEntries {};
+
+        uint64_t _frame { 0 };
+        Stats _stats {};
+    };
+
+} // namespace Engine
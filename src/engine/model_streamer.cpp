@@ -0,0 +1,331 @@
+#include "model_streamer.hpp"
+
+#include "frustum.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+namespace Engine {
+
+    static float GetMaxScale(const glm::mat4& matrix) {
+        return std::max({ glm::length(glm::vec3 { matrix[0] }), glm::length(glm::vec3 { matrix[1] }), glm::length(glm::vec3 { matrix[2] }) });
+    }
+
+    ModelStreamer::ModelStreamer(GeometryPool& geometryPool, ModelRegistry& modelRegistry, VkDeviceSize memoryBudget, ModelRegistry::Handle placeholder)
+        : _geometryPool(geometryPool), _modelRegistry(modelRegistry), _memoryBudget(memoryBudget), _placeholder(placeholder)
+    {
+        assert(_modelRegistry.Get(_placeholder) != nullptr && "Model streamer needs a placeholder model.");
+
+        _worker = std::thread { [this]() { WorkerLoop(); } };
+    }
+
+    ModelStreamer::~ModelStreamer() {
+        {
+            std::lock_guard<std::mutex> lock { _mutex };
+            _stopping = true;
+        }
+
+        _wakeWorker.notify_one();
+        _worker.join();
+    }
+
+    void ModelStreamer::Update(FrameInfo& frameInfo) {
+        UpdatePriorities(frameInfo);
+        CollectLoaded();
+        UploadParsed();
+
+        // The budget may have shrunk, unused and far away models go first.
+        MakeRoom(0, std::numeric_limits<float>::max());
+
+        QueueLoads();
+
+        Scene& scene = frameInfo.CurrentScene;
+        const StreamedModelComponent* streamedModels = scene.StreamedModels.GetComponents();
+        const Entity* entities = scene.StreamedModels.GetEntities();
+
+        for (uint32_t i = 0; i < scene.StreamedModels.GetSize(); i++) {
+            const Entry& entry = _entries[GetEntry(streamedModels[i])];
+            const ModelRegistry::Handle model = entry.ResidentModel.IsValid() ? entry.ResidentModel : _placeholder;
+            uint32_t renderableIndex = scene.Renderables.IndexOf(entities[i]);
+
+            if (renderableIndex == SparseSet::INVALID_INDEX) {
+                scene.Renderables.Add(entities[i]);
+                renderableIndex = scene.Renderables.IndexOf(entities[i]);
+            }
+
+            RenderableComponent& renderable = scene.Renderables.GetComponents()[renderableIndex];
+
+            if (renderable.ModelHandle != model) {
+                renderable.ModelHandle = model;
+                scene.Renderables.MarkChanged(renderableIndex);
+            }
+        }
+    }
+
+    ModelStreamer::Stats ModelStreamer::GetStats() const {
+        Stats stats {};
+        stats.ResidentBytes = _residentBytes;
+
+        for (const auto& entry : _entries) {
+            stats.ResidentCount += entry.State == EntryState::Resident ? 1 : 0;
+            stats.LoadingCount += entry.State == EntryState::Queued || entry.State == EntryState::Parsed ? 1 : 0;
+        }
+
+        return stats;
+    }
+
+    // The first component asking for a file decides the vertex format it is uploaded with.
+    uint32_t ModelStreamer::GetEntry(const StreamedModelComponent& component) {
+        auto it = _entryByPath.find(component.Filepath);
+
+        if (it != _entryByPath.end()) {
+            return it->second;
+        }
+
+        Entry entry {};
+        entry.Filepath = component.Filepath;
+        entry.Format = component.VertexFormat;
+
+        _entries.push_back(std::move(entry));
+        _entryByPath[component.Filepath] = static_cast<uint32_t>(_entries.size() - 1);
+
+        return static_cast<uint32_t>(_entries.size() - 1);
+    }
+
+    // Priority is the projected size of the object (radius over distance), the largest one among the objects using a model.
+    void ModelStreamer::UpdatePriorities(FrameInfo& frameInfo) {
+        for (auto& entry : _entries) {
+            entry.Priority = 0.0f;
+        }
+
+        const Frustum frustum = Frustum::FromMatrix(frameInfo.Camera.GetProjectionMatrix() * frameInfo.Camera.GetViewMatrix());
+        const glm::vec3 cameraPosition = frameInfo.Camera.GetPosition();
+
+        const Scene& scene = frameInfo.CurrentScene;
+        const StreamedModelComponent* streamedModels = scene.StreamedModels.GetComponents();
+        const Entity* entities = scene.StreamedModels.GetEntities();
+
+        for (uint32_t i = 0; i < scene.StreamedModels.GetSize(); i++) {
+            Entry& entry = _entries[GetEntry(streamedModels[i])];
+            const Model& bounds = *_modelRegistry.Get(entry.ResidentModel.IsValid() ? entry.ResidentModel : _placeholder);
+
+            const glm::mat4& modelMatrix = scene.Transforms.GetWorldMatrix(scene.Transforms.IndexOf(entities[i]));
+            const glm::vec3 center { modelMatrix * glm::vec4 { bounds.GetBoundsCenter(), 1.0f } };
+            const float radius = bounds.GetBoundsRadius() * GetMaxScale(modelMatrix);
+            const float distance = std::max(glm::length(center - cameraPosition), radius);
+
+            float priority = distance > 0.0f ? radius / distance : 1.0f;
+
+            if (!frustum.IntersectsSphere(center, radius)) {
+                priority *= UNSEEN_PRIORITY_SCALE;
+            }
+
+            entry.Priority = std::max(entry.Priority, std::max(priority, std::numeric_limits<float>::min()));
+        }
+    }
+
+    void ModelStreamer::QueueLoads() {
+        // Models the registry still has (loaded by someone else, or evicted so recently they are not destroyed yet) need no load.
+        for (auto& entry : _entries) {
+            if (entry.State != EntryState::Unloaded || entry.Priority == 0.0f) {
+                continue;
+            }
+
+            const ModelRegistry::Handle handle = _modelRegistry.Find(entry.Filepath, entry.Format);
+
+            if (!handle.IsValid() || !MakeRoom(_modelRegistry.Get(handle)->GetMemorySize(), entry.Priority)) {
+                continue;
+            }
+
+            _modelRegistry.AddRef(handle);
+
+            entry.ResidentModel = handle;
+            entry.Bytes = _modelRegistry.Get(handle)->GetMemorySize();
+            entry.State = EntryState::Resident;
+
+            _residentBytes += entry.Bytes;
+        }
+
+        std::lock_guard<std::mutex> lock { _mutex };
+
+        // Requests nobody needs anymore go back to unloaded, the rest get this frame's priority.
+        for (auto& request : _loadQueue) {
+            request.Priority = _entries[request.EntryIndex].Priority;
+
+            if (request.Priority == 0.0f) {
+                _entries[request.EntryIndex].State = EntryState::Unloaded;
+            }
+        }
+
+        _loadQueue.erase(std::remove_if(_loadQueue.begin(), _loadQueue.end(), [](const LoadRequest& request) { return request.Priority == 0.0f; }), _loadQueue.end());
+
+        for (uint32_t i = 0; i < _entries.size(); i++) {
+            Entry& entry = _entries[i];
+
+            if (entry.State == EntryState::Unloaded && entry.Priority > 0.0f) {
+                entry.State = EntryState::Queued;
+                _loadQueue.push_back({ i, entry.Filepath, entry.Priority });
+            }
+        }
+
+        std::sort(_loadQueue.begin(), _loadQueue.end(), [](const LoadRequest& a, const LoadRequest& b) { return a.Priority < b.Priority; });
+
+        if (!_loadQueue.empty()) {
+            _wakeWorker.notify_one();
+        }
+    }
+
+    void ModelStreamer::CollectLoaded() {
+        std::vector<LoadResult> loaded {};
+
+        {
+            std::lock_guard<std::mutex> lock { _mutex };
+            loaded.swap(_loaded);
+        }
+
+        for (auto& result : loaded) {
+            Entry& entry = _entries[result.EntryIndex];
+
+            if (result.ParsedData == nullptr) {
+                entry.State = EntryState::Failed; // keeps the placeholder, the worker already logged why
+                continue;
+            }
+
+            if (entry.Priority == 0.0f) { // not wanted anymore while it was loading
+                entry.State = EntryState::Unloaded;
+                continue;
+            }
+
+            entry.Bytes = Model::EstimateMemorySize(*result.ParsedData, entry.Format);
+            entry.ParsedData = std::move(result.ParsedData);
+            entry.LoadSeconds = result.Seconds;
+            entry.State = EntryState::Parsed;
+        }
+    }
+
+    void ModelStreamer::UploadParsed() {
+        std::vector<uint32_t> parsed {};
+
+        for (uint32_t i = 0; i < _entries.size(); i++) {
+            if (_entries[i].State == EntryState::Parsed) {
+                parsed.push_back(i);
+            }
+        }
+
+        std::sort(parsed.begin(), parsed.end(), [this](uint32_t a, uint32_t b) { return _entries[a].Priority > _entries[b].Priority; });
+
+        uint32_t uploadCount = 0;
+
+        for (uint32_t entryIndex : parsed) {
+            Entry& entry = _entries[entryIndex];
+
+            if (uploadCount == MAX_UPLOADS_PER_FRAME) {
+                break;
+            }
+
+            // Parsed data stays on the cpu until something less important makes room for it.
+            if (!MakeRoom(entry.Bytes, entry.Priority)) {
+                continue;
+            }
+
+            const auto startTime = std::chrono::high_resolution_clock::now();
+            auto model = std::make_unique<Model>(_geometryPool, *entry.ParsedData, entry.Format);
+            entry.LoadSeconds += std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+            entry.ResidentModel = _modelRegistry.Add(entry.Filepath, std::move(model), entry.LoadSeconds);
+            entry.ParsedData.reset();
+            entry.Bytes = _modelRegistry.Get(entry.ResidentModel)->GetMemorySize();
+            entry.State = EntryState::Resident;
+
+            _residentBytes += entry.Bytes;
+            uploadCount++;
+
+            std::cout << "Streamed in " << entry.Filepath << " (" << entry.Bytes / 1024 << " KB, " << _residentBytes / (1024 * 1024)
+                      << " / " << _memoryBudget / (1024 * 1024) << " MB resident)" << std::endl;
+        }
+    }
+
+    // Evicts resident models less important than priority until bytes fit in the budget. Evicts nothing if that is not possible.
+    bool ModelStreamer::MakeRoom(VkDeviceSize bytes, float priority) {
+        if (bytes > _memoryBudget) {
+            return false;
+        }
+
+        std::vector<uint32_t> candidates {};
+        VkDeviceSize reclaimable = 0;
+
+        for (uint32_t i = 0; i < _entries.size(); i++) {
+            if (_entries[i].State == EntryState::Resident && _entries[i].Priority < priority) {
+                candidates.push_back(i);
+                reclaimable += _entries[i].Bytes;
+            }
+        }
+
+        if (_residentBytes - reclaimable + bytes > _memoryBudget) {
+            return false;
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b) { return _entries[a].Priority < _entries[b].Priority; });
+
+        for (uint32_t entryIndex : candidates) {
+            if (_residentBytes + bytes <= _memoryBudget) {
+                break;
+            }
+
+            Evict(entryIndex);
+        }
+
+        return true;
+    }
+
+    void ModelStreamer::Evict(uint32_t entryIndex) {
+        Entry& entry = _entries[entryIndex];
+
+        // The registry keeps it until no frame in flight can draw it anymore.
+        _modelRegistry.Release(entry.ResidentModel);
+        _residentBytes -= entry.Bytes;
+
+        entry.ResidentModel = {};
+        entry.State = EntryState::Unloaded;
+
+        std::cout << "Evicted " << entry.Filepath << " (" << entry.Bytes / 1024 << " KB)" << std::endl;
+    }
+
+    void ModelStreamer::WorkerLoop() {
+        while (true) {
+            LoadRequest request {};
+
+            {
+                std::unique_lock<std::mutex> lock { _mutex };
+                _wakeWorker.wait(lock, [this]() { return _stopping || !_loadQueue.empty(); });
+
+                if (_stopping) {
+                    return;
+                }
+
+                request = std::move(_loadQueue.back());
+                _loadQueue.pop_back();
+            }
+
+            const auto startTime = std::chrono::high_resolution_clock::now();
+            std::unique_ptr<Model::Data> data {};
+
+            try {
+                data = std::make_unique<Model::Data>(Model::LoadDataFromFile(request.Filepath));
+            }
+            catch (const std::exception& exception) {
+                std::cerr << "Failed to stream model " << request.Filepath << ": " << exception.what() << '\n';
+            }
+
+            const double seconds = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+            std::lock_guard<std::mutex> lock { _mutex };
+            _loaded.push_back({ request.EntryIndex, std::move(data), seconds });
+        }
+    }
+
+} // namespace Engine
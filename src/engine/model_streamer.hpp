@@ -0,0 +1,117 @@
+#pragma once
+
+#include "frame_info.hpp"
+#include "geometry_pool.hpp"
+#include "model.hpp"
+#include "model_registry.hpp"
+
+// std
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine {
+
+    // Loads the models of entities with a StreamedModelComponent in the background and keeps the resident
+    // ones under a geometry pool memory budget. Until its model is resident an entity draws the placeholder.
+    // Resident models live in the registry, the streamer holds one reference to each and eviction gives it back.
+    class ModelStreamer {
+
+    public:
+        static constexpr uint32_t MAX_UPLOADS_PER_FRAME = 1;
+        static constexpr float UNSEEN_PRIORITY_SCALE = 0.1f; // objects outside the frustum matter less, but still more than unused models
+
+        struct Stats {
+            VkDeviceSize ResidentBytes { 0 };
+            uint32_t ResidentCount { 0 };
+            uint32_t LoadingCount { 0 };
+        };
+
+        ModelStreamer(GeometryPool& geometryPool, ModelRegistry& modelRegistry, VkDeviceSize memoryBudget, ModelRegistry::Handle placeholder);
+        ~ModelStreamer();
+
+        ModelStreamer(const ModelStreamer&) = delete;
+        ModelStreamer& operator=(const ModelStreamer&) = delete;
+
+        // Once per frame, after BeginFrame and before rendering: updates priorities, uploads finished loads, evicts over budget
+        // and points every streamed entity's RenderableComponent at its model (or the placeholder), adding one if it has none.
+        void Update(FrameInfo& frameInfo);
+
+        void SetMemoryBudget(VkDeviceSize memoryBudget) {
+            _memoryBudget = memoryBudget;
+        }
+
+        Stats GetStats() const;
+
+    private:
+        enum class EntryState {
+            Unloaded,
+            Queued,   // waiting for or on the worker
+            Parsed,   // data is ready, waiting for an upload slot or budget
+            Resident,
+            Failed,
+        };
+
+        struct Entry {
+            std::string Filepath;
+            Model::VertexFormat Format;
+            EntryState State { EntryState::Unloaded };
+
+            std::unique_ptr<Model::Data> ParsedData {};
+            ModelRegistry::Handle ResidentModel {};
+
+            float Priority { 0.0f };
+            VkDeviceSize Bytes { 0 };
+            double LoadSeconds { 0.0 }; // parsing on the worker plus the upload
+        };
+
+        // The worker only sees copies, _entries may grow while it is loading.
+        struct LoadRequest {
+            uint32_t EntryIndex;
+            std::string Filepath;
+            float Priority;
+        };
+
+        struct LoadResult {
+            uint32_t EntryIndex;
+            std::unique_ptr<Model::Data> ParsedData; // null if loading failed
+            double Seconds;
+        };
+
+        uint32_t GetEntry(const StreamedModelComponent& component);
+
+        void UpdatePriorities(FrameInfo& frameInfo);
+        void QueueLoads();
+        void CollectLoaded();
+        void UploadParsed();
+        bool MakeRoom(VkDeviceSize bytes, float priority);
+        void Evict(uint32_t entryIndex);
+
+        void WorkerLoop();
+
+    private:
+        GeometryPool& _geometryPool;
+        ModelRegistry& _modelRegistry;
+        VkDeviceSize _memoryBudget;
+        ModelRegistry::Handle _placeholder;
+
+        std::vector<Entry> _entries {};
+        std::unordered_map<std::string, uint32_t> _entryByPath {};
+
+        VkDeviceSize _residentBytes { 0 };
+
+        // Shared with the worker, guarded by _mutex.
+        std::mutex _mutex;
+        std::condition_variable _wakeWorker;
+        std::vector<LoadRequest> _loadQueue {}; // highest priority last
+        std::vector<LoadResult> _loaded {};
+        bool _stopping { false };
+
+        std::thread _worker;
+    };
+
+} // namespace Engine
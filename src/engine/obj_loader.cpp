@@ -0,0 +1,547 @@
+#include "obj_loader.hpp"
+
+#include "asset_file.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace Engine {
+
+    constexpr size_t MIN_CHUNK_BYTES = 64 * 1024; // smaller chunks cost more in thread startup than they save
+    constexpr int MAX_FLOATS_PER_LINE = 8;
+
+    // Face corner as written in the file. Negative OBJ indices count back from the last element
+    // seen so far, which may live in an earlier chunk, so those are only resolved after merging.
+    struct RawCorner {
+        int32_t Index[3];  // position, texcoord, normal
+        uint8_t RelativeMask;
+        uint8_t PresentMask;
+    };
+
+    struct ObjLoader::Chunk {
+        const char* Begin { nullptr };
+        const char* End { nullptr };
+
+        std::vector<float> Positions {};
+        std::vector<float> Colors {};
+        std::vector<float> Normals {};
+        std::vector<float> TexCoords {};
+
+        std::vector<RawCorner> PolygonCorners {};
+        std::vector<uint32_t> PolygonSizes {};
+        std::vector<Corner> Triangles {};
+
+        std::string Error {};
+    };
+
+    static bool IsSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    static const char* SkipSpaces(const char* p, const char* end) {
+        while (p < end && IsSpace(*p)) {
+            p++;
+        }
+
+        return p;
+    }
+
+    // Decimal float parser, good to about one ulp. Way cheaper than strtod since it never looks at the locale.
+    static bool ParseFloat(const char*& cursor, const char* end, float& result) {
+        static constexpr double POWERS_OF_TEN[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+        };
+
+        const char* p = cursor;
+        bool negative = false;
+
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            p++;
+        }
+
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        int digitCount = 0;
+
+        for (; p < end && *p >= '0' && *p <= '9'; p++, digitCount++) {
+            if (mantissa < 1000000000000000000ull) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            }
+            else {
+                exponent++; // digits past 19 cannot change a float, only its magnitude.
+            }
+        }
+
+        if (p < end && *p == '.') {
+            p++;
+
+            for (; p < end && *p >= '0' && *p <= '9'; p++, digitCount++) {
+                if (mantissa < 1000000000000000000ull) {
+                    mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                    exponent--;
+                }
+            }
+        }
+
+        if (digitCount == 0) {
+            return false;
+        }
+
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            const char* exponentStart = p++;
+            bool negativeExponent = false;
+
+            if (p < end && (*p == '-' || *p == '+')) {
+                negativeExponent = *p == '-';
+                p++;
+            }
+
+            if (p < end && *p >= '0' && *p <= '9') {
+                int explicitExponent = 0;
+
+                for (; p < end && *p >= '0' && *p <= '9'; p++) {
+                    explicitExponent = std::min(explicitExponent * 10 + (*p - '0'), 10000);
+                }
+
+                exponent += negativeExponent ? -explicitExponent : explicitExponent;
+            }
+            else {
+                p = exponentStart; // not an exponent after all, leave the 'e' for the caller.
+            }
+        }
+
+        double value = static_cast<double>(mantissa);
+
+        if (exponent < 0) {
+            value = -exponent <= 22 ? value / POWERS_OF_TEN[-exponent] : value * std::pow(10.0, exponent);
+        }
+        else if (exponent > 0) {
+            value = exponent <= 22 ? value * POWERS_OF_TEN[exponent] : value * std::pow(10.0, exponent);
+        }
+
+        result = static_cast<float>(negative ? -value : value);
+        cursor = p;
+
+        return true;
+    }
+
+    static bool ParseInt(const char*& cursor, const char* end, int32_t& result) {
+        const char* p = cursor;
+        bool negative = false;
+
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            p++;
+        }
+
+        if (p >= end || *p < '0' || *p > '9') {
+            return false;
+        }
+
+        int64_t value = 0;
+
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            value = std::min<int64_t>(value * 10 + (*p - '0'), INT32_MAX);
+        }
+
+        result = static_cast<int32_t>(negative ? -value : value);
+        cursor = p;
+
+        return true;
+    }
+
+    static int ParseFloats(const char* p, const char* end, float* values, int maxCount) {
+        int count = 0;
+
+        for (p = SkipSpaces(p, end); p < end && count < maxCount; p = SkipSpaces(p, end)) {
+            if (!ParseFloat(p, end, values[count])) {
+                break;
+            }
+
+            count++;
+        }
+
+        return count;
+    }
+
+    void ObjLoader::ParseChunk(Chunk& chunk) {
+        const char* p = chunk.Begin;
+        const char* end = chunk.End;
+
+        while (p < end) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            lineEnd = lineEnd != nullptr ? lineEnd : end;
+
+            p = SkipSpaces(p, lineEnd);
+
+            if (lineEnd - p >= 2 && p[0] == 'v' && IsSpace(p[1])) {
+                float values[MAX_FLOATS_PER_LINE];
+                int count = ParseFloats(p + 1, lineEnd, values, MAX_FLOATS_PER_LINE);
+
+                if (count < 3) {
+                    chunk.Error = "Malformed vertex position: " + std::string(p, lineEnd);
+                    return;
+                }
+
+                chunk.Positions.insert(chunk.Positions.end(), values, values + 3);
+
+                if (count == 6) { // "v x y z r g b" vertex color extension
+                    chunk.Colors.insert(chunk.Colors.end(), values + 3, values + 6);
+                }
+                else {
+                    chunk.Colors.insert(chunk.Colors.end(), { 1.0f, 1.0f, 1.0f });
+                }
+            }
+            else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 't' && IsSpace(p[2])) {
+                float values[3] { 0.0f, 0.0f, 0.0f };
+
+                if (ParseFloats(p + 2, lineEnd, values, 3) < 1) {
+                    chunk.Error = "Malformed texture coordinate: " + std::string(p, lineEnd);
+                    return;
+                }
+
+                chunk.TexCoords.insert(chunk.TexCoords.end(), values, values + 2);
+            }
+            else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && IsSpace(p[2])) {
+                float values[3];
+
+                if (ParseFloats(p + 2, lineEnd, values, 3) < 3) {
+                    chunk.Error = "Malformed vertex normal: " + std::string(p, lineEnd);
+                    return;
+                }
+
+                chunk.Normals.insert(chunk.Normals.end(), values, values + 3);
+            }
+            else if (lineEnd - p >= 2 && p[0] == 'f' && IsSpace(p[1])) {
+                const int32_t localCounts[3] = {
+                    static_cast<int32_t>(chunk.Positions.size() / 3),
+                    static_cast<int32_t>(chunk.TexCoords.size() / 2),
+                    static_cast<int32_t>(chunk.Normals.size() / 3),
+                };
+
+                uint32_t polygonSize = 0;
+                const char* cursor = SkipSpaces(p + 1, lineEnd);
+
+                while (cursor < lineEnd) {
+                    RawCorner corner {};
+
+                    // v, v/vt, v//vn or v/vt/vn
+                    for (int attribute = 0; attribute < 3; attribute++) {
+                        int32_t index = 0;
+
+                        if (ParseInt(cursor, lineEnd, index)) {
+                            if (index == 0) {
+                                chunk.Error = "Face index 0 is not valid: " + std::string(p, lineEnd);
+                                return;
+                            }
+
+                            corner.PresentMask |= 1 << attribute;
+
+                            if (index > 0) {
+                                corner.Index[attribute] = index - 1;
+                            }
+                            else {
+                                corner.Index[attribute] = localCounts[attribute] + index;
+                                corner.RelativeMask |= 1 << attribute;
+                            }
+                        }
+                        else if (attribute == 0) {
+                            chunk.Error = "Malformed face: " + std::string(p, lineEnd);
+                            return;
+                        }
+
+                        if (cursor < lineEnd && *cursor == '/') {
+                            cursor++;
+                        }
+                        else {
+                            break;
+                        }
+                    }
+
+                    chunk.PolygonCorners.push_back(corner);
+                    polygonSize++;
+
+                    cursor = SkipSpaces(cursor, lineEnd);
+                }
+
+                if (polygonSize < 3) { // degenerated face, tinyobj skips those too.
+                    chunk.PolygonCorners.resize(chunk.PolygonCorners.size() - polygonSize);
+                }
+                else {
+                    chunk.PolygonSizes.push_back(polygonSize);
+                }
+            }
+
+            p = lineEnd + 1;
+        }
+    }
+
+    static void ClipEars(const std::vector<ObjLoader::Corner>& polygon, const ObjLoader::Mesh& mesh, std::vector<ObjLoader::Corner>& triangles);
+
+    void ObjLoader::TriangulateChunk(Chunk& chunk, const Mesh& mesh, size_t positionBase, size_t texCoordBase, size_t normalBase) {
+        const size_t bases[3] = { positionBase, texCoordBase, normalBase };
+        const size_t counts[3] = { mesh.Positions.size() / 3, mesh.TexCoords.size() / 2, mesh.Normals.size() / 3 };
+
+        std::vector<Corner> polygon {};
+        size_t cornerIndex = 0;
+
+        for (uint32_t polygonSize : chunk.PolygonSizes) {
+            polygon.clear();
+
+            for (uint32_t i = 0; i < polygonSize; i++) {
+                const RawCorner& raw = chunk.PolygonCorners[cornerIndex++];
+                int32_t resolved[3] = { -1, -1, -1 };
+
+                for (int attribute = 0; attribute < 3; attribute++) {
+                    if ((raw.PresentMask & (1 << attribute)) == 0) {
+                        continue;
+                    }
+
+                    int64_t index = raw.Index[attribute];
+
+                    if (raw.RelativeMask & (1 << attribute)) {
+                        index += static_cast<int64_t>(bases[attribute]);
+                    }
+
+                    if (index < 0 || static_cast<size_t>(index) >= counts[attribute]) {
+                        chunk.Error = "Face index out of range.";
+                        return;
+                    }
+
+                    resolved[attribute] = static_cast<int32_t>(index);
+                }
+
+                polygon.push_back({ resolved[0], resolved[1], resolved[2] });
+            }
+
+            if (polygonSize == 4) {
+                // Split along the shorter diagonal, same as tinyobj.
+                auto distanceSquared = [&](const Corner& a, const Corner& b) {
+                    const float* pa = &mesh.Positions[3 * a.Position];
+                    const float* pb = &mesh.Positions[3 * b.Position];
+                    const float dx = pb[0] - pa[0], dy = pb[1] - pa[1], dz = pb[2] - pa[2];
+
+                    return dx * dx + dy * dy + dz * dz;
+                };
+
+                if (distanceSquared(polygon[0], polygon[2]) < distanceSquared(polygon[1], polygon[3])) {
+                    chunk.Triangles.insert(chunk.Triangles.end(), { polygon[0], polygon[1], polygon[2], polygon[0], polygon[2], polygon[3] });
+                }
+                else {
+                    chunk.Triangles.insert(chunk.Triangles.end(), { polygon[0], polygon[1], polygon[3], polygon[1], polygon[2], polygon[3] });
+                }
+
+                continue;
+            }
+
+            ClipEars(polygon, mesh, chunk.Triangles);
+        }
+    }
+
+    // Ear clipping in the plane of the polygon (Newell normal), so concave n-gons come out right.
+    // Falls back to a fan for whatever is left if no ear can be found (self intersecting input).
+    static void ClipEars(const std::vector<ObjLoader::Corner>& polygon, const ObjLoader::Mesh& mesh, std::vector<ObjLoader::Corner>& triangles) {
+        const size_t count = polygon.size();
+
+        auto position = [&](size_t i) {
+            const float* p = &mesh.Positions[3 * polygon[i].Position];
+            return std::array<float, 3> { p[0], p[1], p[2] };
+        };
+
+        float normal[3] { 0.0f, 0.0f, 0.0f };
+
+        for (size_t i = 0; i < count; i++) {
+            auto a = position(i);
+            auto b = position((i + 1) % count);
+
+            normal[0] += (a[1] - b[1]) * (a[2] + b[2]);
+            normal[1] += (a[2] - b[2]) * (a[0] + b[0]);
+            normal[2] += (a[0] - b[0]) * (a[1] + b[1]);
+        }
+
+        // Drop the dominant axis of the normal and work in 2D.
+        const float absNormal[3] { std::fabs(normal[0]), std::fabs(normal[1]), std::fabs(normal[2]) };
+        const int dropAxis = absNormal[0] > absNormal[1] ? (absNormal[0] > absNormal[2] ? 0 : 2) : (absNormal[1] > absNormal[2] ? 1 : 2);
+        const int axisU = (dropAxis + 1) % 3;
+        const int axisV = (dropAxis + 2) % 3;
+        const float orientation = normal[dropAxis] >= 0.0f ? 1.0f : -1.0f;
+
+        std::vector<std::array<float, 2>> points(count);
+
+        for (size_t i = 0; i < count; i++) {
+            auto p = position(i);
+            points[i] = { p[axisU], p[axisV] };
+        }
+
+        auto cross = [&](size_t a, size_t b, size_t c) {
+            return orientation * ((points[b][0] - points[a][0]) * (points[c][1] - points[a][1]) - (points[b][1] - points[a][1]) * (points[c][0] - points[a][0]));
+        };
+
+        std::vector<size_t> remaining(count);
+
+        for (size_t i = 0; i < count; i++) {
+            remaining[i] = i;
+        }
+
+        while (remaining.size() > 3) {
+            bool clipped = false;
+
+            for (size_t i = 0; i < remaining.size() && !clipped; i++) {
+                const size_t prev = remaining[(i + remaining.size() - 1) % remaining.size()];
+                const size_t curr = remaining[i];
+                const size_t next = remaining[(i + 1) % remaining.size()];
+
+                if (cross(prev, curr, next) <= 0.0f) { // reflex corner
+                    continue;
+                }
+
+                bool containsPoint = false;
+
+                for (size_t other : remaining) {
+                    if (other == prev || other == curr || other == next) {
+                        continue;
+                    }
+
+                    if (cross(prev, curr, other) >= 0.0f && cross(curr, next, other) >= 0.0f && cross(next, prev, other) >= 0.0f) {
+                        containsPoint = true;
+                        break;
+                    }
+                }
+
+                if (containsPoint) {
+                    continue;
+                }
+
+                triangles.insert(triangles.end(), { polygon[prev], polygon[curr], polygon[next] });
+                remaining.erase(remaining.begin() + i);
+                clipped = true;
+            }
+
+            if (!clipped) {
+                break;
+            }
+        }
+
+        for (size_t i = 1; i + 1 < remaining.size(); i++) {
+            triangles.insert(triangles.end(), { polygon[remaining[0]], polygon[remaining[i]], polygon[remaining[i + 1]] });
+        }
+    }
+
+    ObjLoader::Stats ObjLoader::Load(const std::string& filepath, Mesh& mesh) {
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        AssetFile file { filepath };
+
+        if (!file.IsOpen()) {
+            throw std::runtime_error("Failed to open file: " + filepath);
+        }
+
+        Stats stats = Parse(reinterpret_cast<const char*>(file.GetData()), file.GetSize(), mesh);
+        stats.Seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        return stats;
+    }
+
+    ObjLoader::Stats ObjLoader::Parse(const char* text, size_t size, Mesh& mesh) {
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        const size_t chunkCount = std::max<size_t>(1, std::min(hardwareThreads, size / MIN_CHUNK_BYTES));
+
+        // Cut at the first line break after every evenly spaced split point.
+        std::vector<Chunk> chunks(chunkCount);
+        const char* end = text + size;
+        const char* begin = text;
+
+        for (size_t i = 0; i < chunkCount; i++) {
+            const char* split = i + 1 == chunkCount ? end : text + (size * (i + 1)) / chunkCount;
+
+            if (split < begin) {
+                split = begin;
+            }
+
+            if (split < end) {
+                const char* lineBreak = static_cast<const char*>(std::memchr(split, '\n', end - split));
+                split = lineBreak != nullptr ? lineBreak + 1 : end;
+            }
+
+            chunks[i].Begin = begin;
+            chunks[i].End = split;
+            begin = split;
+        }
+
+        auto runOnChunks = [&chunks](auto&& work) {
+            std::vector<std::thread> workers {};
+
+            for (size_t i = 1; i < chunks.size(); i++) {
+                workers.emplace_back([&work, &chunks, i]() { work(chunks[i], i); });
+            }
+
+            work(chunks[0], 0);
+
+            for (auto& worker : workers) {
+                worker.join();
+            }
+
+            for (const auto& chunk : chunks) {
+                if (!chunk.Error.empty()) {
+                    throw std::runtime_error(chunk.Error);
+                }
+            }
+        };
+
+        runOnChunks([](Chunk& chunk, size_t) { ParseChunk(chunk); });
+
+        // Merge attributes in file order, remembering where every chunk starts so relative indices can be resolved.
+        std::vector<size_t> positionBases(chunkCount), texCoordBases(chunkCount), normalBases(chunkCount);
+
+        mesh.Positions.clear();
+        mesh.Colors.clear();
+        mesh.Normals.clear();
+        mesh.TexCoords.clear();
+        mesh.Corners.clear();
+
+        for (size_t i = 0; i < chunkCount; i++) {
+            positionBases[i] = mesh.Positions.size() / 3;
+            texCoordBases[i] = mesh.TexCoords.size() / 2;
+            normalBases[i] = mesh.Normals.size() / 3;
+
+            mesh.Positions.insert(mesh.Positions.end(), chunks[i].Positions.begin(), chunks[i].Positions.end());
+            mesh.Colors.insert(mesh.Colors.end(), chunks[i].Colors.begin(), chunks[i].Colors.end());
+            mesh.Normals.insert(mesh.Normals.end(), chunks[i].Normals.begin(), chunks[i].Normals.end());
+            mesh.TexCoords.insert(mesh.TexCoords.end(), chunks[i].TexCoords.begin(), chunks[i].TexCoords.end());
+        }
+
+        runOnChunks([&](Chunk& chunk, size_t i) {
+            TriangulateChunk(chunk, mesh, positionBases[i], texCoordBases[i], normalBases[i]);
+        });
+
+        size_t cornerCount = 0;
+
+        for (const auto& chunk : chunks) {
+            cornerCount += chunk.Triangles.size();
+        }
+
+        mesh.Corners.reserve(cornerCount);
+
+        for (const auto& chunk : chunks) {
+            mesh.Corners.insert(mesh.Corners.end(), chunk.Triangles.begin(), chunk.Triangles.end());
+        }
+
+        Stats stats {};
+        stats.Bytes = size;
+        stats.ThreadCount = static_cast<uint32_t>(chunkCount);
+        stats.Seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        return stats;
+    }
+
+} // namespace Engine
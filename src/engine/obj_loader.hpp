@@ -0,0 +1,51 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine {
+
+    // Wavefront OBJ reader. The file is memory mapped, split into line aligned chunks and
+    // every chunk is parsed on its own thread, only v/vt/vn/f statements are read.
+    class ObjLoader {
+
+    public:
+        // One triangle corner, indices are 0 based and -1 when the attribute is absent.
+        struct Corner {
+            int32_t Position;
+            int32_t TexCoord;
+            int32_t Normal;
+        };
+
+        struct Mesh {
+            std::vector<float> Positions {}; // xyz
+            std::vector<float> Colors {};    // rgb, one per position, white when the file has none
+            std::vector<float> Normals {};   // xyz
+            std::vector<float> TexCoords {}; // uv
+            std::vector<Corner> Corners {};  // triangle list, polygons are already triangulated
+        };
+
+        struct Stats {
+            size_t Bytes { 0 };
+            double Seconds { 0.0 };
+            uint32_t ThreadCount { 0 };
+
+            double GetThroughput() const { // MB/s
+                return Seconds > 0.0 ? (static_cast<double>(Bytes) / (1024.0 * 1024.0)) / Seconds : 0.0;
+            }
+        };
+
+        static Stats Load(const std::string& filepath, Mesh& mesh);
+        static Stats Parse(const char* text, size_t size, Mesh& mesh);
+
+    private:
+        struct Chunk;
+
+        static void ParseChunk(Chunk& chunk);
+        static void TriangulateChunk(Chunk& chunk, const Mesh& mesh, size_t positionBase, size_t texCoordBase, size_t normalBase);
+    };
+
+} // namespace Engine
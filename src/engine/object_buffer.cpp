@@ -0,0 +1,135 @@
+#include "object_buffer.hpp"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+// std
+#include <algorithm>
+
+namespace Engine {
+
+    // Index of the lowest set bit, bits must not be 0.
+    static uint32_t CountTrailingZeros(uint64_t bits) {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index = 0;
+        _BitScanForward64(&index, bits);
+        return static_cast<uint32_t>(index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(bits));
+#endif
+    }
+
+    ObjectBuffer::ObjectBuffer(Device& device, uint32_t frameCount) : _device { device } {
+        _copies.resize(frameCount);
+
+        for (Copy& copy : _copies) {
+            Allocate(copy, MIN_CAPACITY);
+        }
+    }
+
+    void ObjectBuffer::TrackChanges(const TransformStore& transforms) {
+        const uint32_t wordCount = (transforms.GetSize() + 63) / 64;
+
+        // Every copy has to catch up on this frame's changes, the other ones when their frame comes.
+        for (Copy& copy : _copies) {
+            if (copy.DirtyBits.size() < wordCount) {
+                copy.DirtyBits.resize(wordCount, 0);
+            }
+
+            for (uint32_t index : transforms.GetUpdatedIndices()) {
+                copy.DirtyBits[index / 64] |= uint64_t { 1 } << (index % 64);
+            }
+        }
+
+        _stats.ChangedCount = transforms.GetUpdatedCount();
+    }
+
+    bool ObjectBuffer::Upload(const TransformStore& transforms, uint32_t frameIndex) {
+        const uint32_t objectCount = transforms.GetSize();
+        const uint32_t wordCount = (objectCount + 63) / 64;
+
+        Copy& copy = _copies[frameIndex];
+        bool reallocated = false;
+
+        if (objectCount > copy.Capacity) {
+            uint32_t capacity = copy.Capacity;
+
+            while (capacity < objectCount) {
+                capacity *= 2;
+            }
+
+            Allocate(copy, capacity);
+            std::fill(copy.DirtyBits.begin(), copy.DirtyBits.begin() + wordCount, ~uint64_t { 0 }); // a new buffer has nothing in it
+            reallocated = true;
+        }
+
+        _stats.ObjectCount = objectCount;
+        _stats.WrittenCount = 0;
+        _stats.RangeCount = 0;
+        _stats.WrittenBytes = 0;
+
+        // Runs of dirty objects, with small gaps closed so a scattered handful of changes does not become a flush each.
+        uint32_t rangeBegin = UINT32_MAX;
+        uint32_t rangeEnd = 0;
+
+        for (uint32_t word = 0; word < wordCount; word++) {
+            uint64_t bits = copy.DirtyBits[word];
+            copy.DirtyBits[word] = 0;
+
+            while (bits != 0) {
+                const uint32_t index = word * 64 + CountTrailingZeros(bits);
+                bits &= bits - 1;
+
+                if (index >= objectCount) { // dirty before the store shrank
+                    break;
+                }
+
+                if (rangeBegin != UINT32_MAX && index > rangeEnd + MAX_RANGE_GAP) {
+                    Write(copy, transforms, rangeBegin, rangeEnd);
+                    rangeBegin = UINT32_MAX;
+                }
+
+                if (rangeBegin == UINT32_MAX) {
+                    rangeBegin = index;
+                }
+
+                rangeEnd = index + 1;
+            }
+        }
+
+        if (rangeBegin != UINT32_MAX) {
+            Write(copy, transforms, rangeBegin, rangeEnd);
+        }
+
+        return reallocated;
+    }
+
+    void ObjectBuffer::Allocate(Copy& copy, uint32_t capacity) {
+        copy.Buffer = std::make_unique<VulkanBuffer>(_device, sizeof(ObjectData), capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        copy.Buffer->map();
+        copy.Capacity = capacity;
+    }
+
+    void ObjectBuffer::Write(Copy& copy, const TransformStore& transforms, uint32_t begin, uint32_t end) {
+        ObjectData* objects = static_cast<ObjectData*>(copy.Buffer->getMappedMemory());
+
+        for (uint32_t i = begin; i < end; i++) {
+            objects[i].ModelMatrix = transforms.GetWorldMatrix(i);
+            objects[i].NormalMatrix = glm::mat4 { transforms.GetNormalMatrix(i) };
+        }
+
+        // Flushed ranges have to start and end on the device's atom size, the buffer size is a multiple of it.
+        const VkDeviceSize atomSize = std::max<VkDeviceSize>(_device.properties.limits.nonCoherentAtomSize, 1);
+        const VkDeviceSize offset = begin * sizeof(ObjectData) / atomSize * atomSize;
+        const VkDeviceSize flushEnd = std::min((end * sizeof(ObjectData) + atomSize - 1) / atomSize * atomSize, copy.Buffer->getBufferSize());
+
+        copy.Buffer->flush(flushEnd - offset, offset);
+
+        _stats.WrittenCount += end - begin;
+        _stats.WrittenBytes += (end - begin) * sizeof(ObjectData);
+        _stats.RangeCount++;
+    }
+
+} // namespace Engine
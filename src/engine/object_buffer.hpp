@@ -0,0 +1,75 @@
+#pragma once
+
+#include "device.hpp"
+#include "transform_store.hpp"
+#include "vulkan_buffer.hpp"
+
+// libs
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Engine {
+
+    // Model and normal matrix of every transform in a storage buffer, indexed like the transform store, one copy per
+    // frame in flight. Only what changed is written: the transforms a Scene::Update recomputed are marked dirty in
+    // every copy, and a copy only writes and flushes its dirty ranges when its frame comes around again.
+    class ObjectBuffer {
+
+    public:
+        static constexpr uint32_t MIN_CAPACITY = 1024; // objects, a power of two so the size stays a multiple of any flush alignment
+        static constexpr uint32_t MAX_RANGE_GAP = 8;   // clean objects between two dirty ones that still go into the same range
+
+        struct ObjectData {
+            glm::mat4 ModelMatrix;
+            glm::mat4 NormalMatrix; // a mat4 for the std430 layout, the shader only uses the upper 3x3
+        };
+
+        struct Stats {
+            uint32_t ObjectCount { 0 };
+            uint32_t ChangedCount { 0 };  // transforms the last TrackChanges saw recomputed
+            uint32_t WrittenCount { 0 };  // objects written into the frame's copy, changes of the frames it missed included
+            uint32_t RangeCount { 0 };    // flushes
+            VkDeviceSize WrittenBytes { 0 };
+        };
+
+        ObjectBuffer(Device& device, uint32_t frameCount);
+
+        ObjectBuffer(const ObjectBuffer&) = delete;
+        ObjectBuffer& operator=(const ObjectBuffer&) = delete;
+
+        // After every Scene::Update, also on frames that draw nothing, or their changes never reach the buffer.
+        void TrackChanges(const TransformStore& transforms);
+
+        // Writes what changed since the frame's copy was last written, before the frame's commands run. Returns true
+        // if the copy was reallocated to fit more objects, its descriptor has to be written again.
+        bool Upload(const TransformStore& transforms, uint32_t frameIndex);
+
+        VkDescriptorBufferInfo GetDescriptorInfo(uint32_t frameIndex) {
+            return _copies[frameIndex].Buffer->descriptorInfo();
+        }
+
+        const Stats& GetStats() const {
+            return _stats;
+        }
+
+    private:
+        struct Copy {
+            std::unique_ptr<VulkanBuffer> Buffer;
+            uint32_t Capacity;
+            std::vector<uint64_t> DirtyBits; // by object
+        };
+
+        void Allocate(Copy& copy, uint32_t capacity);
+        void Write(Copy& copy, const TransformStore& transforms, uint32_t begin, uint32_t end);
+
+    private:
+        Device& _device;
+        std::vector<Copy> _copies {};
+        Stats _stats {};
+    };
+
+} // namespace Engine
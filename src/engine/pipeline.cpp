@@ -1,6 +1,7 @@
 #include "pipeline.hpp"
 
-#include <fstream>
+#include "asset_file.hpp"
+
 #include <stdexcept>
 #include <iostream>
 
@@ -21,20 +22,13 @@ namespace Engine {
     }
 
     std::vector<char> Pipeline::ReadFile(const std::string &filepath) {
-        std::ifstream file {filepath, std::ios::ate | std::ios::binary};
+        AssetFile file { filepath };
 
-        if (!file.is_open()) {
+        if (!file.IsOpen()) {
             throw std::runtime_error("Failed to open file: " + filepath);
         }
 
-        size_t fileSize = static_cast<size_t>(file.tellg());
-        std::vector<char> file_content_buffer(fileSize);
-
-        file.seekg(0);
-        file.read(file_content_buffer.data(), fileSize);
-        file.close();
-
-        return file_content_buffer;
+        return std::vector<char>(reinterpret_cast<const char*>(file.GetData()), reinterpret_cast<const char*>(file.GetData()) + file.GetSize());
     }
 
     void Pipeline::CreateGraphicsPipeline(const std::string& vertFilepath, const std::string& fragFilepath, const PipelineConfigInfo& configInfo) {
@@ -0,0 +1,70 @@
+#include "scene.hpp"
+
+// std
+#include <cassert>
+
+namespace Engine {
+
+    Entity Scene::CreateEntity(const TransformComponent& transform) {
+        const Entity entity = ReserveEntity();
+        AddEntity(entity, transform);
+
+        return entity;
+    }
+
+    void Scene::AddEntity(Entity entity, const TransformComponent& transform) {
+        assert(_entities.IsAlive(entity) && "Entity was not reserved or is already destroyed.");
+
+        Transforms.Add(entity, transform);
+    }
+
+    Entity Scene::CreatePointLight(float intensity, float radius, glm::vec3 color) {
+        const Entity entity = CreateEntity();
+
+        PointLightComponent& pointLight = PointLights.Add(entity);
+        pointLight.Color = color;
+        pointLight.LightIntensity = intensity;
+        pointLight.Radius = radius;
+
+        return entity;
+    }
+
+    void Scene::DestroyEntity(Entity entity) {
+        if (Renderables.Contains(entity)) {
+            Renderables.Remove(entity);
+        }
+
+        if (PointLights.Contains(entity)) {
+            PointLights.Remove(entity);
+        }
+
+        if (StreamedModels.Contains(entity)) {
+            StreamedModels.Remove(entity);
+        }
+
+        if (RenderableBounds.Contains(entity)) {
+            RenderableBounds.Remove(entity);
+        }
+
+        if (PointLightBounds.Contains(entity)) {
+            PointLightBounds.Remove(entity);
+        }
+
+        if (Transforms.Contains(entity)) {
+            Transforms.Remove(entity);
+        }
+
+        _entities.Destroy(entity);
+    }
+
+    void Scene::Update(JobSystem* jobSystem) {
+        Transforms.Update(jobSystem);
+    }
+
+    void Scene::ClearChanges() {
+        Renderables.ClearChanges();
+        PointLights.ClearChanges();
+        StreamedModels.ClearChanges();
+    }
+
+} // namespace Engine
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "component_store.hpp"
+#include "components.hpp"
+#include "entity.hpp"
+#include "scene_bvh.hpp"
+#include "transform_store.hpp"
+
+// libs
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+
+namespace Engine {
+
+    // Every object in the world. An entity is only an ID, its components live in one dense store per type and
+    // systems walk the store they care about instead of every object. Every entity has a transform.
+    class Scene {
+
+    public:
+        Scene() = default;
+
+        Scene(const Scene&) = delete;
+        Scene& operator=(const Scene&) = delete;
+
+        Entity CreateEntity(const TransformComponent& transform = {});
+
+        // Any thread. The entity exists once AddEntity gives it its transform, until then it is only a handle.
+        Entity ReserveEntity() {
+            return _entities.Create();
+        }
+
+        void AddEntity(Entity entity, const TransformComponent& transform = {});
+
+        // Any thread, count handles at once. Entities added with Transforms.AddRange skip AddEntity.
+        void ReserveEntities(uint32_t count, Entity* entities) {
+            _entities.Create(count, entities);
+        }
+
+        Entity CreatePointLight(float intensity = 10.0f, float radius = 0.1f, glm::vec3 color = glm::vec3(1.0f));
+
+        // Not while a system is iterating a store, removing moves the last component into the removed one's place.
+        // Handles to the entity go stale, destroying it twice does nothing.
+        void DestroyEntity(Entity entity);
+
+        // Once per frame, before the systems read the scene.
+        void Update(JobSystem* jobSystem = nullptr);
+
+        // Once per frame, after every system had its look at what changed in the component stores.
+        void ClearChanges();
+
+        bool IsAlive(Entity entity) const {
+            return Transforms.Contains(entity);
+        }
+
+        uint32_t GetEntityCount() const {
+            return Transforms.GetSize();
+        }
+
+    public:
+        TransformStore Transforms {};
+        ComponentStore<RenderableComponent> Renderables {};
+        ComponentStore<PointLightComponent> PointLights {};
+        ComponentStore<StreamedModelComponent> StreamedModels {};
+
+        // World space boxes for culling and spatial queries, kept up to date by the BoundsSystem.
+        SceneBvh RenderableBounds {};
+        SceneBvh PointLightBounds {};
+
+    private:
+        EntityAllocator _entities {};
+    };
+
+} // namespace Engine
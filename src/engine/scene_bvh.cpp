@@ -0,0 +1,557 @@
+#include "scene_bvh.hpp"
+
+// std
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <utility>
+
+namespace Engine {
+
+    constexpr uint32_t FREE_NODE = SparseSet::INVALID_INDEX - 1; // parent of nodes on the free list
+
+    static float GetDistanceSquared(const Aabb& bounds, const glm::vec3& point) {
+        const glm::vec3 outside = glm::max(glm::max(bounds.Min - point, point - bounds.Max), glm::vec3 { 0.0f });
+        return glm::dot(outside, outside);
+    }
+
+    // Distance along the ray to where it enters the box, infinity if it misses.
+    static float IntersectRay(const Aabb& bounds, const glm::vec3& origin, const glm::vec3& inverseDirection) {
+        const glm::vec3 t1 = (bounds.Min - origin) * inverseDirection;
+        const glm::vec3 t2 = (bounds.Max - origin) * inverseDirection;
+        const glm::vec3 near = glm::min(t1, t2);
+        const glm::vec3 far = glm::max(t1, t2);
+
+        const float entry = std::max({ near.x, near.y, near.z, 0.0f });
+        const float exit = std::min({ far.x, far.y, far.z });
+
+        return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+    }
+
+    void SceneBvh::SetBounds(Entity entity, const Aabb& bounds) {
+        uint32_t index = IndexOf(entity);
+
+        if (index == INVALID_INDEX) {
+            index = Insert(entity);
+
+            const uint32_t leaf = AllocateNode();
+            _nodes[leaf] = Node { Fatten(bounds), INVALID_INDEX, index, INVALID_INDEX };
+
+            _bounds.push_back(bounds);
+            _leaves.push_back(leaf);
+
+            InsertLeaf(leaf);
+            _changeCount++;
+            return;
+        }
+
+        _bounds[index] = bounds;
+        Node& leaf = _nodes[_leaves[index]];
+
+        if (leaf.Bounds.Contains(bounds)) {
+            return;
+        }
+
+        leaf.Bounds = Fatten(bounds);
+        _dirtyLeaves.push_back(_leaves[index]);
+        _changeCount++;
+    }
+
+    void SceneBvh::Remove(Entity entity) {
+        const uint32_t index = Erase(entity);
+        const uint32_t leaf = _leaves[index];
+
+        RemoveLeaf(leaf);
+        FreeNode(leaf);
+
+        EraseAt(_bounds, index);
+        EraseAt(_leaves, index);
+
+        if (index < _leaves.size()) {
+            _nodes[_leaves[index]].Left = index; // the last item moved here
+        }
+
+        _changeCount++;
+    }
+
+    void SceneBvh::Update() {
+        // Leaves freed since they were marked have no parent to refit, reused ones are in the tree and refitting above them is harmless.
+        for (uint32_t leaf : _dirtyLeaves) {
+            if (_nodes[leaf].Parent != FREE_NODE) {
+                RefitAncestors(leaf);
+            }
+        }
+
+        _dirtyLeaves.clear();
+
+        // The cost is a walk over the whole tree, only worth checking once a good part of it changed.
+        if (_changeCount > GetSize() / 4) {
+            _changeCount = 0;
+
+            if (GetCost() > _builtCost * REBUILD_COST_RATIO) {
+                Rebuild();
+            }
+        }
+    }
+
+    // Top down binned SAH build, nodes end up in depth first order with every parent before its children.
+    void SceneBvh::Rebuild() {
+        const uint32_t itemCount = GetSize();
+
+        _nodes.clear();
+        _freeNodes.clear();
+        _dirtyLeaves.clear();
+        _changeCount = 0;
+        _root = INVALID_INDEX;
+        _builtCost = 0.0f;
+
+        if (itemCount == 0) {
+            return;
+        }
+
+        _nodes.reserve(itemCount * 2 - 1);
+
+        // Partitioned in place as the build goes down, copies rather than indices so every pass reads memory in order.
+        struct BuildItem {
+            Aabb Bounds;
+            glm::vec3 Center;
+            uint32_t Item;
+        };
+
+        std::vector<BuildItem> items(itemCount);
+
+        for (uint32_t i = 0; i < itemCount; i++) {
+            items[i] = BuildItem { _bounds[i], _bounds[i].GetCenter(), i };
+        }
+
+        struct Task {
+            uint32_t First;
+            uint32_t Count;
+            uint32_t Parent;
+            bool IsRight;
+        };
+
+        // Starts inside out, so the first box added replaces it without a branch.
+        struct Bin {
+            Aabb Bounds { glm::vec3 { std::numeric_limits<float>::max() }, glm::vec3 { std::numeric_limits<float>::lowest() } };
+            uint32_t Count { 0 };
+
+            void Add(const Aabb& bounds, uint32_t count) {
+                Bounds = Aabb::Union(Bounds, bounds);
+                Count += count;
+            }
+        };
+
+        std::vector<Task> tasks { { 0, itemCount, INVALID_INDEX, false } };
+
+        while (!tasks.empty()) {
+            const Task task = tasks.back();
+            tasks.pop_back();
+
+            const uint32_t node = static_cast<uint32_t>(_nodes.size());
+            _nodes.push_back(Node { {}, task.Parent, 0, 0 });
+
+            if (task.Parent == INVALID_INDEX) {
+                _root = node;
+            }
+            else if (task.IsRight) {
+                _nodes[task.Parent].Right = node;
+            }
+            else {
+                _nodes[task.Parent].Left = node;
+            }
+
+            if (task.Count == 1) {
+                const uint32_t item = items[task.First].Item;
+
+                _nodes[node] = Node { Fatten(_bounds[item]), task.Parent, item, INVALID_INDEX };
+                _leaves[item] = node;
+                continue;
+            }
+
+            BuildItem* first = items.data() + task.First;
+            BuildItem* last = first + task.Count;
+
+            Aabb centerBounds { first->Center, first->Center };
+
+            for (const BuildItem* item = first; item != last; item++) {
+                centerBounds = Aabb::Union(centerBounds, Aabb { item->Center, item->Center });
+            }
+
+            // Cheapest split between two bins on any axis, cost is area times item count on either side.
+            const glm::vec3 extent = centerBounds.Max - centerBounds.Min;
+
+            float bestCost = std::numeric_limits<float>::max();
+            int bestAxis = -1;
+            uint32_t bestSplit = 0;
+
+            const glm::vec3 binScale = static_cast<float>(SAH_BIN_COUNT) / glm::max(extent, glm::vec3 { std::numeric_limits<float>::min() });
+
+            auto getBin = [&](const BuildItem& item, int axis) {
+                const float offset = (item.Center[axis] - centerBounds.Min[axis]) * binScale[axis];
+                return std::min(static_cast<uint32_t>(offset), SAH_BIN_COUNT - 1);
+            };
+
+            for (int axis = 0; axis < 3; axis++) {
+                if (extent[axis] <= 0.0f) {
+                    continue;
+                }
+
+                Bin bins[SAH_BIN_COUNT] {};
+
+                for (const BuildItem* item = first; item != last; item++) {
+                    bins[getBin(*item, axis)].Add(item->Bounds, 1);
+                }
+
+                float rightCosts[SAH_BIN_COUNT] {};
+                Bin right {};
+
+                for (uint32_t split = SAH_BIN_COUNT - 1; split > 0; split--) {
+                    right.Add(bins[split].Bounds, bins[split].Count);
+
+                    rightCosts[split - 1] = right.Count > 0 ? right.Bounds.GetSurfaceArea() * right.Count : -1.0f;
+                }
+
+                Bin left {};
+
+                for (uint32_t split = 0; split + 1 < SAH_BIN_COUNT; split++) {
+                    left.Add(bins[split].Bounds, bins[split].Count);
+
+                    if (left.Count == 0 || rightCosts[split] < 0.0f) {
+                        continue;
+                    }
+
+                    const float cost = left.Bounds.GetSurfaceArea() * left.Count + rightCosts[split];
+
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = split;
+                    }
+                }
+            }
+
+            BuildItem* middle = first + task.Count / 2; // every center in the same spot, any split is as good
+
+            if (bestAxis != -1) {
+                middle = std::partition(first, last, [&](const BuildItem& item) { return getBin(item, bestAxis) <= bestSplit; });
+            }
+
+            const uint32_t leftCount = static_cast<uint32_t>(middle - first);
+
+            // Right first, so the left child is built next and sits right after its parent.
+            tasks.push_back({ task.First + leftCount, task.Count - leftCount, node, true });
+            tasks.push_back({ task.First, leftCount, node, false });
+        }
+
+        for (uint32_t node = static_cast<uint32_t>(_nodes.size()); node-- > 0;) {
+            if (!_nodes[node].IsLeaf()) {
+                _nodes[node].Bounds = Aabb::Union(_nodes[_nodes[node].Left].Bounds, _nodes[_nodes[node].Right].Bounds);
+            }
+        }
+
+        _builtCost = GetCost();
+    }
+
+    float SceneBvh::GetCost() const {
+        if (_root == INVALID_INDEX) {
+            return 0.0f;
+        }
+
+        float area = 0.0f;
+        std::vector<uint32_t> stack { _root };
+
+        while (!stack.empty()) {
+            const Node& node = _nodes[stack.back()];
+            stack.pop_back();
+
+            area += node.Bounds.GetSurfaceArea();
+
+            if (!node.IsLeaf()) {
+                stack.push_back(node.Left);
+                stack.push_back(node.Right);
+            }
+        }
+
+        return area / std::max(_nodes[_root].Bounds.GetSurfaceArea(), std::numeric_limits<float>::min());
+    }
+
+    void SceneBvh::QueryFrustum(const Frustum& frustum, std::vector<Entity>& entities) const {
+        if (_root == INVALID_INDEX) {
+            return;
+        }
+
+        std::vector<uint32_t> stack { _root };
+
+        while (!stack.empty()) {
+            const Node& node = _nodes[stack.back()];
+            stack.pop_back();
+
+            if (!frustum.IntersectsBox(node.Bounds.Min, node.Bounds.Max)) {
+                continue;
+            }
+
+            if (!node.IsLeaf()) {
+                stack.push_back(node.Right);
+                stack.push_back(node.Left);
+            }
+            else if (frustum.IntersectsBox(_bounds[node.Left].Min, _bounds[node.Left].Max)) {
+                entities.push_back(GetEntities()[node.Left]);
+            }
+        }
+    }
+
+    void SceneBvh::QuerySphere(const glm::vec3& center, float radius, std::vector<Entity>& entities) const {
+        if (_root == INVALID_INDEX) {
+            return;
+        }
+
+        const float radiusSquared = radius * radius;
+        std::vector<uint32_t> stack { _root };
+
+        while (!stack.empty()) {
+            const Node& node = _nodes[stack.back()];
+            stack.pop_back();
+
+            if (GetDistanceSquared(node.Bounds, center) > radiusSquared) {
+                continue;
+            }
+
+            if (!node.IsLeaf()) {
+                stack.push_back(node.Right);
+                stack.push_back(node.Left);
+            }
+            else if (GetDistanceSquared(_bounds[node.Left], center) <= radiusSquared) {
+                entities.push_back(GetEntities()[node.Left]);
+            }
+        }
+    }
+
+    bool SceneBvh::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& hit) const {
+        if (_root == INVALID_INDEX) {
+            return false;
+        }
+
+        const glm::vec3 inverseDirection = 1.0f / direction;
+
+        float closest = maxDistance;
+        bool isHit = false;
+
+        std::vector<std::pair<float, uint32_t>> stack { { IntersectRay(_nodes[_root].Bounds, origin, inverseDirection), _root } };
+
+        while (!stack.empty()) {
+            const auto [distance, nodeIndex] = stack.back();
+            stack.pop_back();
+
+            if (distance > closest) {
+                continue;
+            }
+
+            const Node& node = _nodes[nodeIndex];
+
+            if (node.IsLeaf()) {
+                const float itemDistance = IntersectRay(_bounds[node.Left], origin, inverseDirection);
+
+                if (itemDistance <= closest) {
+                    closest = itemDistance;
+                    hit = RayHit { GetEntities()[node.Left], itemDistance };
+                    isHit = true;
+                }
+
+                continue;
+            }
+
+            // Nearer child on top, its hits let the farther one be skipped.
+            std::pair<float, uint32_t> children[2] {
+                { IntersectRay(_nodes[node.Left].Bounds, origin, inverseDirection), node.Left },
+                { IntersectRay(_nodes[node.Right].Bounds, origin, inverseDirection), node.Right },
+            };
+
+            if (children[0].first < children[1].first) {
+                std::swap(children[0], children[1]);
+            }
+
+            for (const auto& child : children) {
+                if (child.first <= closest) {
+                    stack.push_back(child);
+                }
+            }
+        }
+
+        return isHit;
+    }
+
+    // Best first: nodes come off the queue nearest first, so once the nearest left is farther than the count'th best item we are done.
+    void SceneBvh::FindNearest(const glm::vec3& point, uint32_t count, std::vector<Entity>& entities) const {
+        if (_root == INVALID_INDEX || count == 0) {
+            return;
+        }
+
+        using Candidate = std::pair<float, uint32_t>; // squared distance and node or item
+
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> nodes {};
+        std::priority_queue<Candidate> nearest {}; // farthest on top
+
+        nodes.push({ GetDistanceSquared(_nodes[_root].Bounds, point), _root });
+
+        while (!nodes.empty()) {
+            const auto [distance, nodeIndex] = nodes.top();
+            nodes.pop();
+
+            if (nearest.size() == count && distance >= nearest.top().first) {
+                break;
+            }
+
+            const Node& node = _nodes[nodeIndex];
+
+            if (node.IsLeaf()) {
+                const float itemDistance = GetDistanceSquared(_bounds[node.Left], point);
+
+                if (nearest.size() < count) {
+                    nearest.push({ itemDistance, node.Left });
+                }
+                else if (itemDistance < nearest.top().first) {
+                    nearest.pop();
+                    nearest.push({ itemDistance, node.Left });
+                }
+
+                continue;
+            }
+
+            nodes.push({ GetDistanceSquared(_nodes[node.Left].Bounds, point), node.Left });
+            nodes.push({ GetDistanceSquared(_nodes[node.Right].Bounds, point), node.Right });
+        }
+
+        const size_t firstEntity = entities.size();
+        entities.resize(firstEntity + nearest.size());
+
+        for (size_t i = entities.size(); i-- > firstEntity; nearest.pop()) {
+            entities[i] = GetEntities()[nearest.top().second];
+        }
+    }
+
+    uint32_t SceneBvh::AllocateNode() {
+        if (!_freeNodes.empty()) {
+            const uint32_t node = _freeNodes.back();
+            _freeNodes.pop_back();
+            return node;
+        }
+
+        _nodes.emplace_back();
+        return static_cast<uint32_t>(_nodes.size() - 1);
+    }
+
+    void SceneBvh::FreeNode(uint32_t node) {
+        _nodes[node].Parent = FREE_NODE;
+        _freeNodes.push_back(node);
+    }
+
+    // Walks down to the sibling where adding the leaf grows the tree's total area the least.
+    void SceneBvh::InsertLeaf(uint32_t leaf) {
+        if (_root == INVALID_INDEX) {
+            _root = leaf;
+            _nodes[leaf].Parent = INVALID_INDEX;
+            return;
+        }
+
+        const Aabb bounds = _nodes[leaf].Bounds;
+        uint32_t sibling = _root;
+
+        while (!_nodes[sibling].IsLeaf()) {
+            const Node& node = _nodes[sibling];
+
+            const float area = node.Bounds.GetSurfaceArea();
+            const float combinedArea = Aabb::Union(node.Bounds, bounds).GetSurfaceArea();
+
+            const float siblingCost = 2.0f * combinedArea;      // new parent of this node and the leaf
+            const float inheritedCost = 2.0f * (combinedArea - area); // growth of this node if we go further down
+
+            auto getChildCost = [&](uint32_t child) {
+                const Aabb& childBounds = _nodes[child].Bounds;
+                const float childCombinedArea = Aabb::Union(childBounds, bounds).GetSurfaceArea();
+
+                return _nodes[child].IsLeaf() ? childCombinedArea + inheritedCost : childCombinedArea - childBounds.GetSurfaceArea() + inheritedCost;
+            };
+
+            const float leftCost = getChildCost(node.Left);
+            const float rightCost = getChildCost(node.Right);
+
+            if (siblingCost < leftCost && siblingCost < rightCost) {
+                break;
+            }
+
+            sibling = leftCost < rightCost ? node.Left : node.Right;
+        }
+
+        const uint32_t oldParent = _nodes[sibling].Parent;
+        const uint32_t newParent = AllocateNode();
+
+        _nodes[newParent] = Node { Aabb::Union(bounds, _nodes[sibling].Bounds), oldParent, sibling, leaf };
+        _nodes[sibling].Parent = newParent;
+        _nodes[leaf].Parent = newParent;
+
+        if (oldParent == INVALID_INDEX) {
+            _root = newParent;
+        }
+        else if (_nodes[oldParent].Left == sibling) {
+            _nodes[oldParent].Left = newParent;
+        }
+        else {
+            _nodes[oldParent].Right = newParent;
+        }
+
+        RefitAncestors(newParent);
+    }
+
+    // Replaces the leaf's parent with its sibling, the caller frees the leaf.
+    void SceneBvh::RemoveLeaf(uint32_t leaf) {
+        if (leaf == _root) {
+            _root = INVALID_INDEX;
+            return;
+        }
+
+        const uint32_t parent = _nodes[leaf].Parent;
+        const uint32_t grandParent = _nodes[parent].Parent;
+        const uint32_t sibling = _nodes[parent].Left == leaf ? _nodes[parent].Right : _nodes[parent].Left;
+
+        _nodes[sibling].Parent = grandParent;
+
+        if (grandParent == INVALID_INDEX) {
+            _root = sibling;
+        }
+        else {
+            if (_nodes[grandParent].Left == parent) {
+                _nodes[grandParent].Left = sibling;
+            }
+            else {
+                _nodes[grandParent].Right = sibling;
+            }
+
+            RefitAncestors(sibling);
+        }
+
+        FreeNode(parent);
+    }
+
+    // Stops at the first ancestor that already fits, nothing above it can change either.
+    void SceneBvh::RefitAncestors(uint32_t node) {
+        for (uint32_t parent = _nodes[node].Parent; parent != INVALID_INDEX; parent = _nodes[parent].Parent) {
+            const Aabb bounds = Aabb::Union(_nodes[_nodes[parent].Left].Bounds, _nodes[_nodes[parent].Right].Bounds);
+
+            if (bounds == _nodes[parent].Bounds) {
+                break;
+            }
+
+            _nodes[parent].Bounds = bounds;
+        }
+    }
+
+    Aabb SceneBvh::Fatten(const Aabb& bounds) {
+        const glm::vec3 size = bounds.Max - bounds.Min;
+        const float margin = std::max(std::max({ size.x, size.y, size.z }) * FAT_MARGIN, MIN_FAT_MARGIN);
+
+        return Aabb { bounds.Min - glm::vec3 { margin }, bounds.Max + glm::vec3 { margin } };
+    }
+
+} // namespace Engine
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "component_store.hpp"
+#include "frustum.hpp"
+
+// libs
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+
+    struct Aabb {
+        glm::vec3 Min { 0.0f };
+        glm::vec3 Max { 0.0f };
+
+        static Aabb FromSphere(const glm::vec3& center, float radius) {
+            return Aabb { center - glm::vec3 { radius }, center + glm::vec3 { radius } };
+        }
+
+        static Aabb Union(const Aabb& a, const Aabb& b) {
+            return Aabb { glm::min(a.Min, b.Min), glm::max(a.Max, b.Max) };
+        }
+
+        bool Contains(const Aabb& other) const {
+            return glm::all(glm::lessThanEqual(Min, other.Min)) && glm::all(glm::greaterThanEqual(Max, other.Max));
+        }
+
+        glm::vec3 GetCenter() const {
+            return (Min + Max) * 0.5f;
+        }
+
+        float GetSurfaceArea() const {
+            const glm::vec3 size = Max - Min;
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+
+        bool operator==(const Aabb& other) const {
+            return Min == other.Min && Max == other.Max;
+        }
+    };
+
+    // Bounding volume hierarchy over world space boxes of entities, one leaf per entity.
+    //
+    // Leaves hold a box a bit larger than the entity's, so something that moves a little does not touch the tree at all,
+    // and one that leaves its box only refits the nodes above it. Inserts go next to the cheapest sibling, like in
+    // Box2D's dynamic tree. Quality drops as things move around, Rebuild starts over with a binned SAH build.
+    class SceneBvh : public SparseSet {
+
+    public:
+        static constexpr float FAT_MARGIN = 0.1f;        // of the box's largest side, leaves are this much bigger on every side
+        static constexpr float MIN_FAT_MARGIN = 0.01f;
+        static constexpr float REBUILD_COST_RATIO = 1.5f; // Update rebuilds once the tree costs this much more than right after a build
+        static constexpr uint32_t SAH_BIN_COUNT = 12;
+
+        struct RayHit {
+            Entity HitEntity {};
+            float Distance { 0.0f };
+        };
+
+        // Adds the entity or moves its box. The tree catches up in Update.
+        void SetBounds(Entity entity, const Aabb& bounds);
+        void Remove(Entity entity);
+
+        const Aabb& GetBounds(uint32_t index) const {
+            return _bounds[index];
+        }
+
+        // Refits the nodes above every leaf that changed, and rebuilds if that made the tree too slow to query.
+        void Update();
+        void Rebuild();
+
+        // Surface area heuristic cost relative to the root, lower is faster to query.
+        float GetCost() const;
+
+        // Every query appends to entities, and tests the entity's own box rather than its leaf's.
+        void QueryFrustum(const Frustum& frustum, std::vector<Entity>& entities) const;
+        void QuerySphere(const glm::vec3& center, float radius, std::vector<Entity>& entities) const;
+
+        // The closest box the ray enters within maxDistance, direction does not have to be normalized (distances are in its units).
+        bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& hit) const;
+
+        // Up to count entities whose boxes are closest to the point, nearest first.
+        void FindNearest(const glm::vec3& point, uint32_t count, std::vector<Entity>& entities) const;
+
+    private:
+        struct Node {
+            Aabb Bounds;
+            uint32_t Parent;
+            uint32_t Left;  // the item for leaves
+            uint32_t Right; // INVALID_INDEX for leaves
+
+            bool IsLeaf() const {
+                return Right == INVALID_INDEX;
+            }
+        };
+
+        uint32_t AllocateNode();
+        void FreeNode(uint32_t node);
+
+        void InsertLeaf(uint32_t leaf);
+        void RemoveLeaf(uint32_t leaf);
+        void RefitAncestors(uint32_t node);
+
+        static Aabb Fatten(const Aabb& bounds);
+
+    private:
+        // Items, in the order of the set.
+        std::vector<Aabb> _bounds {};
+        std::vector<uint32_t> _leaves {};
+
+        std::vector<Node> _nodes {};
+        std::vector<uint32_t> _freeNodes {};
+        uint32_t _root { INVALID_INDEX };
+
+        std::vector<uint32_t> _dirtyLeaves {};
+        uint32_t _changeCount { 0 }; // leaves moved, inserted or removed since the last cost check
+        float _builtCost { 0.0f };
+    };
+
+} // namespace Engine
@@ -0,0 +1,330 @@
+#include "scene_snapshot.hpp"
+
+#include "asset_file.hpp"
+
+// std
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace Engine {
+
+    static_assert(SceneSnapshot::NO_PARENT == SparseSet::INVALID_INDEX, "Snapshot parents are handed to TransformStore::AddRange as they are");
+
+    static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    SceneSnapshot::Stats SceneSnapshot::Save(const std::string& filepath, const Scene& scene, const ModelRegistry& modelRegistry) {
+        const auto startTime = std::chrono::high_resolution_clock::now();
+
+        const TransformStore& transforms = scene.Transforms;
+        const uint32_t entityCount = transforms.GetSize();
+
+        // File order is parents first, whatever the store looks like since its last update.
+        const std::vector<uint32_t> order = transforms.GetDepthOrder();
+        std::vector<uint32_t> fileIndices(entityCount);
+
+        for (uint32_t i = 0; i < entityCount; i++) {
+            fileIndices[order[i]] = i;
+        }
+
+        auto getFileIndex = [&](Entity entity) { return fileIndices[transforms.IndexOf(entity)]; };
+
+        std::vector<glm::vec3> positions(entityCount);
+        std::vector<glm::vec3> rotations(entityCount);
+        std::vector<glm::vec3> scales(entityCount);
+        std::vector<uint32_t> parents(entityCount);
+
+        for (uint32_t i = 0; i < entityCount; i++) {
+            const uint32_t index = order[i];
+            const Entity parent = transforms.GetParent(transforms.GetEntities()[index]);
+
+            positions[i] = transforms.GetPositions()[index];
+            rotations[i] = transforms.GetRotations()[index];
+            scales[i] = transforms.GetScales()[index];
+            parents[i] = parent.IsValid() && transforms.Contains(parent) ? getFileIndex(parent) : NO_PARENT;
+        }
+
+        std::vector<ModelReference> models {};
+        std::string names {};
+        std::map<std::pair<std::string, Model::VertexFormat>, uint32_t> modelIndices {};
+
+        auto getModelIndex = [&](const std::string& name, Model::VertexFormat format) {
+            auto [it, inserted] = modelIndices.emplace(std::make_pair(name, format), static_cast<uint32_t>(models.size()));
+
+            if (inserted) {
+                models.push_back({ static_cast<uint32_t>(names.size()), static_cast<uint32_t>(name.size()), format, 0 });
+                names += name;
+            }
+
+            return it->second;
+        };
+
+        std::vector<uint32_t> renderableEntities {};
+        std::vector<uint32_t> renderableModels {};
+
+        for (uint32_t i = 0; i < scene.Renderables.GetSize(); i++) {
+            const Entity entity = scene.Renderables.GetEntities()[i];
+            const ModelRegistry::Handle handle = scene.Renderables.GetComponents()[i].ModelHandle;
+            const Model* model = modelRegistry.Get(handle);
+
+            if (model == nullptr || scene.StreamedModels.Contains(entity)) {
+                continue;
+            }
+
+            renderableEntities.push_back(getFileIndex(entity));
+            renderableModels.push_back(getModelIndex(modelRegistry.GetName(handle), model->GetVertexFormat()));
+        }
+
+        std::vector<uint32_t> pointLightEntities {};
+
+        for (uint32_t i = 0; i < scene.PointLights.GetSize(); i++) {
+            pointLightEntities.push_back(getFileIndex(scene.PointLights.GetEntities()[i]));
+        }
+
+        std::vector<uint32_t> streamedEntities {};
+        std::vector<uint32_t> streamedModels {};
+
+        for (uint32_t i = 0; i < scene.StreamedModels.GetSize(); i++) {
+            const StreamedModelComponent& streamedModel = scene.StreamedModels.GetComponents()[i];
+
+            streamedEntities.push_back(getFileIndex(scene.StreamedModels.GetEntities()[i]));
+            streamedModels.push_back(getModelIndex(streamedModel.Filepath, streamedModel.VertexFormat));
+        }
+
+        Header header {};
+        header.Magic = MAGIC;
+        header.Version = VERSION;
+        header.EntityCount = entityCount;
+        header.RenderableCount = static_cast<uint32_t>(renderableEntities.size());
+        header.PointLightCount = scene.PointLights.GetSize();
+        header.StreamedModelCount = static_cast<uint32_t>(streamedEntities.size());
+        header.ModelCount = static_cast<uint32_t>(models.size());
+
+        const std::string tempPath = filepath + ".tmp";
+        std::ofstream file { tempPath, std::ios::binary | std::ios::trunc };
+
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to write scene snapshot " + filepath);
+        }
+
+        const char zeros[DATA_ALIGNMENT] {};
+        uint64_t offset = sizeof(Header);
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header)); // written again once the sections are placed
+
+        auto writeSection = [&](Section section, const void* data, uint64_t size) {
+            const uint64_t alignedOffset = AlignUp(offset, DATA_ALIGNMENT);
+
+            file.write(zeros, alignedOffset - offset);
+            file.write(static_cast<const char*>(data), size);
+
+            header.Sections[section] = { alignedOffset, size };
+            offset = alignedOffset + size;
+        };
+
+        writeSection(SECTION_POSITIONS, positions.data(), positions.size() * sizeof(glm::vec3));
+        writeSection(SECTION_ROTATIONS, rotations.data(), rotations.size() * sizeof(glm::vec3));
+        writeSection(SECTION_SCALES, scales.data(), scales.size() * sizeof(glm::vec3));
+        writeSection(SECTION_PARENTS, parents.data(), parents.size() * sizeof(uint32_t));
+        writeSection(SECTION_RENDERABLE_ENTITIES, renderableEntities.data(), renderableEntities.size() * sizeof(uint32_t));
+        writeSection(SECTION_RENDERABLE_MODELS, renderableModels.data(), renderableModels.size() * sizeof(uint32_t));
+        writeSection(SECTION_POINT_LIGHT_ENTITIES, pointLightEntities.data(), pointLightEntities.size() * sizeof(uint32_t));
+        writeSection(SECTION_POINT_LIGHTS, scene.PointLights.GetComponents(), static_cast<uint64_t>(scene.PointLights.GetSize()) * sizeof(PointLightComponent));
+        writeSection(SECTION_STREAMED_ENTITIES, streamedEntities.data(), streamedEntities.size() * sizeof(uint32_t));
+        writeSection(SECTION_STREAMED_MODELS, streamedModels.data(), streamedModels.size() * sizeof(uint32_t));
+        writeSection(SECTION_MODELS, models.data(), models.size() * sizeof(ModelReference));
+        writeSection(SECTION_NAMES, names.data(), names.size());
+
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.close();
+
+        // Write then rename, same as the asset archive, a failed save never replaces a good snapshot with a truncated one.
+        if (!file || (std::remove(filepath.c_str()), std::rename(tempPath.c_str(), filepath.c_str()) != 0)) {
+            std::remove(tempPath.c_str());
+            throw std::runtime_error("Failed to write scene snapshot " + filepath);
+        }
+
+        Stats stats {};
+        stats.EntityCount = entityCount;
+        stats.ModelCount = header.ModelCount;
+        stats.Bytes = offset;
+        stats.Seconds = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        return stats;
+    }
+
+    bool SceneSnapshot::Load(const std::string& filepath, Scene& scene, ModelRegistry& modelRegistry, Stats& stats) {
+        const auto startTime = std::chrono::high_resolution_clock::now();
+
+        AssetFile file { filepath };
+
+        if (!file.IsOpen()) {
+            return false;
+        }
+
+        Header header {};
+
+        if (file.GetSize() >= sizeof(Header)) {
+            std::memcpy(&header, file.GetData(), sizeof(Header));
+        }
+
+        if (header.Magic != MAGIC || header.Version != VERSION) {
+            throw std::runtime_error(filepath + " is not a scene snapshot of version " + std::to_string(VERSION));
+        }
+
+        const uint64_t expectedSizes[SECTION_COUNT] {
+            header.EntityCount * uint64_t { sizeof(glm::vec3) },
+            header.EntityCount * uint64_t { sizeof(glm::vec3) },
+            header.EntityCount * uint64_t { sizeof(glm::vec3) },
+            header.EntityCount * uint64_t { sizeof(uint32_t) },
+            header.RenderableCount * uint64_t { sizeof(uint32_t) },
+            header.RenderableCount * uint64_t { sizeof(uint32_t) },
+            header.PointLightCount * uint64_t { sizeof(uint32_t) },
+            header.PointLightCount * uint64_t { sizeof(PointLightComponent) },
+            header.StreamedModelCount * uint64_t { sizeof(uint32_t) },
+            header.StreamedModelCount * uint64_t { sizeof(uint32_t) },
+            header.ModelCount * uint64_t { sizeof(ModelReference) },
+            header.Sections[SECTION_NAMES].Size,
+        };
+
+        for (uint32_t section = 0; section < SECTION_COUNT; section++) {
+            const SectionRange& range = header.Sections[section];
+
+            if (range.Size != expectedSizes[section] || range.Offset > file.GetSize() || range.Size > file.GetSize() - range.Offset
+                || range.Offset % DATA_ALIGNMENT != 0) {
+                throw std::runtime_error("Scene snapshot " + filepath + " has a damaged section");
+            }
+        }
+
+        auto getSection = [&](Section section) { return file.GetData() + header.Sections[section].Offset; };
+
+        const auto* parents = reinterpret_cast<const uint32_t*>(getSection(SECTION_PARENTS));
+        const auto* renderableEntities = reinterpret_cast<const uint32_t*>(getSection(SECTION_RENDERABLE_ENTITIES));
+        const auto* renderableModels = reinterpret_cast<const uint32_t*>(getSection(SECTION_RENDERABLE_MODELS));
+        const auto* pointLightEntities = reinterpret_cast<const uint32_t*>(getSection(SECTION_POINT_LIGHT_ENTITIES));
+        const auto* streamedEntities = reinterpret_cast<const uint32_t*>(getSection(SECTION_STREAMED_ENTITIES));
+        const auto* streamedModels = reinterpret_cast<const uint32_t*>(getSection(SECTION_STREAMED_MODELS));
+        const auto* models = reinterpret_cast<const ModelReference*>(getSection(SECTION_MODELS));
+        const auto* names = reinterpret_cast<const char*>(getSection(SECTION_NAMES));
+
+        // Check every index before touching the scene, a damaged file must not leave half a scene behind.
+        auto checkIndices = [&](const uint32_t* indices, uint32_t count, uint32_t limit) {
+            for (uint32_t i = 0; i < count; i++) {
+                if (indices[i] >= limit) {
+                    throw std::runtime_error("Scene snapshot " + filepath + " refers to something it does not contain");
+                }
+            }
+        };
+
+        // A component section naming an entity twice would break the store's sparse set, AddRange only asserts on it.
+        std::vector<bool> hasComponent {};
+
+        auto checkEntityIndices = [&](const uint32_t* indices, uint32_t count) {
+            checkIndices(indices, count, header.EntityCount);
+            hasComponent.assign(header.EntityCount, false);
+
+            for (uint32_t i = 0; i < count; i++) {
+                if (hasComponent[indices[i]]) {
+                    throw std::runtime_error("Scene snapshot " + filepath + " gives an entity the same component twice");
+                }
+
+                hasComponent[indices[i]] = true;
+            }
+        };
+
+        for (uint32_t i = 0; i < header.EntityCount; i++) {
+            if (parents[i] != NO_PARENT && parents[i] >= i) {
+                throw std::runtime_error("Scene snapshot " + filepath + " has a child ahead of its parent");
+            }
+        }
+
+        checkEntityIndices(renderableEntities, header.RenderableCount);
+        checkIndices(renderableModels, header.RenderableCount, header.ModelCount);
+        checkEntityIndices(pointLightEntities, header.PointLightCount);
+        checkEntityIndices(streamedEntities, header.StreamedModelCount);
+        checkIndices(streamedModels, header.StreamedModelCount, header.ModelCount);
+
+        for (uint32_t i = 0; i < header.ModelCount; i++) {
+            if (static_cast<uint64_t>(models[i].NameOffset) + models[i].NameLength > header.Sections[SECTION_NAMES].Size
+                || (models[i].Format != Model::VertexFormat::Float && models[i].Format != Model::VertexFormat::Packed)) {
+                throw std::runtime_error("Scene snapshot " + filepath + " has a damaged model reference");
+            }
+        }
+
+        // Entities and transforms, bulk copied straight out of the file.
+        std::vector<Entity> entities(header.EntityCount);
+        scene.ReserveEntities(header.EntityCount, entities.data());
+
+        scene.Transforms.AddRange(entities.data(), header.EntityCount,
+                                  reinterpret_cast<const glm::vec3*>(getSection(SECTION_POSITIONS)),
+                                  reinterpret_cast<const glm::vec3*>(getSection(SECTION_ROTATIONS)),
+                                  reinterpret_cast<const glm::vec3*>(getSection(SECTION_SCALES)),
+                                  parents);
+
+        auto gatherEntities = [&](const uint32_t* indices, uint32_t count) {
+            std::vector<Entity> gathered(count);
+
+            for (uint32_t i = 0; i < count; i++) {
+                gathered[i] = entities[indices[i]];
+            }
+
+            return gathered;
+        };
+
+        auto getName = [&](uint32_t model) { return std::string { names + models[model].NameOffset, models[model].NameLength }; };
+
+        // Models, each loaded once no matter how many renderables use it.
+        std::vector<ModelRegistry::Handle> handles(header.ModelCount);
+        std::vector<bool> isLoaded(header.ModelCount, false);
+        std::vector<RenderableComponent> renderables(header.RenderableCount);
+
+        for (uint32_t i = 0; i < header.RenderableCount; i++) {
+            const uint32_t model = renderableModels[i];
+
+            if (!isLoaded[model]) {
+                isLoaded[model] = true;
+
+                // Load finds models already in the registry by name, glTF meshes ("<path>#<mesh>") are only found that way.
+                try {
+                    handles[model] = modelRegistry.Load(getName(model), models[model].Format);
+                }
+                catch (const std::exception& exception) {
+                    std::cerr << "Scene snapshot " << filepath << " uses a model that failed to load: " << exception.what() << '\n';
+                }
+
+                stats.ModelCount++;
+            }
+
+            renderables[i].ModelHandle = handles[model];
+        }
+
+        scene.Renderables.AddRange(gatherEntities(renderableEntities, header.RenderableCount).data(), renderables.data(), header.RenderableCount);
+
+        scene.PointLights.AddRange(gatherEntities(pointLightEntities, header.PointLightCount).data(),
+                                   reinterpret_cast<const PointLightComponent*>(getSection(SECTION_POINT_LIGHTS)), header.PointLightCount);
+
+        std::vector<StreamedModelComponent> streamed(header.StreamedModelCount);
+
+        for (uint32_t i = 0; i < header.StreamedModelCount; i++) {
+            streamed[i].Filepath = getName(streamedModels[i]);
+            streamed[i].VertexFormat = models[streamedModels[i]].Format;
+        }
+
+        scene.StreamedModels.AddRange(gatherEntities(streamedEntities, header.StreamedModelCount).data(), streamed.data(), header.StreamedModelCount);
+
+        stats.EntityCount = header.EntityCount;
+        stats.Bytes = file.GetSize();
+        stats.Seconds = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        return true;
+    }
+
+} // namespace Engine
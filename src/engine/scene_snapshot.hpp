@@ -0,0 +1,85 @@
+#pragma once
+
+#include "model_registry.hpp"
+#include "scene.hpp"
+
+// std
+#include <cstdint>
+#include <string>
+
+namespace Engine {
+
+    // Binary scene file ("*.snap"). Every array a store keeps sits in the file as it is in memory, on DATA_ALIGNMENT
+    // boundaries, so loading maps the file and bulk copies them in. Entities are referred to by their position in the
+    // transform arrays, which are written parents first. Models are stored by the name they have in the registry.
+    //
+    // Header | positions | rotations | scales | parents | renderables | point lights | streamed models | models | names
+    class SceneSnapshot {
+
+    public:
+        static constexpr uint32_t MAGIC = 0x4e435356; // "VSCN"
+        static constexpr uint32_t VERSION = 1;
+        static constexpr uint64_t DATA_ALIGNMENT = 64;
+        static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+        enum Section : uint32_t {
+            SECTION_POSITIONS,            // glm::vec3[EntityCount]
+            SECTION_ROTATIONS,            // glm::vec3[EntityCount]
+            SECTION_SCALES,               // glm::vec3[EntityCount]
+            SECTION_PARENTS,              // uint32_t[EntityCount], NO_PARENT or a smaller entity
+            SECTION_RENDERABLE_ENTITIES,  // uint32_t[RenderableCount]
+            SECTION_RENDERABLE_MODELS,    // uint32_t[RenderableCount], into the models
+            SECTION_POINT_LIGHT_ENTITIES, // uint32_t[PointLightCount]
+            SECTION_POINT_LIGHTS,         // PointLightComponent[PointLightCount]
+            SECTION_STREAMED_ENTITIES,    // uint32_t[StreamedModelCount]
+            SECTION_STREAMED_MODELS,      // uint32_t[StreamedModelCount], into the models
+            SECTION_MODELS,               // ModelReference[ModelCount]
+            SECTION_NAMES,                // char[], model names back to back
+            SECTION_COUNT,
+        };
+
+        struct SectionRange {
+            uint64_t Offset;
+            uint64_t Size;
+        };
+
+        struct Header {
+            uint32_t Magic;
+            uint32_t Version;
+            uint32_t EntityCount;
+            uint32_t RenderableCount;
+            uint32_t PointLightCount;
+            uint32_t StreamedModelCount;
+            uint32_t ModelCount;
+            uint32_t Padding;
+            SectionRange Sections[SECTION_COUNT];
+        };
+
+        static_assert(sizeof(Header) == 32 + 16 * SECTION_COUNT, "SceneSnapshot::Header layout must not change without bumping VERSION");
+
+        struct ModelReference {
+            uint32_t NameOffset; // into the names
+            uint32_t NameLength;
+            Model::VertexFormat Format;
+            uint32_t Padding;
+        };
+
+        static_assert(sizeof(ModelReference) == 16, "SceneSnapshot::ModelReference layout must not change without bumping VERSION");
+        static_assert(sizeof(PointLightComponent) == 20, "SceneSnapshot stores PointLightComponent as it is, bump VERSION when it changes");
+
+        struct Stats {
+            uint32_t EntityCount { 0 };
+            uint32_t ModelCount { 0 };
+            uint64_t Bytes { 0 };
+            double Seconds { 0.0 };
+        };
+
+        // Renderables of entities with a StreamedModelComponent are left out, the streamer sets them again.
+        static Stats Save(const std::string& filepath, const Scene& scene, const ModelRegistry& modelRegistry);
+
+        // Adds the entities of the file to the scene and loads every model they use, keeping one reference to each for as
+        // long as the registry lives. Returns false if there is no file at the path, throws if it is damaged.
+        static bool Load(const std::string& filepath, Scene& scene, ModelRegistry& modelRegistry, Stats& stats);
+    };
+
+} // namespace Engine
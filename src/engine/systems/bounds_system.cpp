@@ -0,0 +1,106 @@
+#include "bounds_system.hpp"
+
+// std
+#include <algorithm>
+
+namespace Engine {
+
+    BoundsSystem::BoundsSystem(ModelRegistry& modelRegistry)
+        : _modelRegistry(modelRegistry)
+    {
+    }
+
+    void BoundsSystem::Update(Scene& scene) {
+        UpdateRenderables(scene);
+        UpdatePointLights(scene);
+
+        scene.RenderableBounds.Update();
+        scene.PointLightBounds.Update();
+    }
+
+    void BoundsSystem::UpdateRenderables(Scene& scene) {
+        SceneBvh& bvh = scene.RenderableBounds;
+        const RenderableComponent* renderables = scene.Renderables.GetComponents();
+        const Entity* entities = scene.Renderables.GetEntities();
+
+        uint32_t boundCount = 0;
+
+        for (uint32_t i = 0; i < scene.Renderables.GetSize(); i++) {
+            const Model* model = _modelRegistry.Get(renderables[i].ModelHandle);
+            ModelRegistry::Handle* boundModel = _boundModels.Find(entities[i]);
+
+            if (model == nullptr) {
+                if (boundModel != nullptr) {
+                    _boundModels.Remove(entities[i]);
+                    bvh.Remove(entities[i]);
+                }
+
+                continue;
+            }
+
+            boundCount++;
+
+            const uint32_t transformIndex = scene.Transforms.IndexOf(entities[i]);
+
+            if (boundModel != nullptr && *boundModel == renderables[i].ModelHandle && !scene.Transforms.WasUpdated(transformIndex)) {
+                continue;
+            }
+
+            if (boundModel == nullptr) {
+                _boundModels.Add(entities[i], renderables[i].ModelHandle);
+            }
+            else {
+                *boundModel = renderables[i].ModelHandle;
+            }
+
+            // The model's bounding sphere, scaled by the largest axis so it still holds under non uniform scale.
+            const glm::mat4& modelMatrix = scene.Transforms.GetWorldMatrix(transformIndex);
+            const float maxScale = std::max({ glm::length(glm::vec3 { modelMatrix[0] }), glm::length(glm::vec3 { modelMatrix[1] }), glm::length(glm::vec3 { modelMatrix[2] }) });
+            const glm::vec3 center { modelMatrix * glm::vec4 { model->GetBoundsCenter(), 1.0f } };
+
+            bvh.SetBounds(entities[i], Aabb::FromSphere(center, model->GetBoundsRadius() * maxScale));
+        }
+
+        // Something lost its renderable or was destroyed, find out what. Backwards, removing moves the last one into the hole.
+        if (_boundModels.GetSize() != boundCount) {
+            for (uint32_t i = _boundModels.GetSize(); i-- > 0;) {
+                const Entity entity = _boundModels.GetEntities()[i];
+
+                if (!scene.Renderables.Contains(entity)) {
+                    _boundModels.Remove(entity);
+
+                    if (bvh.Contains(entity)) {
+                        bvh.Remove(entity);
+                    }
+                }
+            }
+        }
+    }
+
+    // Lights whose transform moved or whose component changed, the radius is their size.
+    void BoundsSystem::UpdatePointLights(Scene& scene) {
+        SceneBvh& bvh = scene.PointLightBounds;
+        const PointLightComponent* pointLights = scene.PointLights.GetComponents();
+        const Entity* entities = scene.PointLights.GetEntities();
+
+        for (uint32_t i = 0; i < scene.PointLights.GetSize(); i++) {
+            const uint32_t transformIndex = scene.Transforms.IndexOf(entities[i]);
+
+            if (!scene.PointLights.WasChanged(i) && !scene.Transforms.WasUpdated(transformIndex) && bvh.Contains(entities[i])) {
+                continue;
+            }
+
+            const glm::vec3 position = scene.Transforms.GetWorldPosition(transformIndex);
+            bvh.SetBounds(entities[i], Aabb::FromSphere(position, pointLights[i].Radius));
+        }
+
+        if (bvh.GetSize() != scene.PointLights.GetSize()) {
+            for (uint32_t i = bvh.GetSize(); i-- > 0;) {
+                if (!scene.PointLights.Contains(bvh.GetEntities()[i])) {
+                    bvh.Remove(bvh.GetEntities()[i]);
+                }
+            }
+        }
+    }
+
+} // namespace Engine
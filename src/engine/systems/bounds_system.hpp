@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../component_store.hpp"
+#include "../model_registry.hpp"
+#include "../scene.hpp"
+
+namespace Engine {
+
+    // Keeps the scene's bounding volume hierarchies in step with its stores: a world space box around the model of every
+    // renderable and around every point light. Only entities whose world matrix, model or light changed get a new box.
+    class BoundsSystem {
+
+    public:
+        BoundsSystem(ModelRegistry& modelRegistry);
+
+        BoundsSystem(const BoundsSystem&) = delete;
+        BoundsSystem& operator=(const BoundsSystem&) = delete;
+
+        // Once per frame, right after Scene::Update.
+        void Update(Scene& scene);
+
+    private:
+        void UpdateRenderables(Scene& scene);
+        void UpdatePointLights(Scene& scene);
+
+    private:
+        ModelRegistry& _modelRegistry;
+        ComponentStore<ModelRegistry::Handle> _boundModels {}; // model each renderable's box was made for
+    };
+
+} // namespace Engine
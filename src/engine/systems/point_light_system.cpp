@@ -1,8 +1,8 @@
 #include "point_light_system.hpp"
 
 // std
+#include <algorithm>
 #include <stdexcept>
-#include <map>
 
 namespace Engine {
 
@@ -64,42 +64,58 @@ namespace Engine {
     }
 
     void PointLightSystem::Update(FrameInfo &frameInfo, GlobalUBO &ubo) {
-        int lightIndex = 0;
+        const Scene& scene = frameInfo.CurrentScene;
 
-        for (auto& kv: frameInfo.GameObjectByID) {
-            auto& gameObject = kv.second;
+        // The ubo only has room for MAX_LIGHTS, the ones nearest to the camera get them. The rest are still drawn but light nothing.
+        _lights.clear();
+        scene.PointLightBounds.FindNearest(frameInfo.Camera.GetPosition(), MAX_LIGHTS, _lights);
 
-            if (gameObject.PointLight == nullptr) {
+        uint32_t lightCount = 0;
+
+        for (const Entity entity : _lights) {
+            const PointLightComponent* pointLight = scene.PointLights.Find(entity);
+
+            if (pointLight == nullptr) {
                 continue;
             }
 
-            // Copy light to ubo
-            ubo.PointLights[lightIndex].Position = glm::vec4(gameObject.Transform.Position, 1.0f);
-            ubo.PointLights[lightIndex].Color = glm::vec4(gameObject.Color, gameObject.PointLight->LightIntensity);
+            const glm::vec3 position = scene.Transforms.GetWorldPosition(scene.Transforms.IndexOf(entity));
 
-            lightIndex++;
+            // Copy light to ubo
+            ubo.PointLights[lightCount].Position = glm::vec4(position, 1.0f);
+            ubo.PointLights[lightCount].Color = glm::vec4(pointLight->Color, pointLight->LightIntensity);
+            lightCount++;
         }
 
-        ubo.ActiveLightsCount = lightIndex;
+        ubo.ActiveLightsCount = static_cast<int>(lightCount);
     }
 
     void PointLightSystem::Render(FrameInfo &frameInfo) {
-        // Sort lights
-        std::map<float, GameObject::ID> sortedLights;
+        const Scene& scene = frameInfo.CurrentScene;
+        const PointLightComponent* pointLights = scene.PointLights.GetComponents();
+        const Entity* entities = scene.PointLights.GetEntities();
 
-        for (auto& kv : frameInfo.GameObjectByID) {
-            auto& gameObject = kv.second;
+        // Sort the lights on screen
+        _lights.clear();
+        scene.PointLightBounds.QueryFrustum(Frustum::FromMatrix(frameInfo.Camera.GetProjectionMatrix() * frameInfo.Camera.GetViewMatrix()), _lights);
 
-            if (gameObject.PointLight == nullptr) {
+        _sortedLights.clear();
+
+        for (const Entity entity : _lights) {
+            const uint32_t index = scene.PointLights.IndexOf(entity);
+
+            if (index == SparseSet::INVALID_INDEX) {
                 continue;
             }
 
-            auto dstToPointLight = frameInfo.Camera.GetPosition() - gameObject.Transform.Position;
+            auto dstToPointLight = frameInfo.Camera.GetPosition() - scene.Transforms.GetWorldPosition(scene.Transforms.IndexOf(entity));
             float dstSquared = glm::dot(dstToPointLight, dstToPointLight);
 
-            sortedLights[dstSquared] = gameObject.GetID();
+            _sortedLights.emplace_back(dstSquared, index);
         }
 
+        std::sort(_sortedLights.begin(), _sortedLights.end());
+
         _pipeline->Bind(frameInfo.CommandBuffer);
 
         vkCmdBindDescriptorSets (
@@ -113,14 +129,13 @@ namespace Engine {
         );
 
         // Iterate through sorted lights in reverse order
-        for (auto it = sortedLights.rbegin(); it != sortedLights.rend(); it++) {
-
-            auto& gameObject = frameInfo.GameObjectByID.at(it->second);
+        for (auto it = _sortedLights.rbegin(); it != _sortedLights.rend(); it++) {
+            const PointLightComponent& pointLight = pointLights[it->second];
 
             PointLightPushContants push {};
-            push.Position = glm::vec4(gameObject.Transform.Position, 1.0f);
-            push.Color = glm::vec4(gameObject.Color, gameObject.PointLight->LightIntensity);
-            push.Radius = gameObject.Transform.Scale.x; // x is radius
+            push.Position = glm::vec4(scene.Transforms.GetWorldPosition(scene.Transforms.IndexOf(entities[it->second])), 1.0f);
+            push.Color = glm::vec4(pointLight.Color, pointLight.LightIntensity);
+            push.Radius = pointLight.Radius;
 
             vkCmdPushConstants (
                 frameInfo.CommandBuffer,
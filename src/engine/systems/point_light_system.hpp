@@ -3,11 +3,12 @@
 #include "../camera.hpp"
 #include "../device.hpp"
 #include "../frame_info.hpp"
-#include "../game_object.hpp"
 #include "../pipeline.hpp"
+#include "../scene.hpp"
 
 // std
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace Engine {
@@ -33,6 +34,9 @@ namespace Engine {
 
         std::unique_ptr<Pipeline> _pipeline;
         VkPipelineLayout _pipelineLayout;
+
+        std::vector<Entity> _lights {};
+        std::vector<std::pair<float, uint32_t>> _sortedLights {}; // squared camera distance and light index
     };
     
 } // namespace Engine
@@ -1,20 +1,29 @@
 #include "render_system.hpp"
 
+// libs
+#include <glm/gtc/matrix_inverse.hpp>
+
 // std
+#include <algorithm>
 #include <stdexcept>
 
 namespace Engine {
 
+    constexpr float MAX_SCREEN_ERROR = 0.001f; // fraction of the screen height, about a pixel at 1080p
+    constexpr float LOD_HYSTERESIS = 0.25f;    // a coarser LOD has to beat the error limit by this much before we switch to it
+
+    // Matrices come from the ObjectBuffer, a draw only says which object it is.
     struct PushConstantData {
-        glm::mat4 ModelMatrix { 1.0f };
-        glm::mat4 NormalMatrix { 1.0f };
+        glm::mat4 DequantizationMatrix { 1.0f }; // of the model, identity unless its vertices are packed
+        uint32_t ObjectIndex { 0 };               // transform index
     };
-    
-    RenderSystem::RenderSystem(Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) 
-        : _device(device)
+
+    RenderSystem::RenderSystem(Device& device, ModelRegistry& modelRegistry, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) 
+        : _device(device), _modelRegistry(modelRegistry)
     {
         CreatePipelineLayout(globalSetLayout);
         CreatePipeline(renderPass);
+        CreatePackedPipeline(renderPass); // up front, so the first packed model does not build a pipeline in the middle of recording
     }
 
     RenderSystem::~RenderSystem() {
@@ -23,7 +32,7 @@ namespace Engine {
 
     void RenderSystem::CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout) {
         VkPushConstantRange pushConstantRange {};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT; // We want access to the pushed constant data in both vertex and fragment shader stages.
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; // only the vertex shaders read it
         pushConstantRange.offset = 0;
         pushConstantRange.size = sizeof(PushConstantData);
 
@@ -58,8 +67,123 @@ namespace Engine {
         );
     }
 
+    void RenderSystem::CreatePackedPipeline(VkRenderPass renderPass) {
+        PipelineConfigInfo pipelineConfig {};
+        Pipeline::InitializeDefaultPipelineConfig(pipelineConfig);
+
+        pipelineConfig.RenderPass = renderPass;
+        pipelineConfig.PipelineLayout = _pipelineLayout;
+        pipelineConfig.BindingDescriptions = Model::PackedVertex::GetBindingDescriptions();
+        pipelineConfig.AttributeDescriptions = Model::PackedVertex::GetAttributeDescriptions();
+
+        _packedPipeline = std::make_unique<Pipeline> (
+            _device,
+            "assets/shaders/sh_diffuse_packed.vert.spv",
+            "assets/shaders/sh_diffuse.frag.spv",
+            pipelineConfig
+        );
+    }
+
+    Pipeline& RenderSystem::GetPipeline(Model::VertexFormat vertexFormat) {
+        return vertexFormat == Model::VertexFormat::Float ? *_pipeline : *_packedPipeline;
+    }
+
+    uint32_t RenderSystem::SelectLod(uint32_t& lod, const Model& model, const glm::mat4& modelMatrix, const glm::vec3& cameraPosition, float projectionScale) {
+        const auto& lods = model.GetLods();
+
+        if (lods.size() == 1) {
+            return 0;
+        }
+
+        const float maxScale = std::max({ glm::length(glm::vec3 { modelMatrix[0] }), glm::length(glm::vec3 { modelMatrix[1] }), glm::length(glm::vec3 { modelMatrix[2] }) });
+        const float radius = model.GetBoundsRadius() * maxScale;
+        const float distance = glm::length(glm::vec3 { modelMatrix * glm::vec4 { model.GetBoundsCenter(), 1.0f } } - cameraPosition);
+
+        lod = std::min(lod, static_cast<uint32_t>(lods.size() - 1));
+
+        if (distance <= radius) {
+            lod = 0;
+            return lod;
+        }
+
+        // Projected diameter as a fraction of the screen height, LOD errors are relative to that same diameter.
+        const float screenSize = radius * projectionScale / distance;
+        const float maxError = MAX_SCREEN_ERROR * _lodBias;
+
+        while (lod > 0 && lods[lod].Error * screenSize > maxError) {
+            lod--;
+        }
+
+        while (lod + 1 < lods.size() && lods[lod + 1].Error * screenSize <= maxError * (1.0f - LOD_HYSTERESIS)) {
+            lod++;
+        }
+
+        return lod;
+    }
+
+    // Culling, LOD selection and sorting, nothing here touches Vulkan so it can run on any thread.
+    void RenderSystem::BuildDrawList(FrameInfo& frameInfo) {
+        const glm::mat4 viewProjection = frameInfo.Camera.GetProjectionMatrix() * frameInfo.Camera.GetViewMatrix();
+        const glm::vec4 cameraPosition { frameInfo.Camera.GetPosition(), 1.0f };
+        const float projectionScale = frameInfo.Camera.GetProjectionMatrix()[1][1];
+
+        _visibleRanges.clear();
+        _drawItems.clear();
+
+        Scene& scene = frameInfo.CurrentScene;
+
+        // Whole objects against the frustum through the scene's hierarchy, then meshlets of the ones that made it.
+        _visibleEntities.clear();
+        scene.RenderableBounds.QueryFrustum(Frustum::FromMatrix(viewProjection), _visibleEntities);
+
+        for (const Entity entity : _visibleEntities) {
+            RenderableComponent* renderable = scene.Renderables.Find(entity);
+            Model* model = renderable != nullptr ? _modelRegistry.Get(renderable->ModelHandle) : nullptr;
+
+            if (model == nullptr) {
+                continue;
+            }
+
+            const uint32_t transformIndex = scene.Transforms.IndexOf(entity);
+
+            const glm::mat4& modelMatrix = scene.Transforms.GetWorldMatrix(transformIndex);
+            const uint32_t lod = SelectLod(renderable->Lod, *model, modelMatrix, glm::vec3 { cameraPosition }, projectionScale);
+            const auto& meshlets = model->GetMeshlets(lod);
+
+            // Cull in model space, meshlet bounds stay as they are and only the frustum and the camera get transformed.
+            const uint32_t firstRange = static_cast<uint32_t>(_visibleRanges.size());
+
+            if (!meshlets.empty()) {
+                const Frustum frustum = Frustum::FromMatrix(viewProjection * modelMatrix);
+                const glm::vec3 cameraPositionModel { glm::inverse(modelMatrix) * cameraPosition };
+
+                Meshlet::Cull(meshlets, frustum, cameraPositionModel, _coneCulling, _visibleRanges);
+
+                if (_visibleRanges.size() == firstRange) {
+                    continue;
+                }
+            }
+
+            _drawItems.push_back({
+                model,
+                transformIndex,
+                firstRange,
+                static_cast<uint32_t>(_visibleRanges.size()) - firstRange
+            });
+        }
+
+        std::sort(_drawItems.begin(), _drawItems.end(), [](const DrawItem& a, const DrawItem& b) {
+            if (a.DrawnModel->GetVertexFormat() != b.DrawnModel->GetVertexFormat()) {
+                return a.DrawnModel->GetVertexFormat() < b.DrawnModel->GetVertexFormat();
+            }
+
+            return a.DrawnModel->GetIndexType() < b.DrawnModel->GetIndexType();
+        });
+    }
+
     void RenderSystem::RenderGameObjects(FrameInfo& frameInfo) {
         _pipeline->Bind(frameInfo.CommandBuffer);
+        Model::VertexFormat boundFormat = Model::VertexFormat::Float;
 
         vkCmdBindDescriptorSets (
             frameInfo.CommandBuffer, 
@@ -71,28 +195,41 @@ namespace Engine {
             0, nullptr
         );
 
-        for (auto& kv : frameInfo.GameObjectByID) {
-            auto& obj = kv.second; // second = value
+        const Model* boundModel = nullptr;
 
-            if (obj.Model == nullptr) {
-                continue;
+        for (const auto& item : _drawItems) {
+            Model& model = *item.DrawnModel;
+
+            if (model.GetVertexFormat() != boundFormat) { // both pipelines share the layout, the descriptor set stays bound.
+                boundFormat = model.GetVertexFormat();
+                GetPipeline(boundFormat).Bind(frameInfo.CommandBuffer);
+            }
+
+            // Models with the same vertex format and index type live in the same geometry pool buffers.
+            if (boundModel == nullptr || model.GetVertexFormat() != boundModel->GetVertexFormat() || model.GetIndexType() != boundModel->GetIndexType()) {
+                boundModel = &model;
+                model.Bind(frameInfo.CommandBuffer);
             }
 
             PushConstantData pushConstants {};
-            pushConstants.ModelMatrix = obj.Transform.GetMat4();
-            pushConstants.NormalMatrix = obj.Transform.GetNormalMatrix();
+            pushConstants.DequantizationMatrix = model.GetDequantizationMatrix();
+            pushConstants.ObjectIndex = item.ObjectIndex;
 
             vkCmdPushConstants (
                 frameInfo.CommandBuffer,
                 _pipelineLayout,
-                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                VK_SHADER_STAGE_VERTEX_BIT,
                 0,
                 sizeof(PushConstantData),
                 &pushConstants
             );
 
-            obj.Model->Bind(frameInfo.CommandBuffer);
-            obj.Model->Draw(frameInfo.CommandBuffer);
+            if (item.RangeCount == 0) {
+                model.Draw(frameInfo.CommandBuffer);
+            }
+            else {
+                model.Draw(frameInfo.CommandBuffer, _visibleRanges.data() + item.FirstRange, item.RangeCount);
+            }
         }
     }
 
@@ -3,8 +3,9 @@
 #include "../camera.hpp"
 #include "../device.hpp"
 #include "../frame_info.hpp"
-#include "../game_object.hpp"
+#include "../model_registry.hpp"
 #include "../pipeline.hpp"
+#include "../scene.hpp"
 
 // std
 #include <memory>
@@ -15,23 +16,56 @@ namespace Engine {
     class RenderSystem {
 
     public:
-        RenderSystem(Device& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
+        RenderSystem(Device& device, ModelRegistry& modelRegistry, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout);
         ~RenderSystem();
 
         RenderSystem(const RenderSystem&) = delete;
         RenderSystem& operator=(const RenderSystem&) = delete;
 
+        // BuildDrawList picks what to draw, RenderGameObjects records it. Both once per frame, in that order.
+        void BuildDrawList(FrameInfo& frameInfo);
         void RenderGameObjects(FrameInfo& frameInfo);
 
+        // Off by default, the pipeline does not cull back faces so backfacing meshlets are still visible.
+        void SetConeCulling(bool enabled) {
+            _coneCulling = enabled;
+        }
+
+        // Scales the screen space error every LOD is allowed, above 1 picks coarser LODs and below 1 finer ones.
+        void SetLodBias(float bias) {
+            _lodBias = bias;
+        }
+
     private:
         void CreatePipelineLayout(VkDescriptorSetLayout globalSetLayout);
         void CreatePipeline(VkRenderPass renderPass);
+        void CreatePackedPipeline(VkRenderPass renderPass);
+
+        // A visible object, drawn after every object is culled so draws sharing pipeline and geometry pool buffers end up together.
+        struct DrawItem {
+            Model* DrawnModel;
+            uint32_t ObjectIndex; // into the ObjectBuffer
+            uint32_t FirstRange; // into _visibleRanges
+            uint32_t RangeCount; // 0 draws the whole model
+        };
+
+        Pipeline& GetPipeline(Model::VertexFormat vertexFormat);
+        uint32_t SelectLod(uint32_t& lod, const Model& model, const glm::mat4& modelMatrix, const glm::vec3& cameraPosition, float projectionScale);
     
     private:
         Device& _device;
+        ModelRegistry& _modelRegistry;
 
         std::unique_ptr<Pipeline> _pipeline;
+        std::unique_ptr<Pipeline> _packedPipeline; // for Model::PackedVertex
         VkPipelineLayout _pipelineLayout;
+
+        bool _coneCulling { false };
+        std::vector<Meshlet::DrawRange> _visibleRanges {};
+        std::vector<DrawItem> _drawItems {};
+        std::vector<Entity> _visibleEntities {};
+
+        float _lodBias { 1.0f };
     };
     
 } // namespace Engine
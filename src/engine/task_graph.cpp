@@ -0,0 +1,237 @@
+#include "task_graph.hpp"
+
+// std
+#include <cassert>
+#include <iostream>
+
+namespace Engine {
+
+    constexpr TaskGraph::TaskId NO_TASK = UINT32_MAX;
+
+    TaskGraph::TaskGraph(JobSystem& jobSystem) : _jobSystem { jobSystem } {}
+
+    TaskGraph::TaskId TaskGraph::AddTask(const std::string& name, std::function<void()> work, const std::vector<std::string>& reads,
+                                         const std::vector<std::string>& writes, Affinity affinity) {
+        const TaskId id = static_cast<TaskId>(_tasks.size());
+        std::vector<TaskId> dependencies {};
+
+        auto dependOn = [&](TaskId task) {
+            if (task != NO_TASK && std::find(dependencies.begin(), dependencies.end(), task) == dependencies.end()) {
+                dependencies.push_back(task);
+            }
+        };
+
+        // Reads wait for the last write, writes also wait for every read since then.
+        for (const std::string& resource : reads) {
+            dependOn(_resources[resource].LastWriter);
+        }
+
+        for (const std::string& resource : writes) {
+            const ResourceState& state = _resources[resource];
+            dependOn(state.LastWriter);
+
+            for (TaskId reader : state.ReadersSinceWrite) {
+                dependOn(reader);
+            }
+        }
+
+        for (const std::string& resource : reads) {
+            _resources[resource].ReadersSinceWrite.push_back(id);
+        }
+
+        for (const std::string& resource : writes) {
+            _resources[resource] = ResourceState { id, {} };
+        }
+
+        for (TaskId dependency : dependencies) {
+            _tasks[dependency].Dependents.push_back(id);
+        }
+
+        _tasks.push_back(Task { name, std::move(work), affinity, std::move(dependencies), {} });
+        _waitingDependencies.push_back(0);
+
+        return id;
+    }
+
+    void TaskGraph::Run() {
+        assert(_jobSystem.GetThreadIndex() == 0 && "TaskGraph::Run has to be called from the thread that created the job system");
+
+        _startTime = std::chrono::high_resolution_clock::now();
+        _report.Timings.assign(_tasks.size(), TaskTiming {});
+
+        std::unique_lock<std::mutex> lock { _mutex };
+
+        _finishedCount = 0;
+        _exception = nullptr;
+        _hasFailed = false;
+
+        for (TaskId task = 0; task < _tasks.size(); task++) {
+            _waitingDependencies[task] = static_cast<uint32_t>(_tasks[task].Dependencies.size());
+        }
+
+        lock.unlock();
+
+        for (TaskId task = 0; task < _tasks.size(); task++) {
+            if (_tasks[task].Dependencies.empty()) {
+                Schedule(task);
+            }
+        }
+
+        lock.lock();
+
+        // The main thread runs its own tasks first and helps with the rest while it has nothing else to do.
+        while (_finishedCount < _tasks.size()) {
+            if (!_readyMainTasks.empty()) {
+                const TaskId task = _readyMainTasks.front();
+                _readyMainTasks.pop_front();
+
+                lock.unlock();
+                Execute(task);
+                lock.lock();
+                continue;
+            }
+
+            const uint32_t scheduleCount = _scheduleCount;
+
+            lock.unlock();
+            const bool ranJob = _jobSystem.TryRunOne();
+            lock.lock();
+
+            if (!ranJob) {
+                _condition.wait(lock, [&] { return _scheduleCount != scheduleCount || !_readyMainTasks.empty(); });
+            }
+        }
+
+        const std::exception_ptr exception = _exception;
+        lock.unlock();
+
+        // Every task is done, but the last jobs may still be on their way out of Execute.
+        _jobSystem.Wait(_runningTasks);
+
+        _report.FrameMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - _startTime).count();
+        FindCriticalPath();
+
+        if (exception != nullptr) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    void TaskGraph::LogReport() const {
+        std::cout << "Frame " << _report.FrameMilliseconds << " ms, " << _report.WorkMilliseconds << " ms of work on " << _jobSystem.GetThreadCount()
+                  << " threads, critical path " << _report.CriticalPathMilliseconds << " ms:" << std::endl;
+
+        for (TaskId task : _report.CriticalPath) {
+            const TaskTiming& timing = _report.Timings[task];
+
+            std::cout << "    " << _tasks[task].Name << ": " << timing.EndMilliseconds - timing.StartMilliseconds << " ms on thread " << timing.Thread
+                      << ", started at " << timing.StartMilliseconds << " ms" << std::endl;
+        }
+    }
+
+    // Called without holding _mutex, the job system may run the job right away.
+    void TaskGraph::Schedule(TaskId task) {
+        if (_tasks[task].TaskAffinity == Affinity::MainThread) {
+            std::lock_guard<std::mutex> lock { _mutex };
+            _readyMainTasks.push_back(task);
+        }
+        else {
+            _jobSystem.Run([this, task]() { Execute(task); }, _runningTasks);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock { _mutex };
+            _scheduleCount++;
+        }
+
+        _condition.notify_all();
+    }
+
+    void TaskGraph::Execute(TaskId task) {
+        const auto startTime = std::chrono::high_resolution_clock::now();
+
+        if (!_hasFailed) {
+            try {
+                _tasks[task].Work();
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock { _mutex };
+
+                if (_exception == nullptr) {
+                    _exception = std::current_exception();
+                }
+
+                _hasFailed = true;
+            }
+        }
+
+        const auto endTime = std::chrono::high_resolution_clock::now();
+
+        TaskTiming& timing = _report.Timings[task]; // only this thread touches it until Run collects it under the lock
+        timing.StartMilliseconds = std::chrono::duration<double, std::milli>(startTime - _startTime).count();
+        timing.EndMilliseconds = std::chrono::duration<double, std::milli>(endTime - _startTime).count();
+        timing.Thread = _jobSystem.GetThreadIndex();
+
+        std::vector<TaskId> readyTasks {};
+
+        {
+            std::lock_guard<std::mutex> lock { _mutex };
+
+            for (TaskId dependent : _tasks[task].Dependents) {
+                if (--_waitingDependencies[dependent] == 0) {
+                    readyTasks.push_back(dependent);
+                }
+            }
+        }
+
+        for (TaskId readyTask : readyTasks) {
+            Schedule(readyTask);
+        }
+
+        // Counted last, so Run does not return while the dependents are still being handed out.
+        {
+            std::lock_guard<std::mutex> lock { _mutex };
+            _finishedCount++;
+            _scheduleCount++;
+        }
+
+        _condition.notify_all();
+    }
+
+    // Longest chain by measured time. Tasks only depend on tasks added before them, so one pass in order is enough.
+    void TaskGraph::FindCriticalPath() {
+        std::vector<double> pathEnds(_tasks.size(), 0.0);
+        std::vector<TaskId> previous(_tasks.size(), NO_TASK);
+
+        _report.WorkMilliseconds = 0.0;
+        TaskId last = NO_TASK;
+
+        for (TaskId task = 0; task < _tasks.size(); task++) {
+            const double duration = _report.Timings[task].EndMilliseconds - _report.Timings[task].StartMilliseconds;
+            double pathStart = 0.0;
+
+            for (TaskId dependency : _tasks[task].Dependencies) {
+                if (pathEnds[dependency] > pathStart) {
+                    pathStart = pathEnds[dependency];
+                    previous[task] = dependency;
+                }
+            }
+
+            pathEnds[task] = pathStart + duration;
+            _report.WorkMilliseconds += duration;
+
+            if (last == NO_TASK || pathEnds[task] > pathEnds[last]) {
+                last = task;
+            }
+        }
+
+        _report.CriticalPath.clear();
+
+        for (TaskId task = last; task != NO_TASK; task = previous[task]) {
+            _report.CriticalPath.push_back(task);
+        }
+
+        std::reverse(_report.CriticalPath.begin(), _report.CriticalPath.end());
+        _report.CriticalPathMilliseconds = last != NO_TASK ? pathEnds[last] : 0.0;
+    }
+
+} // namespace Engine
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "job_system.hpp"
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Engine {
+
+    // Per frame work as tasks that say which resources they read and write. A task waits for every task added before it
+    // that writes something it touches, or reads something it writes. Adding tasks in the order one thread would run
+    // them gives the same result, and tasks that do not conflict run in parallel.
+    //
+    // Resources are plain names ("transforms", "camera"...). The graph only compares them, so a name can be as coarse or
+    // as fine as the data it stands for.
+    //
+    // Ready tasks run as jobs on the JobSystem, main thread tasks wait for Run to pick them up.
+    class TaskGraph {
+
+    public:
+        using TaskId = uint32_t;
+
+        enum class Affinity {
+            Any,
+            MainThread, // window, input and Vulkan queue work, run by the thread that calls Run
+        };
+
+        struct TaskTiming {
+            double StartMilliseconds { 0.0 }; // since Run started
+            double EndMilliseconds { 0.0 };
+            uint32_t Thread { 0 };            // JobSystem thread, 0 is the main thread
+        };
+
+        struct Report {
+            double FrameMilliseconds { 0.0 };
+            double WorkMilliseconds { 0.0 };         // every task's time added up
+            double CriticalPathMilliseconds { 0.0 }; // the longest chain of dependent tasks, the frame can not get shorter than this
+            std::vector<TaskId> CriticalPath {};
+            std::vector<TaskTiming> Timings {};      // by task
+        };
+
+        // Run has to be called from the thread that created the job system.
+        explicit TaskGraph(JobSystem& jobSystem);
+
+        TaskGraph(const TaskGraph&) = delete;
+        TaskGraph& operator=(const TaskGraph&) = delete;
+
+        TaskId AddTask(const std::string& name, std::function<void()> work, const std::vector<std::string>& reads,
+                       const std::vector<std::string>& writes, Affinity affinity = Affinity::Any);
+
+        // Runs every task once and returns when all are done. The first exception a task throws is rethrown here,
+        // tasks that were not started yet are skipped.
+        void Run();
+
+        const Report& GetReport() const {
+            return _report;
+        }
+
+        void LogReport() const;
+
+    private:
+        struct Task {
+            std::string Name;
+            std::function<void()> Work;
+            Affinity TaskAffinity;
+            std::vector<TaskId> Dependencies;
+            std::vector<TaskId> Dependents;
+        };
+
+        struct ResourceState {
+            TaskId LastWriter { UINT32_MAX };
+            std::vector<TaskId> ReadersSinceWrite {};
+        };
+
+        void Schedule(TaskId task);
+        void Execute(TaskId task);
+        void FindCriticalPath();
+
+    private:
+        std::vector<Task> _tasks {};
+        std::unordered_map<std::string, ResourceState> _resources {};
+
+        JobSystem& _jobSystem;
+        JobSystem::Counter _runningTasks {};
+
+        // Scheduling state of the current Run, guarded by _mutex.
+        std::mutex _mutex {};
+        std::condition_variable _condition {};
+        std::deque<TaskId> _readyMainTasks {};
+        std::vector<uint32_t> _waitingDependencies {};
+        uint32_t _finishedCount { 0 };
+        uint32_t _scheduleCount { 0 }; // changes whenever a task finishes or is handed to the job system, so the main thread does not miss either
+        std::exception_ptr _exception {};
+
+        std::atomic<bool> _hasFailed { false };
+
+        std::chrono::high_resolution_clock::time_point _startTime {};
+        Report _report {};
+    };
+
+} // namespace Engine
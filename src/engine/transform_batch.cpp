@@ -0,0 +1,212 @@
+#include "transform_batch.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define TRANSFORM_BATCH_X86
+
+    #include <immintrin.h>
+
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+    #endif
+#endif
+
+namespace Engine {
+
+    static TransformBatch::InstructionSet DetectInstructionSet() {
+#if defined(TRANSFORM_BATCH_X86)
+    #if defined(_MSC_VER) && !defined(__clang__)
+        int registers[4] {};
+        __cpuid(registers, 1);
+
+        const bool osSavesAvx = (registers[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6; // OSXSAVE, then xmm and ymm state enabled
+        const bool hasFma = (registers[2] & (1 << 12)) != 0;
+
+        __cpuidex(registers, 7, 0);
+        const bool hasAvx2 = (registers[1] & (1 << 5)) != 0;
+
+        return osSavesAvx && hasFma && hasAvx2 ? TransformBatch::InstructionSet::Avx2 : TransformBatch::InstructionSet::Sse;
+    #else
+        __builtin_cpu_init();
+
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? TransformBatch::InstructionSet::Avx2 : TransformBatch::InstructionSet::Sse;
+    #endif
+#else
+        return TransformBatch::InstructionSet::Scalar;
+#endif
+    }
+
+    static const TransformBatch::InstructionSet supportedInstructionSet = DetectInstructionSet();
+    static TransformBatch::InstructionSet activeInstructionSet = supportedInstructionSet;
+
+    // One transform at a time, same math as TransformComponent but the trig is shared by both matrices.
+    static void ComputeScalar(const glm::vec3* positions, const glm::vec3* rotations, const glm::vec3* scales, const uint32_t* indices, uint32_t count,
+                              glm::mat4* modelMatrices, glm::mat3* normalMatrices) {
+        for (uint32_t i = 0; i < count; i++) {
+            const uint32_t index = indices != nullptr ? indices[i] : i;
+            const glm::vec3& rotation = rotations[index];
+            const glm::vec3& scale = scales[index];
+            const glm::vec3 inverseScale = 1.0f / scale;
+
+            const float c3 = std::cos(rotation.z);
+            const float s3 = std::sin(rotation.z);
+            const float c2 = std::cos(rotation.x);
+            const float s2 = std::sin(rotation.x);
+            const float c1 = std::cos(rotation.y);
+            const float s1 = std::sin(rotation.y);
+
+            const glm::mat3 rotationMatrix {
+                { c1 * c3 + s1 * s2 * s3, c2 * s3, c1 * s2 * s3 - c3 * s1 },
+                { c3 * s1 * s2 - c1 * s3, c2 * c3, c1 * c3 * s2 + s1 * s3 },
+                { c2 * s1, -s2, c1 * c2 },
+            };
+
+            modelMatrices[index] = glm::mat4 {
+                glm::vec4 { rotationMatrix[0] * scale.x, 0.0f },
+                glm::vec4 { rotationMatrix[1] * scale.y, 0.0f },
+                glm::vec4 { rotationMatrix[2] * scale.z, 0.0f },
+                glm::vec4 { positions[index], 1.0f },
+            };
+
+            normalMatrices[index] = glm::mat3 {
+                rotationMatrix[0] * inverseScale.x,
+                rotationMatrix[1] * inverseScale.y,
+                rotationMatrix[2] * inverseScale.z,
+            };
+        }
+    }
+
+#if defined(TRANSFORM_BATCH_X86)
+
+    // SSE2 is part of x86-64, no target needed.
+    namespace Sse {
+
+        struct Lanes {
+            using Float = __m128;
+            using Int = __m128i;
+
+            static constexpr uint32_t WIDTH = 4;
+
+            static Float Set(float value) { return _mm_set1_ps(value); }
+            static Float Load(const float* values) { return _mm_load_ps(values); }
+            static void Store(float* values, Float value) { _mm_store_ps(values, value); }
+
+            static Float Add(Float a, Float b) { return _mm_add_ps(a, b); }
+            static Float Sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+            static Float Mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+            static Float Div(Float a, Float b) { return _mm_div_ps(a, b); }
+
+            static Float And(Float a, Float b) { return _mm_and_ps(a, b); }
+            static Float AndNot(Float a, Float b) { return _mm_andnot_ps(a, b); } // ~a & b
+            static Float Xor(Float a, Float b) { return _mm_xor_ps(a, b); }
+            static Float Select(Float mask, Float a, Float b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+            static Int SetInt(int value) { return _mm_set1_epi32(value); }
+            static Int ToInt(Float value) { return _mm_cvttps_epi32(value); }
+            static Float ToFloat(Int value) { return _mm_cvtepi32_ps(value); }
+            static Float AsFloat(Int value) { return _mm_castsi128_ps(value); }
+            static Int AddInt(Int a, Int b) { return _mm_add_epi32(a, b); }
+            static Int AndInt(Int a, Int b) { return _mm_and_si128(a, b); }
+            static Int AndNotInt(Int a, Int b) { return _mm_andnot_si128(a, b); }
+            static Int EqualInt(Int a, Int b) { return _mm_cmpeq_epi32(a, b); }
+            static Int ShiftLeft29(Int value) { return _mm_slli_epi32(value, 29); }
+        };
+
+        #include "transform_batch_kernel.inl"
+
+    } // namespace Sse
+
+    // Only called once the cpu reported AVX2 and FMA. GCC and Clang need the target for the intrinsics, MSVC takes them as they are.
+    #if defined(__GNUC__)
+        #pragma GCC push_options
+        #pragma GCC target("avx2,fma")
+    #endif
+
+    namespace Avx2 {
+
+        struct Lanes {
+            using Float = __m256;
+            using Int = __m256i;
+
+            static constexpr uint32_t WIDTH = 8;
+
+            static Float Set(float value) { return _mm256_set1_ps(value); }
+            static Float Load(const float* values) { return _mm256_load_ps(values); }
+            static void Store(float* values, Float value) { _mm256_store_ps(values, value); }
+
+            static Float Add(Float a, Float b) { return _mm256_add_ps(a, b); }
+            static Float Sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+            static Float Mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+            static Float Div(Float a, Float b) { return _mm256_div_ps(a, b); }
+
+            static Float And(Float a, Float b) { return _mm256_and_ps(a, b); }
+            static Float AndNot(Float a, Float b) { return _mm256_andnot_ps(a, b); } // ~a & b
+            static Float Xor(Float a, Float b) { return _mm256_xor_ps(a, b); }
+            static Float Select(Float mask, Float a, Float b) { return _mm256_blendv_ps(b, a, mask); }
+
+            static Int SetInt(int value) { return _mm256_set1_epi32(value); }
+            static Int ToInt(Float value) { return _mm256_cvttps_epi32(value); }
+            static Float ToFloat(Int value) { return _mm256_cvtepi32_ps(value); }
+            static Float AsFloat(Int value) { return _mm256_castsi256_ps(value); }
+            static Int AddInt(Int a, Int b) { return _mm256_add_epi32(a, b); }
+            static Int AndInt(Int a, Int b) { return _mm256_and_si256(a, b); }
+            static Int AndNotInt(Int a, Int b) { return _mm256_andnot_si256(a, b); }
+            static Int EqualInt(Int a, Int b) { return _mm256_cmpeq_epi32(a, b); }
+            static Int ShiftLeft29(Int value) { return _mm256_slli_epi32(value, 29); }
+        };
+
+        #include "transform_batch_kernel.inl"
+
+    } // namespace Avx2
+
+    #if defined(__GNUC__)
+        #pragma GCC pop_options
+    #endif
+
+#endif
+
+    void TransformBatch::Compute(const glm::vec3* positions, const glm::vec3* rotations, const glm::vec3* scales, const uint32_t* indices, uint32_t count,
+                                 glm::mat4* modelMatrices, glm::mat3* normalMatrices) {
+        switch (activeInstructionSet) {
+#if defined(TRANSFORM_BATCH_X86)
+            case InstructionSet::Avx2:
+                Avx2::ComputeLanes(positions, rotations, scales, indices, count, modelMatrices, normalMatrices);
+                return;
+            case InstructionSet::Sse:
+                Sse::ComputeLanes(positions, rotations, scales, indices, count, modelMatrices, normalMatrices);
+                return;
+#endif
+            default:
+                ComputeScalar(positions, rotations, scales, indices, count, modelMatrices, normalMatrices);
+                return;
+        }
+    }
+
+    TransformBatch::InstructionSet TransformBatch::GetInstructionSet() {
+        return activeInstructionSet;
+    }
+
+    TransformBatch::InstructionSet TransformBatch::SetInstructionSet(InstructionSet instructionSet) {
+        activeInstructionSet = std::min(instructionSet, supportedInstructionSet);
+        return activeInstructionSet;
+    }
+
+    TransformBatch::InstructionSet TransformBatch::GetSupportedInstructionSet() {
+        return supportedInstructionSet;
+    }
+
+    const char* TransformBatch::GetName(InstructionSet instructionSet) {
+        switch (instructionSet) {
+            case InstructionSet::Avx2:
+                return "AVX2";
+            case InstructionSet::Sse:
+                return "SSE";
+            default:
+                return "scalar";
+        }
+    }
+
+} // namespace Engine
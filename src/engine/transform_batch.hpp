@@ -0,0 +1,38 @@
+#pragma once
+
+// libs
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+
+namespace Engine {
+
+    // Model and normal matrices for many transforms at once, the same matrices as TransformComponent::GetMat4 and
+    // GetNormalMatrix. Runs 8 transforms per step with AVX2, 4 with SSE and one at a time elsewhere, picked at runtime.
+    // The vector paths use a polynomial sin/cos, within a few float ulps of the std one for angles of sane size.
+    class TransformBatch {
+
+    public:
+        enum class InstructionSet {
+            Scalar,
+            Sse,
+            Avx2,
+        };
+
+        // Reads and writes transform indices[i] for i < count, or the first count transforms if indices is null.
+        static void Compute(const glm::vec3* positions, const glm::vec3* rotations, const glm::vec3* scales, const uint32_t* indices, uint32_t count,
+                            glm::mat4* modelMatrices, glm::mat3* normalMatrices);
+
+        // The best one this cpu supports, unless overridden.
+        static InstructionSet GetInstructionSet();
+
+        // For comparing paths, sets outside of what the cpu supports are ignored. Returns the set now in use.
+        static InstructionSet SetInstructionSet(InstructionSet instructionSet);
+
+        static InstructionSet GetSupportedInstructionSet();
+
+        static const char* GetName(InstructionSet instructionSet);
+    };
+
+} // namespace Engine
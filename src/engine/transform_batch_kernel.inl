@@ -0,0 +1,132 @@
+// Lane generic part of TransformBatch, included once per instruction set by transform_batch.cpp with a Lanes struct
+// (Float and Int vector types plus the operations below) in scope. Included inside that instruction set's target
+// region, so every function here is compiled for it.
+
+// Cephes style sin and cos: reduce to [-pi/4, pi/4] around the nearest multiple of pi/2, then pick and sign the two polynomials by octant.
+static inline void SinCos(Lanes::Float x, Lanes::Float& sine, Lanes::Float& cosine) {
+    const Lanes::Float signMask = Lanes::Set(-0.0f);
+
+    Lanes::Float sineSign = Lanes::And(x, signMask);
+    x = Lanes::AndNot(signMask, x);
+
+    Lanes::Int octant = Lanes::ToInt(Lanes::Mul(x, Lanes::Set(1.27323954473516f))); // 4 / pi
+    octant = Lanes::AndInt(Lanes::AddInt(octant, Lanes::SetInt(1)), Lanes::SetInt(~1));
+    const Lanes::Float y = Lanes::ToFloat(octant);
+
+    const Lanes::Float swapSineSign = Lanes::AsFloat(Lanes::ShiftLeft29(Lanes::AndInt(octant, Lanes::SetInt(4))));
+    const Lanes::Float cosineSign = Lanes::AsFloat(Lanes::ShiftLeft29(Lanes::AndNotInt(Lanes::AddInt(octant, Lanes::SetInt(-2)), Lanes::SetInt(4))));
+    const Lanes::Float useSinePolynomial = Lanes::AsFloat(Lanes::EqualInt(Lanes::AndInt(octant, Lanes::SetInt(2)), Lanes::SetInt(0)));
+
+    sineSign = Lanes::Xor(sineSign, swapSineSign);
+
+    // pi / 4 split in three parts, so the reduction stays exact for larger angles
+    x = Lanes::Sub(x, Lanes::Mul(y, Lanes::Set(0.78515625f)));
+    x = Lanes::Sub(x, Lanes::Mul(y, Lanes::Set(2.4187564849853515625e-4f)));
+    x = Lanes::Sub(x, Lanes::Mul(y, Lanes::Set(3.77489497744594108e-8f)));
+
+    const Lanes::Float z = Lanes::Mul(x, x);
+
+    Lanes::Float cosinePolynomial = Lanes::Set(2.443315711809948e-5f);
+    cosinePolynomial = Lanes::Add(Lanes::Mul(cosinePolynomial, z), Lanes::Set(-1.388731625493765e-3f));
+    cosinePolynomial = Lanes::Add(Lanes::Mul(cosinePolynomial, z), Lanes::Set(4.166664568298827e-2f));
+    cosinePolynomial = Lanes::Mul(Lanes::Mul(cosinePolynomial, z), z);
+    cosinePolynomial = Lanes::Sub(cosinePolynomial, Lanes::Mul(z, Lanes::Set(0.5f)));
+    cosinePolynomial = Lanes::Add(cosinePolynomial, Lanes::Set(1.0f));
+
+    Lanes::Float sinePolynomial = Lanes::Set(-1.9515295891e-4f);
+    sinePolynomial = Lanes::Add(Lanes::Mul(sinePolynomial, z), Lanes::Set(8.3321608736e-3f));
+    sinePolynomial = Lanes::Add(Lanes::Mul(sinePolynomial, z), Lanes::Set(-1.6666654611e-1f));
+    sinePolynomial = Lanes::Add(Lanes::Mul(Lanes::Mul(sinePolynomial, z), x), x);
+
+    sine = Lanes::Xor(Lanes::Select(useSinePolynomial, sinePolynomial, cosinePolynomial), sineSign);
+    cosine = Lanes::Xor(Lanes::Select(useSinePolynomial, cosinePolynomial, sinePolynomial), cosineSign);
+}
+
+static void ComputeLanes(const glm::vec3* positions, const glm::vec3* rotations, const glm::vec3* scales, const uint32_t* indices, uint32_t count,
+                         glm::mat4* modelMatrices, glm::mat3* normalMatrices) {
+    constexpr uint32_t WIDTH = Lanes::WIDTH;
+
+    // Transposed through these, the vec3 arrays hold x, y and z next to each other and the lanes want them apart.
+    alignas(32) float input[9][WIDTH];
+    alignas(32) float output[25][WIDTH]; // 16 model matrix floats, then 9 normal matrix floats, column major
+
+    uint32_t transformIndices[WIDTH];
+
+    for (uint32_t first = 0; first < count; first += WIDTH) {
+        const uint32_t laneCount = std::min(WIDTH, count - first);
+
+        for (uint32_t lane = 0; lane < WIDTH; lane++) {
+            if (lane >= laneCount) { // rotation 0, scale 1, nothing that divides by zero
+                for (uint32_t component = 0; component < 6; component++) {
+                    input[component][lane] = 0.0f;
+                }
+
+                input[6][lane] = input[7][lane] = input[8][lane] = 1.0f;
+                continue;
+            }
+
+            const uint32_t index = indices != nullptr ? indices[first + lane] : first + lane;
+            transformIndices[lane] = index;
+
+            for (uint32_t component = 0; component < 3; component++) {
+                input[component][lane] = positions[index][component];
+                input[3 + component][lane] = rotations[index][component];
+                input[6 + component][lane] = scales[index][component];
+            }
+        }
+
+        Lanes::Float s1, c1, s2, c2, s3, c3;
+        SinCos(Lanes::Load(input[4]), s1, c1); // y
+        SinCos(Lanes::Load(input[3]), s2, c2); // x
+        SinCos(Lanes::Load(input[5]), s3, c3); // z
+
+        // Ry * Rx * Rz, columns r0, r1, r2
+        const Lanes::Float s1s2 = Lanes::Mul(s1, s2);
+        const Lanes::Float c1s2 = Lanes::Mul(c1, s2);
+
+        const Lanes::Float rotation[9] {
+            Lanes::Add(Lanes::Mul(c1, c3), Lanes::Mul(s1s2, s3)),
+            Lanes::Mul(c2, s3),
+            Lanes::Sub(Lanes::Mul(c1s2, s3), Lanes::Mul(c3, s1)),
+
+            Lanes::Sub(Lanes::Mul(c3, s1s2), Lanes::Mul(c1, s3)),
+            Lanes::Mul(c2, c3),
+            Lanes::Add(Lanes::Mul(c1s2, c3), Lanes::Mul(s1, s3)),
+
+            Lanes::Mul(c2, s1),
+            Lanes::Sub(Lanes::Set(0.0f), s2),
+            Lanes::Mul(c1, c2),
+        };
+
+        const Lanes::Float one = Lanes::Set(1.0f);
+        const Lanes::Float zero = Lanes::Set(0.0f);
+
+        for (uint32_t column = 0; column < 3; column++) {
+            const Lanes::Float scale = Lanes::Load(input[6 + column]);
+            const Lanes::Float inverseScale = Lanes::Div(one, scale);
+
+            for (uint32_t row = 0; row < 3; row++) {
+                Lanes::Store(output[column * 4 + row], Lanes::Mul(rotation[column * 3 + row], scale));
+                Lanes::Store(output[16 + column * 3 + row], Lanes::Mul(rotation[column * 3 + row], inverseScale));
+            }
+
+            Lanes::Store(output[column * 4 + 3], zero);
+            Lanes::Store(output[12 + column], Lanes::Load(input[column]));
+        }
+
+        Lanes::Store(output[15], one);
+
+        for (uint32_t lane = 0; lane < laneCount; lane++) {
+            float* modelMatrix = &modelMatrices[transformIndices[lane]][0][0];
+            float* normalMatrix = &normalMatrices[transformIndices[lane]][0][0];
+
+            for (uint32_t i = 0; i < 16; i++) {
+                modelMatrix[i] = output[i][lane];
+            }
+
+            for (uint32_t i = 0; i < 9; i++) {
+                normalMatrix[i] = output[16 + i][lane];
+            }
+        }
+    }
+}
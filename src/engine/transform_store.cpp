@@ -0,0 +1,383 @@
+#include "transform_store.hpp"
+
+#include "job_system.hpp"
+#include "transform_batch.hpp"
+
+// std
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace Engine {
+
+    void TransformStore::Add(Entity entity, const TransformComponent& transform) {
+        const uint32_t index = Insert(entity);
+
+        _positions.push_back(transform.Position);
+        _rotations.push_back(transform.Rotation);
+        _scales.push_back(transform.Scale);
+
+        _previousPositions.push_back(transform.Position);
+        _previousRotations.push_back(transform.Rotation);
+        _previousScales.push_back(transform.Scale);
+
+        _parents.push_back(INVALID_ENTITY);
+        _childCounts.push_back(0);
+        _flags.push_back(0);
+        _updatedAt.push_back(_updateCount - 1);
+
+        _localMatrices.emplace_back(1.0f);
+        _localNormalMatrices.emplace_back(1.0f);
+        _worldMatrices.emplace_back(1.0f);
+        _normalMatrices.emplace_back(1.0f);
+
+        MarkDirty(index, LOCAL_DIRTY);
+    }
+
+    void TransformStore::AddRange(const Entity* entities, uint32_t count, const glm::vec3* positions, const glm::vec3* rotations, const glm::vec3* scales,
+                                  const uint32_t* parentIndices) {
+        if (count == 0) {
+            return;
+        }
+
+        const uint32_t first = InsertRange(entities, count);
+
+        _positions.insert(_positions.end(), positions, positions + count);
+        _rotations.insert(_rotations.end(), rotations, rotations + count);
+        _scales.insert(_scales.end(), scales, scales + count);
+
+        _previousPositions.insert(_previousPositions.end(), positions, positions + count);
+        _previousRotations.insert(_previousRotations.end(), rotations, rotations + count);
+        _previousScales.insert(_previousScales.end(), scales, scales + count);
+
+        _parents.resize(first + count, INVALID_ENTITY);
+        _childCounts.resize(first + count, 0);
+        _flags.resize(first + count, LOCAL_DIRTY);
+        _updatedAt.resize(first + count, _updateCount - 1);
+
+        _localMatrices.resize(first + count, glm::mat4 { 1.0f });
+        _localNormalMatrices.resize(first + count, glm::mat3 { 1.0f });
+        _worldMatrices.resize(first + count, glm::mat4 { 1.0f });
+        _normalMatrices.resize(first + count, glm::mat3 { 1.0f });
+
+        for (uint32_t i = 0; i < count; i++) {
+            if (parentIndices[i] == INVALID_INDEX) {
+                continue;
+            }
+
+            _parents[first + i] = entities[parentIndices[i]];
+            _childCounts[first + parentIndices[i]]++;
+            _isUnordered |= parentIndices[i] > i;
+        }
+
+        _firstDirty = std::min(_firstDirty, first);
+    }
+
+    void TransformStore::Remove(Entity entity) {
+        const uint32_t removedIndex = IndexOf(entity);
+        const Entity parent = _parents[removedIndex];
+
+        if (parent != INVALID_ENTITY && Contains(parent)) {
+            _childCounts[IndexOf(parent)]--;
+        }
+
+        _hasOrphans |= _childCounts[removedIndex] > 0;
+
+        if ((_flags[removedIndex] & STEPPED) != 0) {
+            _steppedCount--;
+        }
+
+        const uint32_t index = Erase(entity);
+
+        EraseAt(_positions, index);
+        EraseAt(_rotations, index);
+        EraseAt(_scales, index);
+        EraseAt(_previousPositions, index);
+        EraseAt(_previousRotations, index);
+        EraseAt(_previousScales, index);
+        EraseAt(_parents, index);
+        EraseAt(_childCounts, index);
+        EraseAt(_flags, index);
+        EraseAt(_updatedAt, index);
+        EraseAt(_localMatrices, index);
+        EraseAt(_localNormalMatrices, index);
+        EraseAt(_worldMatrices, index);
+        EraseAt(_normalMatrices, index);
+
+        if (index == GetSize()) {
+            return;
+        }
+
+        // The last transform moved into the hole. In breadth first order the last one has no children, only its parent can be out of place now.
+        if (_parents[index] != INVALID_ENTITY && IndexOf(_parents[index]) != INVALID_INDEX && IndexOf(_parents[index]) > index) {
+            _isUnordered = true;
+        }
+
+        MarkDirty(index, WORLD_DIRTY); // same matrices, but at an index that held another transform's
+    }
+
+    void TransformStore::Set(uint32_t index, const TransformComponent& transform) {
+        _positions[index] = transform.Position;
+        _rotations[index] = transform.Rotation;
+        _scales[index] = transform.Scale;
+
+        if ((_flags[index] & STEPPED) == 0) {
+            _steppedCount++;
+        }
+
+        MarkDirty(index, LOCAL_DIRTY | STEPPED);
+    }
+
+    void TransformStore::SetParent(Entity entity, Entity parent) {
+        const uint32_t index = IndexOf(entity);
+        const Entity oldParent = _parents[index];
+
+        if (parent == oldParent) {
+            return;
+        }
+
+        if (parent != INVALID_ENTITY && (!Contains(parent) || IsAncestor(entity, parent))) {
+            throw std::runtime_error("Cannot parent an entity to a dead entity, itself or one of its children");
+        }
+
+        if (oldParent != INVALID_ENTITY && Contains(oldParent)) {
+            _childCounts[IndexOf(oldParent)]--;
+        }
+
+        _parents[index] = parent;
+
+        if (parent != INVALID_ENTITY) {
+            const uint32_t parentIndex = IndexOf(parent);
+
+            _childCounts[parentIndex]++;
+            _isUnordered |= parentIndex > index;
+        }
+
+        MarkDirty(index, WORLD_DIRTY);
+    }
+
+    void TransformStore::BeginStep() {
+        if (_steppedCount == 0) {
+            return;
+        }
+
+        for (uint32_t i = 0; i < GetSize(); i++) {
+            if ((_flags[i] & STEPPED) != 0) {
+                _previousPositions[i] = _positions[i];
+                _previousRotations[i] = _rotations[i];
+                _previousScales[i] = _scales[i];
+
+                _flags[i] &= ~STEPPED;
+                MarkDirty(i, LOCAL_DIRTY);
+            }
+        }
+
+        _steppedCount = 0;
+    }
+
+    void TransformStore::SetInterpolation(float alpha) {
+        if (alpha == _interpolation) {
+            return;
+        }
+
+        _interpolation = alpha;
+
+        if (_steppedCount == 0) {
+            return;
+        }
+
+        for (uint32_t i = 0; i < GetSize(); i++) {
+            if ((_flags[i] & STEPPED) != 0) {
+                MarkDirty(i, LOCAL_DIRTY);
+            }
+        }
+    }
+
+    void TransformStore::Update(JobSystem* jobSystem) {
+        _updateCount++;
+        _updatedIndices.clear();
+
+        if (_hasOrphans) {
+            DetachOrphans();
+        }
+
+        if (_isUnordered) {
+            SortByDepth();
+        }
+
+        // Local matrices first, all in one batch so the trig runs several transforms wide. Stepped transforms are
+        // blended into separate arrays first and go through a batch of their own.
+        _localDirtyIndices.clear();
+        _blendedIndices.clear();
+        _blendedPositions.clear();
+        _blendedRotations.clear();
+        _blendedScales.clear();
+
+        for (uint32_t i = _firstDirty; i < GetSize(); i++) {
+            if ((_flags[i] & LOCAL_DIRTY) == 0) {
+                continue;
+            }
+
+            if ((_flags[i] & STEPPED) == 0) {
+                _localDirtyIndices.push_back(i);
+                continue;
+            }
+
+            const TransformComponent previous { _previousPositions[i], _previousScales[i], _previousRotations[i] };
+            const TransformComponent blended = TransformComponent::Interpolate(previous, Get(i), _interpolation);
+
+            _blendedIndices.push_back(i);
+            _blendedPositions.push_back(blended.Position);
+            _blendedRotations.push_back(blended.Rotation);
+            _blendedScales.push_back(blended.Scale);
+        }
+
+        const uint32_t localDirtyCount = static_cast<uint32_t>(_localDirtyIndices.size());
+        const uint32_t blendedCount = static_cast<uint32_t>(_blendedIndices.size());
+
+        _blendedLocalMatrices.resize(blendedCount);
+        _blendedLocalNormalMatrices.resize(blendedCount);
+
+        auto computeLocalMatrices = [this](uint32_t begin, uint32_t end) {
+            TransformBatch::Compute(_positions.data(), _rotations.data(), _scales.data(), _localDirtyIndices.data() + begin, end - begin,
+                                    _localMatrices.data(), _localNormalMatrices.data());
+        };
+
+        auto computeBlendedMatrices = [this](uint32_t begin, uint32_t end) {
+            TransformBatch::Compute(_blendedPositions.data() + begin, _blendedRotations.data() + begin, _blendedScales.data() + begin, nullptr, end - begin,
+                                    _blendedLocalMatrices.data() + begin, _blendedLocalNormalMatrices.data() + begin);
+        };
+
+        if (jobSystem != nullptr) {
+            jobSystem->ParallelFor(localDirtyCount, LOCAL_MATRIX_GRAIN_SIZE, computeLocalMatrices);
+            jobSystem->ParallelFor(blendedCount, LOCAL_MATRIX_GRAIN_SIZE, computeBlendedMatrices);
+        }
+        else {
+            computeLocalMatrices(0, localDirtyCount);
+            computeBlendedMatrices(0, blendedCount);
+        }
+
+        for (uint32_t i = 0; i < blendedCount; i++) {
+            _localMatrices[_blendedIndices[i]] = _blendedLocalMatrices[i];
+            _localNormalMatrices[_blendedIndices[i]] = _blendedLocalNormalMatrices[i];
+        }
+
+        // Parents come first, by the time we get to a transform its parent is up to date and knows whether it changed.
+        for (uint32_t i = _firstDirty; i < GetSize(); i++) {
+            uint8_t flags = _flags[i] & DIRTY;
+            const uint32_t parentIndex = _parents[i] != INVALID_ENTITY ? IndexOf(_parents[i]) : INVALID_INDEX;
+
+            if (parentIndex != INVALID_INDEX && _updatedAt[parentIndex] == _updateCount) {
+                flags |= WORLD_DIRTY;
+            }
+
+            if (flags == 0) {
+                continue;
+            }
+
+            // The inverse transpose of a product is the product of the inverse transposes, normal matrices chain like the matrices do.
+            if (parentIndex == INVALID_INDEX) {
+                _worldMatrices[i] = _localMatrices[i];
+                _normalMatrices[i] = _localNormalMatrices[i];
+            }
+            else {
+                _worldMatrices[i] = _worldMatrices[parentIndex] * _localMatrices[i];
+                _normalMatrices[i] = _normalMatrices[parentIndex] * _localNormalMatrices[i];
+            }
+
+            _flags[i] &= ~DIRTY;
+            _updatedAt[i] = _updateCount;
+            _updatedIndices.push_back(i);
+        }
+
+        _firstDirty = UINT32_MAX;
+    }
+
+    void TransformStore::MarkDirty(uint32_t index, uint8_t flags) {
+        _flags[index] |= flags;
+        _firstDirty = std::min(_firstDirty, index);
+    }
+
+    bool TransformStore::IsAncestor(Entity ancestor, Entity entity) const {
+        for (Entity current = entity; current != INVALID_ENTITY && Contains(current); current = _parents[IndexOf(current)]) {
+            if (current == ancestor) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void TransformStore::DetachOrphans() {
+        for (uint32_t i = 0; i < GetSize(); i++) {
+            if (_parents[i] != INVALID_ENTITY && !Contains(_parents[i])) {
+                _parents[i] = INVALID_ENTITY;
+                MarkDirty(i, WORLD_DIRTY);
+            }
+        }
+
+        _hasOrphans = false;
+    }
+
+    std::vector<uint32_t> TransformStore::GetDepthOrder() const {
+        std::vector<uint32_t> depths(GetSize(), UINT32_MAX);
+        std::vector<uint32_t> chain {};
+
+        for (uint32_t i = 0; i < GetSize(); i++) {
+            chain.clear();
+
+            uint32_t index = i;
+
+            while (index != INVALID_INDEX && depths[index] == UINT32_MAX) {
+                chain.push_back(index);
+                index = _parents[index] != INVALID_ENTITY ? IndexOf(_parents[index]) : INVALID_INDEX;
+            }
+
+            uint32_t depth = index != INVALID_INDEX ? depths[index] + 1 : 0;
+
+            for (auto it = chain.rbegin(); it != chain.rend(); it++) {
+                depths[*it] = depth++;
+            }
+        }
+
+        std::vector<uint32_t> order(GetSize());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&depths](uint32_t a, uint32_t b) { return depths[a] < depths[b]; });
+
+        return order;
+    }
+
+    // Only after the hierarchy changed in a way that put a child ahead of its parent.
+    void TransformStore::SortByDepth() {
+        const std::vector<uint32_t> order = GetDepthOrder();
+
+        Permute(order);
+
+        Reorder(_positions, order);
+        Reorder(_rotations, order);
+        Reorder(_scales, order);
+        Reorder(_previousPositions, order);
+        Reorder(_previousRotations, order);
+        Reorder(_previousScales, order);
+        Reorder(_parents, order);
+        Reorder(_childCounts, order);
+        Reorder(_flags, order);
+        Reorder(_updatedAt, order);
+        Reorder(_localMatrices, order);
+        Reorder(_localNormalMatrices, order);
+        Reorder(_worldMatrices, order);
+        Reorder(_normalMatrices, order);
+
+        auto firstDirty = std::find_if(_flags.begin(), _flags.end(), [](uint8_t flags) { return (flags & DIRTY) != 0; });
+        _firstDirty = firstDirty != _flags.end() ? static_cast<uint32_t>(firstDirty - _flags.begin()) : UINT32_MAX;
+
+        for (uint32_t i = 0; i < GetSize(); i++) {
+            if (order[i] != i) {
+                MarkDirty(i, WORLD_DIRTY);
+            }
+        }
+
+        _isUnordered = false;
+    }
+
+} // namespace Engine
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "component_store.hpp"
+#include "components.hpp"
+
+// libs
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+
+    class JobSystem;
+
+    // Transforms as separate arrays, a system that only needs world matrices streams through those alone.
+    //
+    // Local and world matrices are cached and only recomputed for transforms that changed, or whose parent did.
+    // The arrays are kept in breadth first order (every parent before its children), so Update is a single forward
+    // pass starting at the first dirty transform, and it returns right away when nothing moved.
+    //
+    // For a fixed timestep simulation the local transforms are double buffered. Transforms Set during a step keep the
+    // state they had before it too, and are drawn in between at the interpolation rendering asks for, so the frame
+    // rate does not have to follow the simulation rate.
+    class TransformStore : public SparseSet {
+
+    public:
+        static constexpr uint32_t LOCAL_MATRIX_GRAIN_SIZE = 2048; // smallest batch of local matrices worth a job
+
+        void Add(Entity entity, const TransformComponent& transform);
+
+        // Bulk copies of the arrays, for loading many at once. parentIndices[i] points into entities, INVALID_INDEX for roots.
+        void AddRange(const Entity* entities, uint32_t count, const glm::vec3* positions, const glm::vec3* rotations, const glm::vec3* scales,
+                      const uint32_t* parentIndices);
+        void Remove(Entity entity);
+
+        // Local transform, relative to the parent.
+        TransformComponent Get(uint32_t index) const {
+            return TransformComponent { _positions[index], _scales[index], _rotations[index] };
+        }
+
+        void Set(uint32_t index, const TransformComponent& transform);
+
+        // INVALID_ENTITY makes it a root. Children of a removed entity become roots, their local transform is kept as it is.
+        void SetParent(Entity entity, Entity parent);
+
+        Entity GetParent(Entity entity) const {
+            return _parents[IndexOf(entity)];
+        }
+
+        // Indices sorted so every parent comes before its children, stable otherwise. Right after Update this is 0, 1, 2...
+        std::vector<uint32_t> GetDepthOrder() const;
+
+        // Call before every simulation step. What moved in the step before is now drawn where it is.
+        void BeginStep();
+
+        // How far rendering is from the state before the last step (0) to the state after it (1).
+        void SetInterpolation(float alpha);
+
+        float GetInterpolation() const {
+            return _interpolation;
+        }
+
+        // Brings every world matrix up to date, once per frame after gameplay moved things and before anything reads them.
+        // With a job system the local matrices are split over its threads.
+        void Update(JobSystem* jobSystem = nullptr);
+
+        const glm::vec3* GetPositions() const {
+            return _positions.data();
+        }
+
+        const glm::vec3* GetRotations() const {
+            return _rotations.data();
+        }
+
+        const glm::vec3* GetScales() const {
+            return _scales.data();
+        }
+
+        const glm::mat4& GetWorldMatrix(uint32_t index) const {
+            return _worldMatrices[index];
+        }
+
+        const glm::mat3& GetNormalMatrix(uint32_t index) const {
+            return _normalMatrices[index];
+        }
+
+        glm::vec3 GetWorldPosition(uint32_t index) const {
+            return glm::vec3 { _worldMatrices[index][3] };
+        }
+
+        // True if the world matrix changed in the last Update. A transform that moved to another index counts too, so
+        // anything kept by index in step with these arrays only has to look at the updated ones.
+        bool WasUpdated(uint32_t index) const {
+            return _updatedAt[index] == _updateCount;
+        }
+
+        // Indices WasUpdated is true for, in order.
+        const std::vector<uint32_t>& GetUpdatedIndices() const {
+            return _updatedIndices;
+        }
+
+        uint32_t GetUpdatedCount() const {
+            return static_cast<uint32_t>(_updatedIndices.size());
+        }
+
+    private:
+        enum Flags : uint8_t {
+            LOCAL_DIRTY = 1 << 0,
+            WORLD_DIRTY = 1 << 1,
+            DIRTY = LOCAL_DIRTY | WORLD_DIRTY,
+            STEPPED = 1 << 2, // Set since the last BeginStep, drawn between the previous and the current state
+        };
+
+        void MarkDirty(uint32_t index, uint8_t flags);
+        bool IsAncestor(Entity ancestor, Entity entity) const;
+        void DetachOrphans();
+        void SortByDepth();
+
+    private:
+        std::vector<glm::vec3> _positions {};
+        std::vector<glm::vec3> _rotations {};
+        std::vector<glm::vec3> _scales {};
+
+        // The state before the last step, the same as the current one unless STEPPED.
+        std::vector<glm::vec3> _previousPositions {};
+        std::vector<glm::vec3> _previousRotations {};
+        std::vector<glm::vec3> _previousScales {};
+
+        std::vector<Entity> _parents {};
+        std::vector<uint32_t> _childCounts {};
+        std::vector<uint8_t> _flags {};
+        std::vector<uint32_t> _updatedAt {}; // update count of the last Update that changed the world matrix
+
+        std::vector<glm::mat4> _localMatrices {};
+        std::vector<glm::mat3> _localNormalMatrices {};
+        std::vector<glm::mat4> _worldMatrices {};
+        std::vector<glm::mat3> _normalMatrices {};
+
+        std::vector<uint32_t> _localDirtyIndices {};
+        std::vector<uint32_t> _updatedIndices {};
+
+        // Interpolated local transforms of the STEPPED ones among them, packed.
+        std::vector<uint32_t> _blendedIndices {};
+        std::vector<glm::vec3> _blendedPositions {};
+        std::vector<glm::vec3> _blendedRotations {};
+        std::vector<glm::vec3> _blendedScales {};
+        std::vector<glm::mat4> _blendedLocalMatrices {};
+        std::vector<glm::mat3> _blendedLocalNormalMatrices {};
+
+        uint32_t _firstDirty { UINT32_MAX };
+        uint32_t _updateCount { 0 };
+        uint32_t _steppedCount { 0 };
+        float _interpolation { 1.0f };
+        bool _hasOrphans { false };
+        bool _isUnordered { false }; // some parent comes after its child
+    };
+
+} // namespace Engine
@@ -0,0 +1,388 @@
+#include "upload_manager.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace Engine {
+
+    UploadManager::UploadManager(Device& device, VkDeviceSize ringSize)
+        : _device(device), _ringSize(ringSize)
+    {
+        assert(_ringSize % UPLOAD_ALIGNMENT == 0 && "Upload ring size must be a multiple of UPLOAD_ALIGNMENT.");
+
+        _ring = std::make_unique<VulkanBuffer> (
+            _device,
+            _ringSize,
+            1,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+        );
+
+        _ring->map();
+
+        QueueFamilyIndices queueFamilyIndices = _device.findPhysicalQueueFamilies();
+        _dedicatedTransfer = _device.hasDedicatedTransferQueue();
+        _transferFamily = queueFamilyIndices.transferFamily;
+        _graphicsFamily = queueFamilyIndices.graphicsFamily;
+    }
+
+    UploadManager::~UploadManager() {
+        Flush();
+
+        while (!_submittedBatches.empty()) {
+            RetireOldest();
+        }
+
+        for (auto& batch : _freeBatches) {
+            vkFreeCommandBuffers(_device.device(), _device.getTransferCommandPool(), 1, &batch.CommandBuffer);
+            vkDestroyFence(_device.device(), batch.Fence, nullptr);
+
+            if (_dedicatedTransfer) {
+                vkFreeCommandBuffers(_device.device(), _device.getCommandPool(), 1, &batch.AcquireCommandBuffer);
+                vkDestroySemaphore(_device.device(), batch.TransferDone, nullptr);
+            }
+        }
+    }
+
+    UploadManager::Ticket UploadManager::Upload(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        Ticket ticket = _completedTicket;
+
+        _stats.UploadedBytes += size;
+        _stats.UploadCount++;
+
+        // Anything bigger than the ring goes through it in ring sized pieces.
+        while (size > 0) {
+            const VkDeviceSize chunkSize = std::min(size, _ringSize);
+            const VkDeviceSize ringOffset = AllocateRing(chunkSize);
+
+            if (!_recording) {
+                BeginBatch();
+            }
+
+            std::memcpy(static_cast<uint8_t*>(_ring->getMappedMemory()) + ringOffset, bytes, chunkSize);
+
+            VkBufferCopy copyRegion { ringOffset, dstOffset, chunkSize };
+            vkCmdCopyBuffer(_openBatch.CommandBuffer, _ring->getBuffer(), dstBuffer, 1, &copyRegion);
+
+            if (_dedicatedTransfer) {
+                VkBufferMemoryBarrier barrier {};
+                barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                barrier.srcQueueFamilyIndex = _transferFamily;
+                barrier.dstQueueFamilyIndex = _graphicsFamily;
+                barrier.buffer = dstBuffer;
+                barrier.offset = dstOffset;
+                barrier.size = chunkSize;
+
+                _ownershipBarriers.push_back(barrier);
+            }
+
+            _openBatch.RingEnd = _ringHead;
+            ticket = _openBatch.ID;
+
+            bytes += chunkSize;
+            dstOffset += chunkSize;
+            size -= chunkSize;
+        }
+
+        return ticket;
+    }
+
+    UploadManager::Ticket UploadManager::Copy(VkBuffer srcBuffer, VkBuffer dstBuffer, const std::vector<VkBufferCopy>& regions) {
+        if (!_recording) {
+            BeginBatch();
+        }
+
+        _copies.push_back({ srcBuffer, dstBuffer, regions });
+
+        return _openBatch.ID;
+    }
+
+    UploadManager::Ticket UploadManager::Flush() {
+        if (_recording) {
+            if (_dedicatedTransfer) {
+                SubmitOwnershipTransfer();
+            }
+            else {
+                SubmitTransfer();
+            }
+
+            _submittedBatches.push_back(_openBatch);
+            _recording = false;
+            _stats.SubmitCount++;
+        }
+
+        RetireCompleted();
+
+        return _nextTicket - 1;
+    }
+
+    bool UploadManager::IsComplete(Ticket ticket) {
+        RetireCompleted();
+
+        return ticket <= _completedTicket;
+    }
+
+    void UploadManager::Wait(Ticket ticket) {
+        if (_recording && ticket >= _openBatch.ID) {
+            Flush();
+        }
+
+        while (_completedTicket < ticket && !_submittedBatches.empty()) {
+            RetireOldest();
+        }
+    }
+
+    void UploadManager::BeginBatch() {
+        if (_freeBatches.empty()) {
+            Batch batch {};
+
+            VkCommandBufferAllocateInfo allocInfo {};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandPool = _device.getTransferCommandPool();
+            allocInfo.commandBufferCount = 1;
+
+            if (vkAllocateCommandBuffers(_device.device(), &allocInfo, &batch.CommandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to allocate upload command buffer");
+            }
+
+            if (_dedicatedTransfer) {
+                allocInfo.commandPool = _device.getCommandPool();
+
+                if (vkAllocateCommandBuffers(_device.device(), &allocInfo, &batch.AcquireCommandBuffer) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to allocate upload acquire command buffer");
+                }
+
+                VkSemaphoreCreateInfo semaphoreInfo {};
+                semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+                if (vkCreateSemaphore(_device.device(), &semaphoreInfo, nullptr, &batch.TransferDone) != VK_SUCCESS) {
+                    throw std::runtime_error("Failed to create upload semaphore");
+                }
+            }
+
+            VkFenceCreateInfo fenceInfo {};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+            if (vkCreateFence(_device.device(), &fenceInfo, nullptr, &batch.Fence) != VK_SUCCESS) {
+                throw std::runtime_error("Failed to create upload fence");
+            }
+
+            _freeBatches.push_back(batch);
+        }
+
+        _openBatch = _freeBatches.back();
+        _freeBatches.pop_back();
+
+        _openBatch.ID = _nextTicket++;
+        _openBatch.RingEnd = _ringHead;
+
+        VkCommandBufferBeginInfo beginInfo {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        if (vkBeginCommandBuffer(_openBatch.CommandBuffer, &beginInfo) != VK_SUCCESS) { // resets it, the pool allows that
+            throw std::runtime_error("Failed to begin upload command buffer");
+        }
+
+        _recording = true;
+    }
+
+    // The sources may have been written by the batch's uploads, or by the copy before when a buffer moved twice.
+    // The barrier after the copies is left to the caller.
+    void UploadManager::RecordCopies(VkCommandBuffer commandBuffer) {
+        VkMemoryBarrier barrier {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        for (const auto& copy : _copies) {
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+            vkCmdCopyBuffer(commandBuffer, copy.Source, copy.Destination, static_cast<uint32_t>(copy.Regions.size()), copy.Regions.data());
+        }
+
+        _copies.clear();
+    }
+
+    // Everything on the graphics queue, the barrier covers later submissions reading the data as vertices and indices,
+    // or copying it again when the geometry pool moves it.
+    void UploadManager::SubmitTransfer() {
+        RecordCopies(_openBatch.CommandBuffer);
+
+        VkMemoryBarrier barrier {};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        vkCmdPipelineBarrier (
+            _openBatch.CommandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr
+        );
+
+        if (vkEndCommandBuffer(_openBatch.CommandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to record upload command buffer");
+        }
+
+        VkSubmitInfo submitInfo {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &_openBatch.CommandBuffer;
+
+        if (vkQueueSubmit(_device.graphicsQueue(), 1, &submitInfo, _openBatch.Fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit upload command buffer");
+        }
+    }
+
+    // Buffers are exclusive to one queue family, the transfer queue releases the written ranges and the graphics
+    // queue acquires them with the same barriers once the semaphore says the copies are done.
+    void UploadManager::SubmitOwnershipTransfer() {
+        const VkPipelineStageFlags acquireStages = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+        for (auto& barrier : _ownershipBarriers) {
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = 0;
+        }
+
+        vkCmdPipelineBarrier (
+            _openBatch.CommandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0,
+            0, nullptr,
+            static_cast<uint32_t>(_ownershipBarriers.size()), _ownershipBarriers.data(),
+            0, nullptr
+        );
+
+        if (vkEndCommandBuffer(_openBatch.CommandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to record upload command buffer");
+        }
+
+        VkSubmitInfo transferSubmitInfo {};
+        transferSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        transferSubmitInfo.commandBufferCount = 1;
+        transferSubmitInfo.pCommandBuffers = &_openBatch.CommandBuffer;
+        transferSubmitInfo.signalSemaphoreCount = 1;
+        transferSubmitInfo.pSignalSemaphores = &_openBatch.TransferDone;
+
+        if (vkQueueSubmit(_device.transferQueue(), 1, &transferSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit upload command buffer");
+        }
+
+        VkCommandBufferBeginInfo beginInfo {};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        if (vkBeginCommandBuffer(_openBatch.AcquireCommandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to begin upload acquire command buffer");
+        }
+
+        for (auto& barrier : _ownershipBarriers) {
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        }
+
+        vkCmdPipelineBarrier (
+            _openBatch.AcquireCommandBuffer,
+            acquireStages,
+            acquireStages,
+            0,
+            0, nullptr,
+            static_cast<uint32_t>(_ownershipBarriers.size()), _ownershipBarriers.data(),
+            0, nullptr
+        );
+
+        if (!_copies.empty()) {
+            RecordCopies(_openBatch.AcquireCommandBuffer);
+
+            VkMemoryBarrier copyBarrier {};
+            copyBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            copyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            copyBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+            vkCmdPipelineBarrier(_openBatch.AcquireCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, acquireStages, 0, 1, &copyBarrier, 0, nullptr, 0, nullptr);
+        }
+
+        if (vkEndCommandBuffer(_openBatch.AcquireCommandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to record upload acquire command buffer");
+        }
+
+        VkSubmitInfo acquireSubmitInfo {};
+        acquireSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        acquireSubmitInfo.waitSemaphoreCount = 1;
+        acquireSubmitInfo.pWaitSemaphores = &_openBatch.TransferDone;
+        acquireSubmitInfo.pWaitDstStageMask = &acquireStages;
+        acquireSubmitInfo.commandBufferCount = 1;
+        acquireSubmitInfo.pCommandBuffers = &_openBatch.AcquireCommandBuffer;
+
+        if (vkQueueSubmit(_device.graphicsQueue(), 1, &acquireSubmitInfo, _openBatch.Fence) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to submit upload acquire command buffer");
+        }
+
+        _ownershipBarriers.clear();
+    }
+
+    // Returns the ring offset of size free bytes, submits the open batch and waits for the oldest ones while there is not enough room.
+    VkDeviceSize UploadManager::AllocateRing(VkDeviceSize size) {
+        assert(size <= _ringSize && "Upload chunk does not fit the ring.");
+
+        RetireCompleted();
+
+        while (true) {
+            // Nothing in flight, start over at the front so a full ring sized chunk fits as well. An empty ring is not
+            // enough: a batch of copies only holds no ring space, but still moves the tail to its RingEnd when it retires.
+            if (_submittedBatches.empty() && !_recording) {
+                assert(_ringTail == _ringHead && "Upload ring space held without a batch.");
+                _ringHead = 0;
+                _ringTail = 0;
+            }
+
+            uint64_t start = (_ringHead + UPLOAD_ALIGNMENT - 1) & ~static_cast<uint64_t>(UPLOAD_ALIGNMENT - 1);
+
+            if (start % _ringSize + size > _ringSize) { // would run past the end, skip to the front
+                start += _ringSize - start % _ringSize;
+            }
+
+            if (start + size - _ringTail <= _ringSize) {
+                _ringHead = start + size;
+                return start % _ringSize;
+            }
+
+            if (_recording) { // the open batch holds part of the ring too
+                Flush();
+                continue;
+            }
+
+            _stats.StallCount++;
+            RetireOldest();
+        }
+    }
+
+    void UploadManager::RetireCompleted() {
+        while (!_submittedBatches.empty() && vkGetFenceStatus(_device.device(), _submittedBatches.front().Fence) == VK_SUCCESS) {
+            RetireOldest();
+        }
+    }
+
+    void UploadManager::RetireOldest() {
+        Batch batch = _submittedBatches.front();
+        _submittedBatches.pop_front();
+
+        vkWaitForFences(_device.device(), 1, &batch.Fence, VK_TRUE, UINT64_MAX);
+        vkResetFences(_device.device(), 1, &batch.Fence);
+
+        _ringTail = batch.RingEnd;
+        _completedTicket = batch.ID;
+
+        _freeBatches.push_back(batch);
+    }
+
+} // namespace Engine
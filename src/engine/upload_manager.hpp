@@ -0,0 +1,109 @@
+#pragma once
+
+#include "device.hpp"
+#include "vulkan_buffer.hpp"
+
+// std
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace Engine {
+
+    // Streams data into device local buffers through one persistently mapped staging ring. Copies are recorded into
+    // a batch that goes out as a single submission on Flush (or once the ring runs full), each batch signals a fence
+    // that gives its part of the ring back. Main thread only.
+    //
+    // With a dedicated transfer queue the copies run there, next to rendering. The copied ranges are released to the
+    // graphics family and a small command buffer on the graphics queue waits for the batch and acquires them.
+    // Copies between device local buffers always run on the graphics queue, where the buffers they read live.
+    class UploadManager {
+
+    public:
+        using Ticket = uint64_t; // batch an upload went into, batches complete in order
+
+        static constexpr VkDeviceSize DEFAULT_RING_SIZE = 64 * 1024 * 1024;
+        static constexpr VkDeviceSize UPLOAD_ALIGNMENT = 16;
+
+        struct Stats {
+            VkDeviceSize UploadedBytes { 0 };
+            uint64_t UploadCount { 0 };
+            uint64_t SubmitCount { 0 };
+            uint64_t StallCount { 0 }; // times the ring was full and we had to wait for the gpu
+        };
+
+        UploadManager(Device& device, VkDeviceSize ringSize = DEFAULT_RING_SIZE);
+        ~UploadManager();
+
+        UploadManager(const UploadManager&) = delete;
+        UploadManager& operator=(const UploadManager&) = delete;
+
+        // Copies size bytes into the ring and records a copy into dstBuffer, only blocks while the ring is full.
+        // The data is visible to any later submission on the graphics queue once the returned ticket is flushed.
+        Ticket Upload(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+        // Copies regions of one device local buffer into another after everything uploaded so far. Nothing may write
+        // the source once this is called, it has to stay alive until the returned ticket completes.
+        Ticket Copy(VkBuffer srcBuffer, VkBuffer dstBuffer, const std::vector<VkBufferCopy>& regions);
+
+        // Submits the open batch, if there is one, and returns the ticket of the last submitted batch.
+        Ticket Flush();
+
+        bool IsComplete(Ticket ticket);
+        void Wait(Ticket ticket);
+
+        const Stats& GetStats() const {
+            return _stats;
+        }
+
+    private:
+        struct Batch {
+            Ticket ID;
+            VkCommandBuffer CommandBuffer;        // on the transfer queue
+            VkCommandBuffer AcquireCommandBuffer; // on the graphics queue, only with a dedicated transfer queue
+            VkSemaphore TransferDone;             // same
+            VkFence Fence;                        // signals once the graphics queue acquired the data
+            uint64_t RingEnd;                     // the ring is free up to here once the fence signals
+        };
+
+        struct BufferCopy {
+            VkBuffer Source;
+            VkBuffer Destination;
+            std::vector<VkBufferCopy> Regions;
+        };
+
+        void BeginBatch();
+        void RecordCopies(VkCommandBuffer commandBuffer);
+        void SubmitTransfer();
+        void SubmitOwnershipTransfer();
+        VkDeviceSize AllocateRing(VkDeviceSize size);
+        void RetireCompleted();
+        void RetireOldest();
+
+    private:
+        Device& _device;
+
+        VkDeviceSize _ringSize;
+        std::unique_ptr<VulkanBuffer> _ring;
+        uint64_t _ringHead { 0 }; // both keep counting up, the offset in the ring is the value modulo its size
+        uint64_t _ringTail { 0 };
+
+        bool _dedicatedTransfer;
+        uint32_t _transferFamily;
+        uint32_t _graphicsFamily;
+
+        bool _recording { false };
+        Batch _openBatch {};
+        std::deque<Batch> _submittedBatches {};
+        std::vector<Batch> _freeBatches {}; // command buffers and fences to reuse
+        std::vector<VkBufferMemoryBarrier> _ownershipBarriers {}; // ranges the open batch writes
+        std::vector<BufferCopy> _copies {}; // recorded with the open batch's graphics queue work
+
+        Ticket _nextTicket { 1 };
+        Ticket _completedTicket { 0 };
+
+        Stats _stats {};
+    };
+
+} // namespace Engine
@@ -1,6 +1,8 @@
 #pragma once
 
 // std
+#include <cstdint>
+#include <cstring>
 #include <functional>
 
 namespace Engine {
@@ -11,5 +13,39 @@ namespace Engine {
         seed ^= std::hash<T> {} (v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
         (hashCombine(seed, rest), ...);
     };
-    
+
+    // 64 bit content hash, consumes 8 bytes per step. Not cryptographic, only meant to detect file changes.
+    inline uint64_t hashBytes(const void* data, std::size_t size, uint64_t seed = 0xcbf29ce484222325ull) {
+        constexpr uint64_t multiplier = 0x9e3779b97f4a7c15ull;
+
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        uint64_t hash = seed ^ (static_cast<uint64_t>(size) * multiplier);
+
+        auto mix = [](uint64_t value) {
+            value ^= value >> 33;
+            value *= 0xff51afd7ed558ccdull;
+            value ^= value >> 33;
+            return value;
+        };
+
+        std::size_t i = 0;
+
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(uint64_t));
+
+            hash = (hash ^ mix(word)) * multiplier;
+        }
+
+        uint64_t tail = 0;
+
+        if (i < size) {
+            std::memcpy(&tail, bytes + i, size - i);
+        }
+
+        hash = (hash ^ mix(tail)) * multiplier;
+
+        return mix(hash);
+    }
+
 } // namespace Engine
@@ -0,0 +1,211 @@
+#include "vertex_welder.hpp"
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace Engine {
+
+    constexpr size_t MIN_CORNERS_PER_THREAD = 64 * 1024;
+    constexpr uint32_t SHARD_BITS = 8;
+    constexpr uint32_t SHARD_COUNT = 1u << SHARD_BITS;
+    constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+    constexpr size_t VERTEX_WORDS = sizeof(Model::Vertex) / sizeof(uint32_t);
+
+    static_assert(sizeof(Model::Vertex) == VERTEX_WORDS * sizeof(uint32_t), "Model::Vertex must not contain padding, it is welded by its bit pattern");
+
+    // Raw bits of the vertex with negative zeros folded into positive ones, matching operator==.
+    static void LoadKey(const Model::Vertex& vertex, uint32_t (&key)[VERTEX_WORDS]) {
+        std::memcpy(key, &vertex, sizeof(Model::Vertex));
+
+        for (uint32_t& word : key) {
+            word = word == 0x80000000u ? 0u : word;
+        }
+    }
+
+    static uint64_t HashVertex(const Model::Vertex& vertex) {
+        uint32_t key[VERTEX_WORDS];
+        LoadKey(vertex, key);
+
+        uint64_t hash = 0xcbf29ce484222325ull;
+
+        for (size_t i = 0; i < VERTEX_WORDS; i++) {
+            hash = (hash ^ key[i]) * 0x9e3779b97f4a7c15ull;
+            hash ^= hash >> 32;
+        }
+
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+
+        return hash;
+    }
+
+    static bool SameVertex(const Model::Vertex& a, const Model::Vertex& b) {
+        uint32_t keyA[VERTEX_WORDS];
+        uint32_t keyB[VERTEX_WORDS];
+        LoadKey(a, keyA);
+        LoadKey(b, keyB);
+
+        return std::memcmp(keyA, keyB, sizeof(keyA)) == 0;
+    }
+
+    // Runs work(threadIndex) on threadCount threads, the calling thread takes index 0.
+    template <typename Work>
+    static void RunOnThreads(uint32_t threadCount, Work&& work) {
+        std::vector<std::thread> workers {};
+
+        for (uint32_t i = 1; i < threadCount; i++) {
+            workers.emplace_back([&work, i]() { work(i); });
+        }
+
+        work(0);
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    VertexWelder::Stats VertexWelder::Weld(const std::vector<Model::Vertex>& corners, Model::Data& data) {
+        const auto start = std::chrono::steady_clock::now();
+        const size_t cornerCount = corners.size();
+
+        Stats stats {};
+        stats.CornerCount = cornerCount;
+        stats.ThreadCount = static_cast<uint32_t>(std::clamp<size_t>(cornerCount / MIN_CORNERS_PER_THREAD, 1, std::max(1u, std::thread::hardware_concurrency())));
+
+        const uint32_t threadCount = stats.ThreadCount;
+        auto rangeBegin = [&](uint32_t thread) { return cornerCount * thread / threadCount; };
+
+        std::vector<uint64_t> hashes(cornerCount);
+        std::vector<uint32_t> firstOccurrence(cornerCount);
+
+        RunOnThreads(threadCount, [&](uint32_t thread) {
+            for (size_t i = rangeBegin(thread); i < rangeBegin(thread + 1); i++) {
+                hashes[i] = HashVertex(corners[i]);
+            }
+        });
+
+        if (threadCount == 1) {
+            std::vector<uint32_t> cornerIndices(cornerCount);
+            std::vector<uint32_t> table {};
+
+            for (size_t i = 0; i < cornerCount; i++) {
+                cornerIndices[i] = static_cast<uint32_t>(i);
+            }
+
+            WeldShard(corners.data(), hashes.data(), cornerIndices.data(), cornerCount, firstOccurrence.data(), table);
+        }
+        else {
+            // Bucket the corners by the top bits of their hash (a stable counting sort, so every shard
+            // stays in ascending corner order), equal vertices always land in the same shard.
+            auto shardOf = [](uint64_t hash) { return static_cast<uint32_t>(hash >> (64 - SHARD_BITS)); };
+
+            std::vector<size_t> offsets(static_cast<size_t>(threadCount) * SHARD_COUNT, 0);
+            std::vector<size_t> shardBegin(SHARD_COUNT + 1, 0);
+            std::vector<uint32_t> sortedCorners(cornerCount);
+
+            RunOnThreads(threadCount, [&](uint32_t thread) {
+                size_t* counts = &offsets[static_cast<size_t>(thread) * SHARD_COUNT];
+
+                for (size_t i = rangeBegin(thread); i < rangeBegin(thread + 1); i++) {
+                    counts[shardOf(hashes[i])]++;
+                }
+            });
+
+            size_t runningOffset = 0;
+
+            for (uint32_t shard = 0; shard < SHARD_COUNT; shard++) {
+                shardBegin[shard] = runningOffset;
+
+                for (uint32_t thread = 0; thread < threadCount; thread++) {
+                    size_t& offset = offsets[static_cast<size_t>(thread) * SHARD_COUNT + shard];
+                    const size_t count = offset;
+
+                    offset = runningOffset;
+                    runningOffset += count;
+                }
+            }
+
+            shardBegin[SHARD_COUNT] = runningOffset;
+
+            RunOnThreads(threadCount, [&](uint32_t thread) {
+                size_t* cursors = &offsets[static_cast<size_t>(thread) * SHARD_COUNT];
+
+                for (size_t i = rangeBegin(thread); i < rangeBegin(thread + 1); i++) {
+                    sortedCorners[cursors[shardOf(hashes[i])]++] = static_cast<uint32_t>(i);
+                }
+            });
+
+            std::atomic<uint32_t> nextShard { 0 };
+
+            RunOnThreads(threadCount, [&](uint32_t) {
+                std::vector<uint32_t> table {};
+
+                for (uint32_t shard = nextShard++; shard < SHARD_COUNT; shard = nextShard++) {
+                    const size_t begin = shardBegin[shard];
+
+                    WeldShard(corners.data(), hashes.data(), sortedCorners.data() + begin, shardBegin[shard + 1] - begin, firstOccurrence.data(), table);
+                }
+            });
+        }
+
+        // Hand out ids in corner order, the first occurrence of a vertex always comes before its duplicates.
+        data.Vertices.clear();
+        data.Indices.resize(cornerCount);
+
+        for (size_t i = 0; i < cornerCount; i++) {
+            const uint32_t first = firstOccurrence[i];
+
+            if (first == i) {
+                data.Indices[i] = static_cast<uint32_t>(data.Vertices.size());
+                data.Vertices.push_back(corners[i]);
+            }
+            else {
+                data.Indices[i] = data.Indices[first];
+            }
+        }
+
+        stats.VertexCount = data.Vertices.size();
+        stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return stats;
+    }
+
+    void VertexWelder::WeldShard(const Model::Vertex* corners, const uint64_t* hashes, const uint32_t* cornerIndices, size_t count,
+                                 uint32_t* firstOccurrence, std::vector<uint32_t>& table)
+    {
+        size_t capacity = 16;
+
+        while (capacity < count * 2) {
+            capacity *= 2;
+        }
+
+        table.assign(capacity, EMPTY_SLOT);
+        const size_t mask = capacity - 1;
+
+        for (size_t i = 0; i < count; i++) {
+            const uint32_t corner = cornerIndices[i];
+            const uint64_t hash = hashes[corner];
+
+            for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+                const uint32_t occupant = table[slot];
+
+                if (occupant == EMPTY_SLOT) {
+                    table[slot] = corner;
+                    firstOccurrence[corner] = corner;
+                    break;
+                }
+
+                if (hashes[occupant] == hash && SameVertex(corners[occupant], corners[corner])) {
+                    firstOccurrence[corner] = occupant;
+                    break;
+                }
+            }
+        }
+    }
+
+} // namespace Engine
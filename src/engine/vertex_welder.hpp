@@ -0,0 +1,33 @@
+#pragma once
+
+#include "model.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+
+    // Collapses identical triangle corners into an indexed mesh. Vertices are compared by their full
+    // bit pattern (-0.0 and 0.0 count as equal), the output keeps first occurrence order so it does not
+    // depend on the thread count.
+    class VertexWelder {
+
+    public:
+        struct Stats {
+            size_t CornerCount { 0 };
+            size_t VertexCount { 0 };
+            double Seconds { 0.0 };
+            uint32_t ThreadCount { 0 };
+        };
+
+        static Stats Weld(const std::vector<Model::Vertex>& corners, Model::Data& data);
+
+    private:
+        // Finds the first occurrence of every corner in the given (ascending) subset of corners.
+        static void WeldShard(const Model::Vertex* corners, const uint64_t* hashes, const uint32_t* cornerIndices, size_t count,
+                              uint32_t* firstOccurrence, std::vector<uint32_t>& table);
+    };
+
+} // namespace Engine
@@ -0,0 +1,85 @@
+#include "../src/engine/asset_archive.hpp"
+
+// std
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Packs every file under the given directories into one archive, stored under the path as given on the
+// command line (assets/models/cube.obj), which is the path the engine asks for at runtime.
+//
+// usage: asset_packer [-o assets.pak] [directory or file...]      defaults: -o assets.pak assets
+
+namespace fs = std::filesystem;
+
+// Written next to the assets at runtime. The archive is looked in first, so a packed .meshcache would hide the loose
+// one beside the model, and once it went stale every load would parse the model again.
+static bool IsByproduct(const fs::path& path) {
+    const fs::path extension = path.extension();
+    return extension == ".tmp" || extension == ".meshcache";
+}
+
+static void AddSource(const fs::path& path, const fs::path& outputPath, std::vector<Engine::AssetArchive::Source>& sources) {
+    if (IsByproduct(path) || (fs::exists(outputPath) && fs::equivalent(path, outputPath))) {
+        return;
+    }
+
+    sources.push_back({ path.generic_string(), path.string() });
+}
+
+int main(int argc, char** argv) {
+    std::string outputPath = "assets.pak";
+    std::vector<std::string> inputs {};
+
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+
+        if (argument == "-o" && i + 1 < argc) {
+            outputPath = argv[++i];
+        }
+        else {
+            inputs.push_back(argument);
+        }
+    }
+
+    if (inputs.empty()) {
+        inputs.push_back("assets");
+    }
+
+    try {
+        std::vector<Engine::AssetArchive::Source> sources {};
+
+        for (const auto& input : inputs) {
+            if (fs::is_directory(input)) {
+                for (const auto& item : fs::recursive_directory_iterator { input }) {
+                    if (item.is_regular_file()) {
+                        AddSource(item.path(), outputPath, sources);
+                    }
+                }
+            }
+            else if (fs::is_regular_file(input)) {
+                AddSource(input, outputPath, sources);
+            }
+            else {
+                std::cerr << "Skipped " << input << ", no such file or directory" << '\n';
+            }
+        }
+
+        std::sort(sources.begin(), sources.end(), [](const auto& a, const auto& b) { return a.Name < b.Name; });
+
+        const auto stats = Engine::AssetArchive::Write(outputPath, sources);
+
+        std::cout << "Packed " << stats.EntryCount << " files into " << outputPath << ": " << stats.Bytes / 1024 << " KB -> " << stats.StoredBytes / 1024
+                  << " KB (" << stats.CompressedCount << " compressed) in " << stats.Seconds * 1000.0 << " ms" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
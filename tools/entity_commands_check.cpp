@@ -0,0 +1,187 @@
+#include "../src/engine/entity_command_buffer.hpp"
+#include "../src/engine/job_system.hpp"
+#include "../src/engine/scene.hpp"
+
+// std
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records structural changes into an EntityCommandBuffer from every job system thread and from a thread of its own,
+// plays them back and checks the scene ended up the way the commands say:
+//   parents   children point at parents another job created in the same batch
+//   replace   a second add of a component replaces the first, an add beats a removal in the same batch
+//   destroy   destroying wins over everything else recorded for the entity, its children become roots
+//   stale     commands on entities destroyed in an earlier batch are dropped
+//
+// usage: entity_commands_check [spawner count] [worker threads]      default: 10000, every core
+
+using namespace Engine;
+
+constexpr uint32_t ROUNDS = 4;
+constexpr uint32_t FOREIGN_ENTITY_COUNT = 1000;
+constexpr uint32_t REPLACED_LOD = 7;
+
+static bool Check(bool condition, const std::string& what, uint32_t& failures) {
+    if (!condition && failures++ < 10) {
+        std::cerr << "  failed: " << what << '\n';
+    }
+
+    return condition;
+}
+
+int main(int argc, char** argv) {
+    const uint32_t spawnerCount = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 10000;
+
+    JobSystem::Options options {};
+
+    if (argc > 2) {
+        options.WorkerCount = static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10));
+    }
+
+    if (spawnerCount < 2) {
+        std::cerr << "usage: entity_commands_check [spawner count] [worker threads]" << '\n';
+        return EXIT_FAILURE;
+    }
+
+    Scene scene {};
+    JobSystem jobSystem { options };
+    EntityCommandBuffer commands { scene, jobSystem };
+
+    std::vector<Entity> parents(spawnerCount);
+    std::vector<Entity> children(spawnerCount);
+    std::vector<Entity> destroyedParents {}; // stale handles for the next round
+    uint32_t failures = 0;
+
+    std::cout << spawnerCount << " spawners on " << jobSystem.GetThreadCount() << " threads, " << ROUNDS << " rounds" << '\n';
+
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        const std::vector<Entity> previousChildren = round > 0 ? children : std::vector<Entity> {};
+
+        // Parents first, children in a second pass so most of them pick a parent some other job created.
+        jobSystem.ParallelFor(spawnerCount, 64, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                TransformComponent transform {};
+                transform.Position = { static_cast<float>(i), 0.0f, 0.0f };
+
+                parents[i] = commands.CreateEntity(transform);
+                commands.AddPointLight(parents[i], {});
+
+                if (i % 3 == 0) {
+                    commands.DestroyEntity(parents[i]);
+                }
+            }
+        });
+
+        jobSystem.ParallelFor(spawnerCount, 64, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                TransformComponent transform {};
+                transform.Position = { 0.0f, static_cast<float>(i), 0.0f };
+
+                children[i] = commands.CreateEntity(transform, parents[(i + 1) % spawnerCount]);
+                commands.AddRenderable(children[i], {});
+
+                RenderableComponent replaced {};
+                replaced.Lod = REPLACED_LOD;
+                commands.AddRenderable(children[i], replaced);
+
+                if (i % 5 == 0) {
+                    commands.RemoveRenderable(children[i]);
+                }
+
+                // Last round's children go, along with commands on handles that died a round ago.
+                if (!previousChildren.empty()) {
+                    commands.DestroyEntity(previousChildren[i]);
+                }
+            }
+
+            for (uint32_t i = begin; i < end && i < destroyedParents.size(); i++) {
+                commands.AddPointLight(destroyedParents[i], {});
+                commands.DestroyEntity(destroyedParents[i]);
+            }
+        });
+
+        std::vector<Entity> foreignEntities(FOREIGN_ENTITY_COUNT);
+
+        std::thread foreignThread { [&]() {
+            std::vector<TransformComponent> transforms(FOREIGN_ENTITY_COUNT);
+            commands.CreateEntities(FOREIGN_ENTITY_COUNT, transforms.data(), foreignEntities.data());
+
+            for (const Entity entity : foreignEntities) {
+                commands.AddStreamedModel(entity, { "assets/models/cube.obj" });
+            }
+        } };
+
+        foreignThread.join();
+
+        const uint32_t entityCountBefore = scene.GetEntityCount();
+        const EntityCommandBuffer::Stats stats = commands.Playback();
+        scene.Update(&jobSystem);
+
+        const uint32_t destroyedParentCount = (spawnerCount + 2) / 3;
+        const uint32_t createdCount = 2 * spawnerCount + FOREIGN_ENTITY_COUNT;
+        const uint32_t expectedDestroyed = destroyedParentCount + static_cast<uint32_t>(previousChildren.size());
+
+        Check(stats.CreatedCount == createdCount, "created count", failures);
+        Check(stats.DestroyedCount == expectedDestroyed, "destroyed count, stale destroys have to be dropped", failures);
+        Check(stats.RemovedCount == 0, "removals run before the adds, there is nothing to remove yet", failures);
+        Check(scene.GetEntityCount() == entityCountBefore + createdCount - expectedDestroyed, "entity count", failures);
+
+        for (const Entity entity : previousChildren) {
+            Check(!scene.IsAlive(entity), "last round's child destroyed", failures);
+        }
+
+        for (const Entity entity : destroyedParents) {
+            Check(!scene.PointLights.Contains(entity), "no light on a stale handle", failures);
+        }
+
+        for (uint32_t i = 0; i < spawnerCount; i++) {
+            const Entity parent = parents[i];
+            const bool parentAlive = i % 3 != 0;
+
+            Check(scene.IsAlive(parent) == parentAlive, "parent alive unless destroyed", failures);
+            Check(scene.PointLights.Contains(parent) == parentAlive, "parent light", failures);
+
+            const Entity child = children[i];
+            const uint32_t parentIndex = (i + 1) % spawnerCount;
+            const bool hasParent = parentIndex % 3 != 0;
+
+            if (!Check(scene.IsAlive(child), "child alive", failures)) {
+                continue;
+            }
+
+            const RenderableComponent* renderable = scene.Renderables.Find(child);
+            Check(renderable != nullptr && renderable->Lod == REPLACED_LOD, "second add replaced the first", failures);
+
+            Check(scene.Transforms.GetParent(child) == (hasParent ? parents[parentIndex] : INVALID_ENTITY), "child parent", failures);
+
+            const glm::vec3 position { scene.Transforms.GetWorldMatrix(scene.Transforms.IndexOf(child))[3] };
+            const glm::vec3 expected { hasParent ? static_cast<float>(parentIndex) : 0.0f, static_cast<float>(i), 0.0f };
+            Check(position == expected, "child world position", failures);
+        }
+
+        for (const Entity entity : foreignEntities) {
+            Check(scene.IsAlive(entity) && scene.StreamedModels.Contains(entity), "foreign thread entity", failures);
+        }
+
+        std::cout << "round " << round << ": " << stats.CreatedCount << " created, " << stats.DestroyedCount << " destroyed, " << stats.AddedCount
+                  << " components added, " << scene.GetEntityCount() << " entities" << '\n';
+
+        destroyedParents.clear();
+
+        for (uint32_t i = 0; i < spawnerCount; i += 3) {
+            destroyedParents.push_back(parents[i]);
+        }
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << '\n';
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "all checks passed" << '\n';
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+#include "../src/engine/job_system.hpp"
+#include "../src/engine/transform_batch.hpp"
+
+// libs
+#include <glm/gtc/constants.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Runs the same three workloads on a JobSystem with 1, 2... up to max threads and prints how each scales:
+//   transforms  ParallelFor over TransformBatch::Compute, the engine's biggest per frame loop
+//   tiny jobs   empty jobs through Run and Wait, the cost of a job on its own
+//   unbalanced  ParallelFor where the last items cost far more than the first, only stealing keeps threads busy
+//
+// usage: job_benchmark [object count] [max threads] [pin]      default: 1000000, every core, not pinned
+
+using namespace Engine;
+
+constexpr int REPEATS = 20;
+constexpr uint32_t TRANSFORM_GRAIN_SIZE = 1024;
+constexpr uint32_t TINY_JOB_COUNT = 100000;
+constexpr uint32_t UNBALANCED_ITEM_COUNT = 4096;
+
+struct Transforms {
+    std::vector<glm::vec3> Positions;
+    std::vector<glm::vec3> Rotations;
+    std::vector<glm::vec3> Scales;
+};
+
+static Transforms CreateTransforms(uint32_t count) {
+    std::mt19937 random { 1234 };
+    std::uniform_real_distribution<float> position { -100.0f, 100.0f };
+    std::uniform_real_distribution<float> rotation { -4.0f * glm::pi<float>(), 4.0f * glm::pi<float>() };
+    std::uniform_real_distribution<float> scale { 0.1f, 10.0f };
+
+    Transforms transforms {};
+
+    for (uint32_t i = 0; i < count; i++) {
+        transforms.Positions.push_back({ position(random), position(random), position(random) });
+        transforms.Rotations.push_back({ rotation(random), rotation(random), rotation(random) });
+        transforms.Scales.push_back({ scale(random), scale(random), scale(random) });
+    }
+
+    return transforms;
+}
+
+template<typename Function>
+static double MeasureItemsPerSecond(uint32_t count, Function&& function) {
+    double best = 0.0;
+
+    for (int repeat = 0; repeat < REPEATS; repeat++) {
+        const auto startTime = std::chrono::high_resolution_clock::now();
+        function();
+        const double seconds = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        best = std::max(best, count / seconds);
+    }
+
+    return best;
+}
+
+// Item i does about i units of work.
+static float DoUnbalancedWork(uint32_t item) {
+    float value = static_cast<float>(item);
+
+    for (uint32_t i = 0; i < item * 2; i++) {
+        value = std::sqrt(value + 1.0f);
+    }
+
+    return value;
+}
+
+struct Result {
+    double Transforms;
+    double TinyJobs;
+    double Unbalanced;
+};
+
+static void LogScaling(const char* name, double itemsPerSecond, double singleThread, uint32_t threadCount) {
+    const double speedup = itemsPerSecond / singleThread;
+
+    std::cout << "  " << name << ": " << itemsPerSecond / 1e6 << " M/s, " << speedup << "x, " << 100.0 * speedup / threadCount << "% efficiency" << '\n';
+}
+
+int main(int argc, char** argv) {
+    const uint32_t count = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1000000;
+    const uint32_t maxThreads = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : std::max(std::thread::hardware_concurrency(), 1u);
+    const bool pinThreads = argc > 3 && std::strcmp(argv[3], "pin") == 0;
+
+    if (count == 0 || maxThreads == 0) {
+        std::cerr << "usage: job_benchmark [object count] [max threads] [pin]" << '\n';
+        return EXIT_FAILURE;
+    }
+
+    const Transforms transforms = CreateTransforms(count);
+
+    std::vector<glm::mat4> expectedModelMatrices(count);
+    std::vector<glm::mat3> expectedNormalMatrices(count);
+
+    TransformBatch::Compute(transforms.Positions.data(), transforms.Rotations.data(), transforms.Scales.data(), nullptr, count,
+                            expectedModelMatrices.data(), expectedNormalMatrices.data());
+
+    std::vector<float> expectedUnbalanced(UNBALANCED_ITEM_COUNT);
+
+    for (uint32_t i = 0; i < UNBALANCED_ITEM_COUNT; i++) {
+        expectedUnbalanced[i] = DoUnbalancedWork(i);
+    }
+
+    std::vector<glm::mat4> modelMatrices(count);
+    std::vector<glm::mat3> normalMatrices(count);
+    std::vector<float> unbalanced(UNBALANCED_ITEM_COUNT);
+
+    std::cout << count << " transforms, " << TINY_JOB_COUNT << " tiny jobs, " << UNBALANCED_ITEM_COUNT << " unbalanced items, best of " << REPEATS
+              << (pinThreads ? ", pinned" : "") << '\n';
+
+    Result singleThread {};
+    bool correct = true;
+
+    for (uint32_t threadCount = 1; threadCount <= maxThreads; threadCount++) {
+        JobSystem::Options options {};
+        options.WorkerCount = threadCount - 1;
+        options.PinThreads = pinThreads;
+
+        JobSystem jobSystem { options };
+        Result result {};
+
+        std::fill(modelMatrices.begin(), modelMatrices.end(), glm::mat4 { 0.0f });
+
+        result.Transforms = MeasureItemsPerSecond(count, [&]() {
+            jobSystem.ParallelFor(count, TRANSFORM_GRAIN_SIZE, [&](uint32_t begin, uint32_t end) {
+                TransformBatch::Compute(transforms.Positions.data() + begin, transforms.Rotations.data() + begin, transforms.Scales.data() + begin, nullptr,
+                                        end - begin, modelMatrices.data() + begin, normalMatrices.data() + begin);
+            });
+        });
+
+        correct &= std::memcmp(modelMatrices.data(), expectedModelMatrices.data(), count * sizeof(glm::mat4)) == 0;
+        correct &= std::memcmp(normalMatrices.data(), expectedNormalMatrices.data(), count * sizeof(glm::mat3)) == 0;
+
+        std::atomic<uint32_t> ranJobs { 0 };
+
+        result.TinyJobs = MeasureItemsPerSecond(TINY_JOB_COUNT, [&]() {
+            JobSystem::Counter counter {};
+
+            for (uint32_t i = 0; i < TINY_JOB_COUNT; i++) {
+                jobSystem.Run([&ranJobs]() { ranJobs.fetch_add(1, std::memory_order_relaxed); }, counter);
+            }
+
+            jobSystem.Wait(counter);
+        });
+
+        correct &= ranJobs == TINY_JOB_COUNT * REPEATS;
+
+        const uint64_t stealsBefore = jobSystem.GetStealCount();
+
+        result.Unbalanced = MeasureItemsPerSecond(UNBALANCED_ITEM_COUNT, [&]() {
+            jobSystem.ParallelFor(UNBALANCED_ITEM_COUNT, 1, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end; i++) {
+                    unbalanced[i] = DoUnbalancedWork(i);
+                }
+            });
+        });
+
+        correct &= unbalanced == expectedUnbalanced;
+
+        if (threadCount == 1) {
+            singleThread = result;
+        }
+
+        std::cout << threadCount << (threadCount == 1 ? " thread" : " threads") << '\n';
+        LogScaling("transforms", result.Transforms, singleThread.Transforms, threadCount);
+        LogScaling("tiny jobs ", result.TinyJobs, singleThread.TinyJobs, threadCount);
+        LogScaling("unbalanced", result.Unbalanced, singleThread.Unbalanced, threadCount);
+        std::cout << "  " << (jobSystem.GetStealCount() - stealsBefore) / REPEATS << " steals per unbalanced run" << '\n';
+    }
+
+    if (!correct) {
+        std::cerr << "Results on the job system differ from running everything on one thread" << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,383 @@
+#include "../src/engine/camera.hpp"
+#include "../src/engine/meshlet.hpp"
+
+// libs
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Builds meshlets for a UV sphere and a torus, culls them against a set of views and checks Meshlet::Cull against brute force:
+//   bounds    every meshlet sphere holds all of its vertices and every face normal lies inside the meshlet's cone
+//   frustum   the sphere test agrees with planes worked out from the camera's field of view instead of the clip matrix
+//   cone      a meshlet is only cone culled when every one of its triangles faces away from the camera
+//   ranges    the draw ranges are exactly the visible meshlets, merged, and every front facing triangle with a corner
+//             inside the view volume is in one of them
+// The torus has faces turned towards each other, a convex mesh alone would let a cone test that ignores the meshlet's
+// size pass. The fixed views have known answers (everything visible, nothing visible), the random ones use a fixed seed.
+//
+// usage: meshlet_cull_check [random views]      default: 200
+
+using namespace Engine;
+
+constexpr uint32_t SPHERE_RINGS = 48;
+constexpr uint32_t SPHERE_SEGMENTS = 96;
+constexpr uint32_t TORUS_RINGS = 32;
+constexpr uint32_t TORUS_SEGMENTS = 128;
+constexpr float TORUS_RADIUS = 1.0f;
+constexpr float TORUS_TUBE_RADIUS = 0.35f;
+constexpr float EPSILON = 1e-4f; // results this close to a plane or to edge on can go either way
+
+enum class Expect { Any, Everything, Nothing };
+
+struct Mesh {
+    std::string Name {};
+    std::vector<glm::vec3> Positions {};
+    std::vector<uint32_t> Indices {};
+    std::vector<Meshlet> Meshlets {};
+};
+
+struct View {
+    std::string Name {};
+    glm::vec3 Position {};
+    glm::vec3 Target {};
+    float VerticalFov { glm::radians(50.0f) };
+    float AspectRatio { 1.0f };
+    float Near { 0.1f };
+    float Far { 100.0f };
+    glm::mat4 Model { 1.0f }; // rotation, translation and uniform scale only
+    Expect Expected { Expect::Any };
+};
+
+static bool Check(bool condition, const std::string& what, uint32_t& failures) {
+    if (!condition && failures++ < 10) {
+        std::cerr << "  failed: " << what << '\n';
+    }
+
+    return condition;
+}
+
+// Unit sphere, outward facing, poles get a single triangle per segment so nothing is degenerate.
+static Mesh CreateSphere() {
+    Mesh mesh { "sphere" };
+
+    for (uint32_t ring = 0; ring <= SPHERE_RINGS; ring++) {
+        for (uint32_t segment = 0; segment < SPHERE_SEGMENTS; segment++) {
+            const float theta = glm::pi<float>() * ring / SPHERE_RINGS;
+            const float phi = glm::two_pi<float>() * segment / SPHERE_SEGMENTS;
+
+            mesh.Positions.push_back({ std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) });
+        }
+    }
+
+    auto vertex = [](uint32_t ring, uint32_t segment) { return ring * SPHERE_SEGMENTS + segment % SPHERE_SEGMENTS; };
+
+    for (uint32_t ring = 0; ring < SPHERE_RINGS; ring++) {
+        for (uint32_t segment = 0; segment < SPHERE_SEGMENTS; segment++) {
+            const uint32_t a = vertex(ring, segment);
+            const uint32_t b = vertex(ring + 1, segment);
+            const uint32_t c = vertex(ring, segment + 1);
+            const uint32_t d = vertex(ring + 1, segment + 1);
+
+            if (ring > 0) {
+                mesh.Indices.insert(mesh.Indices.end(), { a, c, b });
+            }
+
+            if (ring < SPHERE_RINGS - 1) {
+                mesh.Indices.insert(mesh.Indices.end(), { c, d, b });
+            }
+        }
+    }
+
+    return mesh;
+}
+
+// Torus around the y axis, outward facing, the inner half of the tube looks at the other side of the hole.
+static Mesh CreateTorus() {
+    Mesh mesh { "torus" };
+
+    for (uint32_t ring = 0; ring < TORUS_RINGS; ring++) {
+        for (uint32_t segment = 0; segment < TORUS_SEGMENTS; segment++) {
+            const float tube = glm::two_pi<float>() * ring / TORUS_RINGS;
+            const float around = glm::two_pi<float>() * segment / TORUS_SEGMENTS;
+            const float distance = TORUS_RADIUS + TORUS_TUBE_RADIUS * std::cos(tube);
+
+            mesh.Positions.push_back({ distance * std::cos(around), TORUS_TUBE_RADIUS * std::sin(tube), distance * std::sin(around) });
+        }
+    }
+
+    auto vertex = [](uint32_t ring, uint32_t segment) { return ring % TORUS_RINGS * TORUS_SEGMENTS + segment % TORUS_SEGMENTS; };
+
+    for (uint32_t ring = 0; ring < TORUS_RINGS; ring++) {
+        for (uint32_t segment = 0; segment < TORUS_SEGMENTS; segment++) {
+            const uint32_t a = vertex(ring, segment);
+            const uint32_t b = vertex(ring + 1, segment);
+            const uint32_t c = vertex(ring, segment + 1);
+            const uint32_t d = vertex(ring + 1, segment + 1);
+
+            mesh.Indices.insert(mesh.Indices.end(), { a, b, c, b, d, c });
+        }
+    }
+
+    return mesh;
+}
+
+// Inward facing view space planes straight from the field of view, the camera looks down +z.
+static std::array<glm::vec4, 6> CreateViewPlanes(const View& view) {
+    const float tanY = std::tan(view.VerticalFov / 2.0f);
+    const float tanX = tanY * view.AspectRatio;
+
+    return {
+        glm::vec4 { 1.0f, 0.0f, tanX, 0.0f } / std::sqrt(1.0f + tanX * tanX),
+        glm::vec4 { -1.0f, 0.0f, tanX, 0.0f } / std::sqrt(1.0f + tanX * tanX),
+        glm::vec4 { 0.0f, 1.0f, tanY, 0.0f } / std::sqrt(1.0f + tanY * tanY),
+        glm::vec4 { 0.0f, -1.0f, tanY, 0.0f } / std::sqrt(1.0f + tanY * tanY),
+        glm::vec4 { 0.0f, 0.0f, 1.0f, -view.Near },
+        glm::vec4 { 0.0f, 0.0f, -1.0f, view.Far },
+    };
+}
+
+// Smallest distance inside any plane plus the radius, positive when the sphere reaches into the volume.
+static float GetSphereMargin(const std::array<glm::vec4, 6>& planes, const glm::vec3& center, float radius) {
+    float margin = radius;
+
+    for (const glm::vec4& plane : planes) {
+        margin = std::min(margin, glm::dot(glm::vec3 { plane }, center) + plane.w + radius);
+    }
+
+    return margin;
+}
+
+// Cosine between the face normal and the direction from the camera, positive when the triangle faces away.
+static float GetFacing(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& cameraPosition) {
+    const glm::vec3 normal = glm::cross(b - a, c - a);
+    const glm::vec3 toTriangle = a - cameraPosition;
+    const float length = glm::length(normal) * glm::length(toTriangle);
+
+    return length > 0.0f ? glm::dot(normal, toTriangle) / length : 0.0f;
+}
+
+static void CheckBounds(const Mesh& mesh, uint32_t& failures) {
+    const std::vector<Meshlet>& meshlets = mesh.Meshlets;
+    const std::vector<glm::vec3>& positions = mesh.Positions;
+    const std::vector<uint32_t>& indices = mesh.Indices;
+
+    for (size_t i = 0; i < meshlets.size(); i++) {
+        const Meshlet& meshlet = meshlets[i];
+        const std::string name = mesh.Name + " meshlet " + std::to_string(i);
+
+        Check(meshlet.IndexCount > 0 && meshlet.IndexCount % 3 == 0 && meshlet.IndexCount / 3 <= Meshlet::MAX_TRIANGLES, name + " triangle count", failures);
+        Check(i == 0 ? meshlet.FirstIndex == 0 : meshlet.FirstIndex == meshlets[i - 1].FirstIndex + meshlets[i - 1].IndexCount,
+              name + " follows the previous meshlet", failures);
+
+        const float coneSpread = std::sqrt(std::max(0.0f, 1.0f - meshlet.ConeCutoff * meshlet.ConeCutoff));
+
+        for (uint32_t index = meshlet.FirstIndex; index < meshlet.FirstIndex + meshlet.IndexCount; index += 3) {
+            const glm::vec3& a = positions[indices[index]];
+            const glm::vec3& b = positions[indices[index + 1]];
+            const glm::vec3& c = positions[indices[index + 2]];
+
+            for (const glm::vec3& position : { a, b, c }) {
+                Check(glm::length(position - meshlet.Center) <= meshlet.Radius + EPSILON, name + " sphere holds its vertices", failures);
+            }
+
+            if (meshlet.ConeCutoff < 1.0f) {
+                const glm::vec3 normal = glm::normalize(glm::cross(b - a, c - a));
+                Check(glm::dot(normal, meshlet.ConeAxis) >= coneSpread - EPSILON, name + " cone holds its face normals", failures);
+            }
+        }
+    }
+
+    Check(!meshlets.empty() && meshlets.back().FirstIndex + meshlets.back().IndexCount == indices.size(), mesh.Name + " meshlets cover every index", failures);
+}
+
+// Returns the number of meshlets drawn.
+static size_t CheckView(const Mesh& mesh, const View& view, bool coneCulling, uint32_t& failures) {
+    const std::vector<Meshlet>& meshlets = mesh.Meshlets;
+    const std::vector<glm::vec3>& positions = mesh.Positions;
+    const std::vector<uint32_t>& indices = mesh.Indices;
+    const std::string name = mesh.Name + " " + view.Name + (coneCulling ? " (cone culling)" : "");
+
+    Camera camera {};
+    camera.SetPerspectiveProjection(view.VerticalFov, view.AspectRatio, view.Near, view.Far);
+    camera.SetViewTarget(view.Position, view.Target);
+
+    // Culled in model space the way RenderSystem does it, checked in world and view space.
+    const glm::mat4 modelView = camera.GetViewMatrix() * view.Model;
+    const Frustum frustum = Frustum::FromMatrix(camera.GetProjectionMatrix() * modelView);
+    const glm::vec3 cameraPositionModel { glm::inverse(view.Model) * glm::vec4 { view.Position, 1.0f } };
+    const float scale = glm::length(glm::vec3 { view.Model[0] });
+
+    const std::array<glm::vec4, 6> planes = CreateViewPlanes(view);
+
+    std::vector<Meshlet::DrawRange> visibleRanges {};
+    Meshlet::Cull(meshlets, frustum, cameraPositionModel, coneCulling, visibleRanges);
+
+    std::vector<bool> isDrawn(indices.size() / 3, false);
+
+    for (size_t i = 0; i < visibleRanges.size(); i++) {
+        const Meshlet::DrawRange& range = visibleRanges[i];
+
+        if (!Check(range.IndexCount > 0 && range.FirstIndex + range.IndexCount <= indices.size(), name + " range inside the index buffer", failures)) {
+            continue;
+        }
+
+        Check(i == 0 || range.FirstIndex > visibleRanges[i - 1].FirstIndex + visibleRanges[i - 1].IndexCount, name + " ranges sorted and merged", failures);
+        std::fill(isDrawn.begin() + range.FirstIndex / 3, isDrawn.begin() + (range.FirstIndex + range.IndexCount) / 3, true);
+    }
+
+    size_t drawnCount = 0;
+
+    for (size_t i = 0; i < meshlets.size(); i++) {
+        const Meshlet& meshlet = meshlets[i];
+        const std::string meshletName = name + " meshlet " + std::to_string(i);
+
+        const bool isInFrustum = frustum.IntersectsSphere(meshlet.Center, meshlet.Radius);
+        const bool isBackfacing = meshlet.IsBackfacing(cameraPositionModel);
+        const float margin = GetSphereMargin(planes, glm::vec3 { modelView * glm::vec4 { meshlet.Center, 1.0f } }, meshlet.Radius * scale);
+
+        if (std::abs(margin) > EPSILON) {
+            Check(isInFrustum == (margin > 0.0f), meshletName + " sphere test matches the view planes", failures);
+        }
+
+        const bool isVisible = isInFrustum && !(coneCulling && isBackfacing);
+        drawnCount += isVisible ? 1 : 0;
+
+        for (uint32_t index = meshlet.FirstIndex; index < meshlet.FirstIndex + meshlet.IndexCount; index += 3) {
+            const glm::vec3 a { view.Model * glm::vec4 { positions[indices[index]], 1.0f } };
+            const glm::vec3 b { view.Model * glm::vec4 { positions[indices[index + 1]], 1.0f } };
+            const glm::vec3 c { view.Model * glm::vec4 { positions[indices[index + 2]], 1.0f } };
+            const float facing = GetFacing(a, b, c, view.Position);
+
+            if (isBackfacing) {
+                Check(facing >= -EPSILON, meshletName + " cone culled with a triangle facing the camera", failures);
+            }
+
+            Check(isDrawn[index / 3] == isVisible, meshletName + " drawn exactly when visible", failures);
+
+            bool hasCornerInside = false;
+
+            for (const glm::vec3& corner : { a, b, c }) {
+                hasCornerInside |= GetSphereMargin(planes, glm::vec3 { camera.GetViewMatrix() * glm::vec4 { corner, 1.0f } }, 0.0f) > EPSILON;
+            }
+
+            if (hasCornerInside && (!coneCulling || facing < -EPSILON)) {
+                Check(isDrawn[index / 3], meshletName + " drops a triangle that is on screen", failures);
+            }
+        }
+    }
+
+    if (view.Expected == Expect::Everything && !coneCulling) {
+        Check(visibleRanges.size() == 1 && visibleRanges[0].FirstIndex == 0 && visibleRanges[0].IndexCount == indices.size(),
+              name + " draws everything in one range", failures);
+    }
+
+    if (view.Expected == Expect::Everything && coneCulling) {
+        Check(drawnCount < meshlets.size(), name + " cone culls the far side", failures);
+    }
+
+    if (view.Expected == Expect::Nothing) {
+        Check(visibleRanges.empty(), name + " draws nothing", failures);
+    }
+
+    return drawnCount;
+}
+
+static std::vector<View> CreateViews(uint32_t randomViewCount) {
+    const glm::mat4 moved = glm::scale(glm::rotate(glm::translate(glm::mat4 { 1.0f }, glm::vec3 { 3.0f, -1.0f, 2.0f }), 0.7f, glm::vec3 { 0.3f, 1.0f, 0.2f }),
+                                       glm::vec3 { 2.5f });
+
+    std::vector<View> views {
+        { "front", { 0.0f, 0.0f, -5.0f }, { 0.0f, 0.0f, 0.0f }, glm::radians(50.0f), 1.5f, 0.1f, 100.0f, glm::mat4 { 1.0f }, Expect::Everything },
+        { "away", { 0.0f, 0.0f, -4.0f }, { 0.0f, 0.0f, -10.0f }, glm::radians(50.0f), 1.5f, 0.1f, 100.0f, glm::mat4 { 1.0f }, Expect::Nothing },
+        { "beyond far", { 0.0f, 0.0f, -8.0f }, { 0.0f, 0.0f, 0.0f }, glm::radians(50.0f), 1.5f, 0.1f, 5.5f, glm::mat4 { 1.0f }, Expect::Nothing },
+        { "before near", { 0.0f, 0.0f, -4.0f }, { 0.0f, 0.0f, 0.0f }, glm::radians(50.0f), 1.5f, 7.0f, 100.0f, glm::mat4 { 1.0f }, Expect::Nothing },
+        { "far plane cut", { 0.0f, 0.0f, -4.0f }, { 0.0f, 0.0f, 0.0f }, glm::radians(50.0f), 1.5f, 0.1f, 3.5f },
+        { "near plane cut", { 0.0f, 0.0f, -4.0f }, { 0.0f, 0.0f, 0.0f }, glm::radians(50.0f), 1.5f, 3.5f, 100.0f },
+        { "close edge", { 0.0f, 0.3f, -1.6f }, { 1.5f, 0.0f, 0.0f }, glm::radians(40.0f), 0.75f, 0.1f, 100.0f },
+        { "inside", { 0.1f, 0.2f, 0.0f }, { 0.0f, 0.0f, 1.0f }, glm::radians(90.0f), 1.0f, 0.05f, 100.0f },
+        { "moved model", { 0.0f, 4.0f, -6.0f }, { 3.0f, -1.0f, 2.0f }, glm::radians(45.0f), 1.0f, 0.1f, 100.0f, moved },
+    };
+
+    std::mt19937 random { 1234 };
+    std::uniform_real_distribution<float> unit { -1.0f, 1.0f };
+    std::uniform_real_distribution<float> zeroToOne { 0.0f, 1.0f };
+
+    while (views.size() < 9 + randomViewCount) {
+        View view {};
+        view.Name = "random view " + std::to_string(views.size() - 9);
+        view.Position = glm::vec3 { unit(random), unit(random), unit(random) } * 5.0f;
+        view.Target = glm::vec3 { unit(random), unit(random), unit(random) } * 0.8f;
+        view.VerticalFov = glm::radians(30.0f + 60.0f * zeroToOne(random));
+        view.AspectRatio = 0.5f + 1.5f * zeroToOne(random);
+        view.Near = 0.05f + zeroToOne(random);
+        view.Far = view.Near + 0.5f + 8.0f * zeroToOne(random);
+
+        if (views.size() % 2 == 0) {
+            const glm::vec3 axis { unit(random), unit(random), unit(random) };
+            view.Model = glm::translate(glm::mat4 { 1.0f }, glm::vec3 { unit(random), unit(random), unit(random) });
+            view.Model = glm::rotate(view.Model, glm::pi<float>() * unit(random), glm::length(axis) > 0.1f ? axis : glm::vec3 { 0.0f, 1.0f, 0.0f });
+            view.Model = glm::scale(view.Model, glm::vec3 { 0.5f + zeroToOne(random) });
+        }
+
+        // The view basis needs a direction that is not along the camera's up axis.
+        const glm::vec3 direction = view.Target - view.Position;
+
+        if (glm::length(direction) > 0.1f && std::abs(glm::normalize(direction).y) < 0.99f) {
+            views.push_back(view);
+        }
+    }
+
+    return views;
+}
+
+int main(int argc, char** argv) {
+    const uint32_t randomViewCount = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 200;
+
+    if (randomViewCount > 100000) {
+        std::cerr << "usage: meshlet_cull_check [random views]      at most 100000" << '\n';
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<View> views = CreateViews(randomViewCount);
+    uint32_t failures = 0;
+
+    std::vector<Mesh> meshes {};
+    meshes.push_back(CreateSphere());
+    meshes.push_back(CreateTorus());
+
+    for (Mesh& mesh : meshes) {
+        mesh.Meshlets = Meshlet::Build(mesh.Positions.data(), sizeof(glm::vec3), static_cast<uint32_t>(mesh.Positions.size()), mesh.Indices.data(),
+                                       static_cast<uint32_t>(mesh.Indices.size()));
+
+        std::cout << mesh.Name << ": " << mesh.Indices.size() / 3 << " triangles in " << mesh.Meshlets.size() << " meshlets, " << randomViewCount
+                  << " random views" << '\n';
+
+        CheckBounds(mesh, failures);
+
+        for (const View& view : views) {
+            const size_t drawnCount = CheckView(mesh, view, false, failures);
+            const size_t coneDrawnCount = CheckView(mesh, view, true, failures);
+
+            if (view.Name.compare(0, 6, "random") != 0) {
+                std::cout << "  " << view.Name << ": " << drawnCount << " in the frustum, " << coneDrawnCount << " after cone culling" << '\n';
+            }
+        }
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << '\n';
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "all checks passed" << '\n';
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+#include "../src/engine/obj_loader.hpp"
+
+// libs
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tinyobj/tiny_obj_loader.h>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Parses the same OBJ files with ObjLoader and with tinyobj, the loader the model path used before it, checks both
+// read the same number of positions, normals, texture coordinates and triangle corners and prints MB/s for each.
+// Both parse from memory, the file is read once up front so disk speed does not count.
+//
+// usage: obj_benchmark [obj file...]      default: the vases and the monkey under assets/models
+
+using namespace Engine;
+
+constexpr int REPEATS = 10;
+
+struct Counts {
+    size_t PositionCount { 0 };
+    size_t NormalCount { 0 };
+    size_t TexCoordCount { 0 };
+    size_t CornerCount { 0 };
+
+    bool operator==(const Counts& other) const {
+        return PositionCount == other.PositionCount && NormalCount == other.NormalCount && TexCoordCount == other.TexCoordCount
+            && CornerCount == other.CornerCount;
+    }
+};
+
+static std::ostream& operator<<(std::ostream& stream, const Counts& counts) {
+    return stream << counts.PositionCount << " positions, " << counts.NormalCount << " normals, " << counts.TexCoordCount << " uvs, "
+                  << counts.CornerCount << " corners";
+}
+
+static Counts ParseWithObjLoader(const std::string& text) {
+    ObjLoader::Mesh mesh {};
+    ObjLoader::Parse(text.data(), text.size(), mesh);
+
+    return { mesh.Positions.size() / 3, mesh.Normals.size() / 3, mesh.TexCoords.size() / 2, mesh.Corners.size() };
+}
+
+static Counts ParseWithTinyobj(const std::string& text) {
+    tinyobj::attrib_t attrib {};
+    std::vector<tinyobj::shape_t> shapes {};
+    std::vector<tinyobj::material_t> materials {};
+    std::string warn {};
+    std::string err {};
+
+    std::istringstream stream { text };
+
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &stream)) {
+        throw std::runtime_error(warn + err);
+    }
+
+    Counts counts { attrib.vertices.size() / 3, attrib.normals.size() / 3, attrib.texcoords.size() / 2, 0 };
+
+    for (const auto& shape : shapes) {
+        counts.CornerCount += shape.mesh.indices.size();
+    }
+
+    return counts;
+}
+
+template<typename Function>
+static double MeasureMegabytesPerSecond(size_t bytes, Function&& function) {
+    double best = 0.0;
+
+    for (int repeat = 0; repeat < REPEATS; repeat++) {
+        const auto startTime = std::chrono::high_resolution_clock::now();
+        function();
+        const double seconds = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        best = std::max(best, bytes / (1024.0 * 1024.0) / seconds);
+    }
+
+    return best;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> filepaths(argv + 1, argv + argc);
+
+    if (filepaths.empty()) {
+        filepaths = { "assets/models/smooth_vase.obj", "assets/models/flat_vase.obj", "assets/models/monkey.obj" };
+    }
+
+    bool isMatching = true;
+
+    try {
+        for (const auto& filepath : filepaths) {
+            std::ifstream file { filepath, std::ios::binary };
+
+            if (!file.is_open()) {
+                std::cerr << "usage: obj_benchmark [obj file...]      failed to open " << filepath << '\n';
+                return EXIT_FAILURE;
+            }
+
+            const std::string text { std::istreambuf_iterator<char> { file }, std::istreambuf_iterator<char> {} };
+
+            Counts objLoaderCounts {};
+            Counts tinyobjCounts {};
+
+            const double tinyobjRate = MeasureMegabytesPerSecond(text.size(), [&]() { tinyobjCounts = ParseWithTinyobj(text); });
+            const double objLoaderRate = MeasureMegabytesPerSecond(text.size(), [&]() { objLoaderCounts = ParseWithObjLoader(text); });
+
+            std::cout << filepath << ": " << text.size() / 1024 << " KB, " << objLoaderCounts << ", best of " << REPEATS << '\n';
+            std::cout << "  tinyobj:   " << tinyobjRate << " MB/s" << '\n';
+            std::cout << "  ObjLoader: " << objLoaderRate << " MB/s (" << objLoaderRate / tinyobjRate << "x)" << '\n';
+
+            if (!(objLoaderCounts == tinyobjCounts)) {
+                std::cerr << "  counts differ, tinyobj read " << tinyobjCounts << '\n';
+                isMatching = false;
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return isMatching ? EXIT_SUCCESS : EXIT_FAILURE;
+}
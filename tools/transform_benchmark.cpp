@@ -0,0 +1,150 @@
+#include "../src/engine/components.hpp"
+#include "../src/engine/transform_batch.hpp"
+
+// libs
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Checks every TransformBatch path this cpu has against TransformComponent::GetMat4Slow, then measures
+// objects per second against calling GetMat4 and GetNormalMatrix one object at a time.
+//
+// usage: transform_benchmark [object count]      default: 100000
+
+using namespace Engine;
+
+constexpr int REPEATS = 20;
+
+struct Transforms {
+    std::vector<glm::vec3> Positions;
+    std::vector<glm::vec3> Rotations;
+    std::vector<glm::vec3> Scales;
+};
+
+static Transforms CreateTransforms(uint32_t count) {
+    std::mt19937 random { 1234 };
+    std::uniform_real_distribution<float> position { -100.0f, 100.0f };
+    std::uniform_real_distribution<float> rotation { -4.0f * glm::pi<float>(), 4.0f * glm::pi<float>() };
+    std::uniform_real_distribution<float> scale { 0.1f, 10.0f };
+
+    Transforms transforms {};
+
+    for (uint32_t i = 0; i < count; i++) {
+        transforms.Positions.push_back({ position(random), position(random), position(random) });
+        transforms.Rotations.push_back({ rotation(random), rotation(random), rotation(random) });
+        transforms.Scales.push_back({ scale(random), scale(random), scale(random) });
+    }
+
+    return transforms;
+}
+
+// Largest error relative to the size of the value, so the error in a translation of 100 counts as much as one in a rotation.
+static float GetRelativeError(const float* values, const float* expected, uint32_t count) {
+    float error = 0.0f;
+
+    for (uint32_t i = 0; i < count; i++) {
+        error = std::max(error, std::abs(values[i] - expected[i]) / std::max(1.0f, std::abs(expected[i])));
+    }
+
+    return error;
+}
+
+template<typename Function>
+static double MeasureObjectsPerSecond(uint32_t count, Function&& function) {
+    double best = 0.0;
+
+    for (int repeat = 0; repeat < REPEATS; repeat++) {
+        const auto startTime = std::chrono::high_resolution_clock::now();
+        function();
+        const double seconds = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        best = std::max(best, count / seconds);
+    }
+
+    return best;
+}
+
+int main(int argc, char** argv) {
+    const uint32_t count = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 100000;
+
+    if (count == 0) {
+        std::cerr << "usage: transform_benchmark [object count]" << '\n';
+        return EXIT_FAILURE;
+    }
+
+    const Transforms transforms = CreateTransforms(count);
+
+    std::vector<glm::mat4> expectedModelMatrices(count);
+    std::vector<glm::mat3> expectedNormalMatrices(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+        TransformComponent transform { transforms.Positions[i], transforms.Scales[i], transforms.Rotations[i] };
+
+        expectedModelMatrices[i] = transform.GetMat4Slow();
+        expectedNormalMatrices[i] = glm::inverseTranspose(glm::mat3 { expectedModelMatrices[i] });
+    }
+
+    std::vector<glm::mat4> modelMatrices(count);
+    std::vector<glm::mat3> normalMatrices(count);
+
+    const double baseline = MeasureObjectsPerSecond(count, [&]() {
+        for (uint32_t i = 0; i < count; i++) {
+            TransformComponent transform { transforms.Positions[i], transforms.Scales[i], transforms.Rotations[i] };
+
+            modelMatrices[i] = transform.GetMat4();
+            normalMatrices[i] = transform.GetNormalMatrix();
+        }
+    });
+
+    std::cout << count << " objects, best of " << REPEATS << '\n';
+    std::cout << "  GetMat4 + GetNormalMatrix: " << baseline / 1e6 << " M objects/s" << '\n';
+
+    bool accurate = true;
+
+    for (auto instructionSet : { TransformBatch::InstructionSet::Scalar, TransformBatch::InstructionSet::Sse, TransformBatch::InstructionSet::Avx2 }) {
+        if (instructionSet > TransformBatch::GetSupportedInstructionSet()) {
+            std::cout << "  " << TransformBatch::GetName(instructionSet) << ": not supported by this cpu" << '\n';
+            continue;
+        }
+
+        TransformBatch::SetInstructionSet(instructionSet);
+
+        auto compute = [&]() {
+            TransformBatch::Compute(transforms.Positions.data(), transforms.Rotations.data(), transforms.Scales.data(), nullptr, count,
+                                    modelMatrices.data(), normalMatrices.data());
+        };
+
+        compute();
+
+        float modelError = 0.0f;
+        float normalError = 0.0f;
+
+        for (uint32_t i = 0; i < count; i++) {
+            modelError = std::max(modelError, GetRelativeError(&modelMatrices[i][0][0], &expectedModelMatrices[i][0][0], 16));
+            normalError = std::max(normalError, GetRelativeError(&normalMatrices[i][0][0], &expectedNormalMatrices[i][0][0], 9));
+        }
+
+        // glm::rotate goes through a different order of operations, float rounding alone gets close to 1e-5 for large scales.
+        accurate &= modelError < 1e-4f && normalError < 1e-4f;
+
+        const double objectsPerSecond = MeasureObjectsPerSecond(count, compute);
+
+        std::cout << "  " << TransformBatch::GetName(instructionSet) << ": " << objectsPerSecond / 1e6 << " M objects/s (" << objectsPerSecond / baseline
+                  << "x), max error " << modelError << " model, " << normalError << " normal" << '\n';
+    }
+
+    if (!accurate) {
+        std::cerr << "Batch matrices differ from TransformComponent::GetMat4Slow" << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
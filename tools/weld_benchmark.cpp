@@ -0,0 +1,132 @@
+#include "../src/engine/model.hpp"
+#include "../src/engine/utils.hpp"
+#include "../src/engine/vertex_welder.hpp"
+
+// libs
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// Welds the same corner stream with VertexWelder and with the std::unordered_map weld the OBJ path used before it,
+// checks both give the same vertices and indices, then measures corners per second for each.
+//
+// The stream is a grid of quads as an OBJ exporter writes it, two triangles per quad, so every vertex is repeated by
+// up to 6 corners. Every 8th column is a UV seam, its vertices are there twice with different UVs.
+//
+// usage: weld_benchmark [grid size]      default: 1000 (1000 x 1000 quads, 6 million corners)
+
+using namespace Engine;
+
+constexpr int REPEATS = 5;
+constexpr uint32_t SEAM_INTERVAL = 8;
+
+struct VertexHash {
+    size_t operator()(const Model::Vertex& vertex) const {
+        size_t seed = 0;
+        hashCombine(seed, vertex.Position, vertex.Color, vertex.UV);
+
+        return seed;
+    }
+};
+
+// The weld Model::Data::LoadModel did before VertexWelder, as it was.
+static void WeldWithMap(const std::vector<Model::Vertex>& corners, Model::Data& data) {
+    std::unordered_map<Model::Vertex, uint32_t, VertexHash> uniqueVertices {};
+
+    data.Vertices.clear();
+    data.Indices.clear();
+
+    for (const auto& vertex : corners) {
+        if (uniqueVertices.count(vertex) == 0) {
+            uniqueVertices[vertex] = static_cast<uint32_t>(data.Vertices.size());
+            data.Vertices.push_back(vertex);
+        }
+
+        data.Indices.push_back(uniqueVertices[vertex]);
+    }
+}
+
+static Model::Vertex CreateVertex(uint32_t x, uint32_t z, uint32_t gridSize, bool isSeamSide) {
+    const float u = static_cast<float>(x) / gridSize;
+    const float v = static_cast<float>(z) / gridSize;
+
+    Model::Vertex vertex {};
+    vertex.Position = { u * 2.0f - 1.0f, 0.1f * (u - v) * (u + v), v * 2.0f - 1.0f };
+    vertex.Color = { u, v, 1.0f - u };
+    vertex.Normal = glm::normalize(glm::vec3 { -0.2f * u, 1.0f, 0.2f * v });
+    vertex.UV = { isSeamSide ? u + 1.0f : u, v };
+
+    return vertex;
+}
+
+static std::vector<Model::Vertex> CreateCorners(uint32_t gridSize) {
+    std::vector<Model::Vertex> corners {};
+    corners.reserve(static_cast<size_t>(gridSize) * gridSize * 6);
+
+    for (uint32_t z = 0; z < gridSize; z++) {
+        for (uint32_t x = 0; x < gridSize; x++) {
+            // The quad right of a seam column takes the other copy of the seam's vertices.
+            const bool isSeamSide = x % SEAM_INTERVAL == 0 && x > 0;
+
+            const Model::Vertex corner00 = CreateVertex(x, z, gridSize, isSeamSide);
+            const Model::Vertex corner10 = CreateVertex(x + 1, z, gridSize, false);
+            const Model::Vertex corner01 = CreateVertex(x, z + 1, gridSize, isSeamSide);
+            const Model::Vertex corner11 = CreateVertex(x + 1, z + 1, gridSize, false);
+
+            corners.insert(corners.end(), { corner00, corner01, corner10, corner10, corner01, corner11 });
+        }
+    }
+
+    return corners;
+}
+
+template<typename Function>
+static double MeasureCornersPerSecond(size_t count, Function&& function) {
+    double best = 0.0;
+
+    for (int repeat = 0; repeat < REPEATS; repeat++) {
+        const auto startTime = std::chrono::high_resolution_clock::now();
+        function();
+        const double seconds = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        best = std::max(best, count / seconds);
+    }
+
+    return best;
+}
+
+int main(int argc, char** argv) {
+    const uint32_t gridSize = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1000;
+
+    if (gridSize == 0 || gridSize > 10000) {
+        std::cerr << "usage: weld_benchmark [grid size]      at most 10000" << '\n';
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<Model::Vertex> corners = CreateCorners(gridSize);
+
+    Model::Data mapData {};
+    Model::Data welderData {};
+    VertexWelder::Stats stats {};
+
+    const double mapRate = MeasureCornersPerSecond(corners.size(), [&]() { WeldWithMap(corners, mapData); });
+    const double welderRate = MeasureCornersPerSecond(corners.size(), [&]() { stats = VertexWelder::Weld(corners, welderData); });
+
+    std::cout << corners.size() << " corners, " << mapData.Vertices.size() << " vertices, best of " << REPEATS << '\n';
+    std::cout << "  unordered_map: " << mapRate / 1e6 << " M corners/s" << '\n';
+    std::cout << "  VertexWelder:  " << welderRate / 1e6 << " M corners/s (" << welderRate / mapRate << "x, " << stats.ThreadCount << " threads)" << '\n';
+
+    if (welderData.Vertices != mapData.Vertices || welderData.Indices != mapData.Indices) {
+        std::cerr << "VertexWelder output differs from the unordered_map weld" << '\n';
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}